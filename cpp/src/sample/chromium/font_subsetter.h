@@ -46,6 +46,28 @@ class SfntlyWrapper {
                         const unsigned int* glyph_ids,
                         size_t glyph_count,
                         unsigned char** output_buffer);
+
+  // Font subsetting API writing into caller-provided memory
+  //
+  // As above, but once the exact size of the subset font is known |allocate|
+  // is called with it and |context|, and the font is serialized straight into
+  // the buffer it returns, e.g. shared memory or a pooled buffer. Nothing is
+  // allocated or copied in between.
+  //
+  // |allocate|       Returns a buffer of at least |size| bytes, or NULL to
+  //                  abandon the subset, in which case a negative value is
+  //                  returned.  Called at most once.  Whenever it was called
+  //                  the buffer belongs to the caller, even if a negative
+  //                  value is returned because serializing into it failed;
+  //                  0 is only returned before |allocate| is called.
+  // |context|        Passed to |allocate| as is.
+  static int SubsetFont(const char* font_name,
+                        const unsigned char* original_font,
+                        size_t font_size,
+                        const unsigned int* glyph_ids,
+                        size_t glyph_count,
+                        unsigned char* (*allocate)(size_t size, void* context),
+                        void* context);
 };
 
 #endif  // SFNTLY_CPP_SRC_TEST_FONT_SUBSETTER_H_
@@ -16,6 +16,7 @@
 
 #include "subsetter_impl.h"
 
+#include <limits.h>
 #include <string.h>
 
 #include <algorithm>
@@ -34,8 +35,6 @@
 #include "sfntly/table/core/name_table.h"
 #include "sfntly/tag.h"
 #include "sfntly/data/memory_byte_array.h"
-#include "sfntly/port/memory_input_stream.h"
-#include "sfntly/port/memory_output_stream.h"
 
 #if defined U_USING_ICU_NAMESPACE
   U_NAMESPACE_USE
@@ -484,6 +483,13 @@ SubsetIndexSubTable(IndexSubTable::Builder* builder,
   return NULL;
 }
 
+// Allocator for SubsetFont() that returns a new[] array through |context|.
+unsigned char* AllocateArray(size_t size, void* context) {
+  unsigned char** output_buffer = static_cast<unsigned char**>(context);
+  *output_buffer = new unsigned char[size];
+  return *output_buffer;
+}
+
 }
 
 namespace sfntly {
@@ -608,17 +614,26 @@ SubsetterImpl::SubsetterImpl() {
 SubsetterImpl::~SubsetterImpl() {
 }
 
+#if !defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+void SubsetterImpl::SetFontCache(FontCache* font_cache) {
+  if (factory_ == NULL) {
+    factory_.Attach(FontFactory::GetInstance());
+  }
+  factory_->SetFontCache(font_cache);
+}
+#endif
+
 bool SubsetterImpl::LoadFont(const char* font_name,
                              const unsigned char* original_font,
                              size_t font_size) {
-  MemoryInputStream mis;
-  mis.Attach(original_font, font_size);
   if (factory_ == NULL) {
     factory_.Attach(FontFactory::GetInstance());
   }
 
+  // The tables are slices of |original_font|, which the caller keeps alive for
+  // the lifetime of this subsetter.
   FontArray font_array;
-  factory_->LoadFonts(&mis, &font_array);
+  factory_->LoadFonts(original_font, font_size, &font_array);
   font_ = FindFont(font_name, font_array);
   if (font_ == NULL) {
     return false;
@@ -630,6 +645,14 @@ bool SubsetterImpl::LoadFont(const char* font_name,
 int SubsetterImpl::SubsetFont(const unsigned int* glyph_ids,
                               size_t glyph_count,
                               unsigned char** output_buffer) {
+  return SubsetFont(glyph_ids, glyph_count, AllocateArray, output_buffer);
+}
+
+int SubsetterImpl::SubsetFont(const unsigned int* glyph_ids,
+                              size_t glyph_count,
+                              unsigned char* (*allocate)(size_t size,
+                                                         void* context),
+                              void* context) {
   if (factory_ == NULL || font_ == NULL) {
     return -1;
   }
@@ -656,15 +679,22 @@ int SubsetterImpl::SubsetFont(const unsigned int* glyph_ids,
     return 0;
   }
 
-  MemoryOutputStream output_stream;
-  factory_->SerializeFont(new_font, &output_stream);
-  int length = static_cast<int>(output_stream.Size());
-  if (length > 0) {
-    *output_buffer = new unsigned char[length];
-    memcpy(*output_buffer, output_stream.Get(), length);
+  // Serialize straight into the caller's buffer, sized exactly up front.
+  size_t length = factory_->SerializedFontSize(new_font);
+  if (length == 0 || length > INT_MAX) {
+    return 0;
   }
-
-  return length;
+  unsigned char* output = allocate(length, context);
+  if (output == NULL) {
+    return -1;
+  }
+  // The buffer is the caller's now, so a failure must not look like no glyph
+  // found.
+  size_t written = factory_->SerializeFontTo(new_font, output, length);
+  if (written == 0) {
+    return -1;
+  }
+  return static_cast<int>(written);
 }
 
 // Long comments regarding TTF tables and PDF (from stuartg)
@@ -54,12 +54,26 @@ class SubsetterImpl {
   SubsetterImpl();
   ~SubsetterImpl();
 
+  // Load the font to subset. |original_font| is not copied and must outlive
+  // this object.
   bool LoadFont(const char* font_name,
                 const unsigned char* original_font,
                 size_t font_size);
+#if !defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+  // Look up and keep the fonts loaded in |font_cache|, which may be shared
+  // by many subsetters, so the same font is only parsed once. Must be called
+  // before LoadFont().
+  void SetFontCache(FontCache* font_cache);
+#endif
   int SubsetFont(const unsigned int* glyph_ids,
                  size_t glyph_count,
                  unsigned char** output_buffer);
+  // Subset as above, but serialize the subset font straight into a buffer
+  // obtained from |allocate| once its exact size is known.
+  int SubsetFont(const unsigned int* glyph_ids,
+                 size_t glyph_count,
+                 unsigned char* (*allocate)(size_t size, void* context),
+                 void* context);
 
  private:
   CALLER_ATTACH Font* Subset(const IntegerSet& glyph_ids,
@@ -56,6 +56,13 @@ int32_t ByteArray::Get(int32_t index,
 }
 
 void ByteArray::Put(int32_t index, byte_t b) {
+  if (read_only_) {
+#if defined (SFNTLY_NO_EXCEPTION)
+    return;
+#else
+    throw IOException("Attempt to write to read-only data");
+#endif
+  }
   if (index < 0 || index >= Size()) {
 #if defined (SFNTLY_NO_EXCEPTION)
     return;
@@ -78,6 +85,13 @@ int32_t ByteArray::Put(int32_t index,
                        int32_t offset,
                        int32_t length) {
   assert(b);
+  if (read_only_) {
+#if defined (SFNTLY_NO_EXCEPTION)
+    return 0;
+#else
+    throw IOException("Attempt to write to read-only data");
+#endif
+  }
   if (index < 0 || index >= Size()) {
 #if defined (SFNTLY_NO_EXCEPTION)
     return 0;
@@ -107,6 +121,20 @@ int32_t ByteArray::CopyTo(int32_t dst_offset, ByteArray* array,
     return -1;
   }
 
+  // With contiguous storage on this side the destination can take the bytes
+  // straight from it, without bouncing them through a buffer.
+  byte_t* src = (array != this) ? Begin() : NULL;
+  if (src) {
+    if (src_offset < 0 || src_offset >= filled_length_ || length <= 0) {
+      return 0;
+    }
+    int32_t actual_length =
+        std::min<int32_t>(length, filled_length_ - src_offset);
+    // Like the loop below, count the bytes read rather than those written.
+    array->Put(dst_offset, src, src_offset, actual_length);
+    return actual_length;
+  }
+
   ByteVector b(COPY_BUFFER_SIZE);
   int32_t bytes_read = 0;
   int32_t index = 0;
@@ -128,6 +156,16 @@ int32_t ByteArray::CopyTo(OutputStream* os) {
 }
 
 int32_t ByteArray::CopyTo(OutputStream* os, int32_t offset, int32_t length) {
+  byte_t* src = Begin();
+  if (src) {
+    if (offset < 0 || offset >= filled_length_ || length <= 0) {
+      return 0;
+    }
+    int32_t actual_length = std::min<int32_t>(length, filled_length_ - offset);
+    os->Write(src, offset, actual_length);
+    return actual_length;
+  }
+
   ByteVector b(COPY_BUFFER_SIZE);
   int32_t bytes_read = 0;
   int32_t index = 0;
@@ -180,11 +218,13 @@ bool ByteArray::CopyFrom(InputStream* is) {
 
 ByteArray::ByteArray(int32_t filled_length,
                      int32_t storage_length,
-                     bool growable) {
+                     bool growable)
+    : read_only_(false) {
   Init(filled_length, storage_length, growable);
 }
 
-ByteArray::ByteArray(int32_t filled_length, int32_t storage_length) {
+ByteArray::ByteArray(int32_t filled_length, int32_t storage_length)
+    : read_only_(false) {
   Init(filled_length, storage_length, false);
 }
 
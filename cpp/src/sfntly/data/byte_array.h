@@ -17,6 +17,7 @@
 #ifndef SFNTLY_CPP_SRC_SFNTLY_DATA_BYTE_ARRAY_H_
 #define SFNTLY_CPP_SRC_SFNTLY_DATA_BYTE_ARRAY_H_
 
+#include "sfntly/port/arena.h"
 #include "sfntly/port/refcount.h"
 #include "sfntly/port/type.h"
 #include "sfntly/port/input_stream.h"
@@ -27,7 +28,7 @@ namespace sfntly {
 // An abstraction to a contiguous array of bytes.
 // C++ port of this class assumes that the data are stored in a linear region
 // like std::vector.
-class ByteArray : virtual public RefCount {
+class ByteArray : virtual public RefCount, public ArenaObject {
  public:
   virtual ~ByteArray();
 
@@ -42,6 +43,10 @@ class ByteArray : virtual public RefCount {
   // Determines whether or not this array is growable or of fixed size.
   bool growable() { return growable_; }
 
+  // Determines whether or not this array rejects writes. Read-only arrays wrap
+  // storage that sfntly does not own or must not modify, e.g. a mapped file.
+  bool read_only() { return read_only_; }
+
   int32_t SetFilledLength(int32_t filled_length);
 
   // Gets the byte from the given index.
@@ -136,6 +141,11 @@ class ByteArray : virtual public RefCount {
   // @param is the source
   virtual bool CopyFrom(InputStream* is);
 
+  // C++ port only, raw pointer to the first element of storage; NULL if the
+  // array has no contiguous storage (or none yet).  The pointer is only valid
+  // until the next write since growable arrays may reallocate.
+  virtual byte_t* Begin() = 0;
+
  protected:
   // filledLength the length that is "filled" and readable counting from offset.
   // storageLength the maximum storage size of the underlying data.
@@ -143,6 +153,7 @@ class ByteArray : virtual public RefCount {
   ByteArray(int32_t filled_length, int32_t storage_length, bool growable);
   ByteArray(int32_t filled_length, int32_t storage_length);
   void Init(int32_t filled_length, int32_t storage_length, bool growable);
+  void set_read_only(bool read_only) { read_only_ = read_only; }
 
   // Internal subclass API
 
@@ -181,9 +192,6 @@ class ByteArray : virtual public RefCount {
   // Close this instance of the ByteArray.
   virtual void Close() = 0;
 
-  // C++ port only, raw pointer to the first element of storage.
-  virtual byte_t* Begin() = 0;
-
   // Java toString() not ported.
 
   static const int32_t COPY_BUFFER_SIZE;
@@ -193,6 +201,7 @@ class ByteArray : virtual public RefCount {
   int32_t filled_length_;
   int32_t storage_length_;
   bool growable_;
+  bool read_only_;
 };
 typedef Ptr<ByteArray> ByteArrayPtr;
 
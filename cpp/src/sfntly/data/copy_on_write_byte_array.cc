@@ -0,0 +1,88 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/data/copy_on_write_byte_array.h"
+
+#include <string.h>
+
+namespace sfntly {
+
+CopyOnWriteByteArray::CopyOnWriteByteArray(ReadableFontData* source)
+    : ByteArray(source->Length(), source->Length()), source_(source) {
+}
+
+CopyOnWriteByteArray::~CopyOnWriteByteArray() {
+  Close();
+}
+
+byte_t* CopyOnWriteByteArray::Begin() {
+  if (source_ != NULL) {
+    return source_->BoundPointer(0, Size());
+  }
+  return b_.empty() ? NULL : &(b_[0]);
+}
+
+void CopyOnWriteByteArray::Detach() {
+  if (source_ == NULL) {
+    return;
+  }
+  b_.resize(Size());
+  if (!b_.empty()) {
+    source_->ReadBytes(0, &(b_[0]), 0, Size());
+  }
+  source_ = NULL;
+}
+
+void CopyOnWriteByteArray::InternalPut(int32_t index, byte_t b) {
+  Detach();
+  b_[index] = b;
+}
+
+int32_t CopyOnWriteByteArray::InternalPut(int32_t index,
+                                          byte_t* b,
+                                          int32_t offset,
+                                          int32_t length) {
+  assert(b);
+  Detach();
+  memcpy(&(b_[index]), b + offset, length);
+  return length;
+}
+
+byte_t CopyOnWriteByteArray::InternalGet(int32_t index) {
+  if (source_ != NULL) {
+    return (byte_t)source_->ReadUByte(index);
+  }
+  return b_[index];
+}
+
+int32_t CopyOnWriteByteArray::InternalGet(int32_t index,
+                                          byte_t* b,
+                                          int32_t offset,
+                                          int32_t length) {
+  assert(b);
+  if (source_ != NULL) {
+    return source_->ReadBytes(index, b, offset, length);
+  }
+  memcpy(b + offset, &(b_[index]), length);
+  return length;
+}
+
+void CopyOnWriteByteArray::Close() {
+  source_ = NULL;
+  b_.clear();
+}
+
+}  // namespace sfntly
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_DATA_COPY_ON_WRITE_BYTE_ARRAY_H_
+#define SFNTLY_CPP_SRC_SFNTLY_DATA_COPY_ON_WRITE_BYTE_ARRAY_H_
+
+#include "sfntly/data/byte_array.h"
+#include "sfntly/data/readable_font_data.h"
+
+namespace sfntly {
+
+// A fixed size ByteArray that reads through to existing font data until the
+// first write, at which point it takes a private copy of the bytes. Lets a
+// table be handed to a builder without copying it when it is never modified.
+// The source data must not be modified while it is shared.
+// Note: C++ port only, there is no Java equivalent.
+class CopyOnWriteByteArray : public ByteArray,
+                             public RefCounted<CopyOnWriteByteArray> {
+ public:
+  // Construct a new CopyOnWriteByteArray sharing the bytes of the given data.
+  // @param source the data to share; all of its bytes are readable
+  explicit CopyOnWriteByteArray(ReadableFontData* source);
+  virtual ~CopyOnWriteByteArray();
+
+  // Determines whether or not this array has taken its own copy of the data.
+  bool copied() { return source_ == NULL; }
+
+  virtual int32_t CopyTo(OutputStream* os, int32_t offset, int32_t length) {
+    return ByteArray::CopyTo(os, offset, length);
+  }
+
+  // Make gcc -Woverloaded-virtual happy.
+  virtual int32_t CopyTo(ByteArray* array) { return ByteArray::CopyTo(array); }
+  virtual int32_t CopyTo(ByteArray* array, int32_t offset, int32_t length) {
+    return ByteArray::CopyTo(array, offset, length);
+  }
+  virtual int32_t CopyTo(int32_t dst_offset,
+                         ByteArray* array,
+                         int32_t src_offset,
+                         int32_t length) {
+    return ByteArray::CopyTo(dst_offset, array, src_offset, length);
+  }
+  virtual int32_t CopyTo(OutputStream* os) { return ByteArray::CopyTo(os); }
+
+  virtual byte_t* Begin();
+
+ protected:
+  virtual void InternalPut(int32_t index, byte_t b);
+  virtual int32_t InternalPut(int32_t index,
+                              byte_t* b,
+                              int32_t offset,
+                              int32_t length);
+  virtual byte_t InternalGet(int32_t index);
+  virtual int32_t InternalGet(int32_t index,
+                              byte_t* b,
+                              int32_t offset,
+                              int32_t length);
+  virtual void Close();
+
+ private:
+  // Take a private copy of the shared bytes, if not done already.
+  void Detach();
+
+  ReadableFontDataPtr source_;
+  ByteVector b_;
+};
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_DATA_COPY_ON_WRITE_BYTE_ARRAY_H_
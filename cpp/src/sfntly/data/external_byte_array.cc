@@ -0,0 +1,83 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/data/external_byte_array.h"
+
+#include <string.h>
+
+namespace sfntly {
+
+ExternalByteArray::ExternalByteArray(const byte_t* b, int32_t length)
+    : ByteArray(length, length), b_(b) {
+  assert(b);
+  set_read_only(true);
+}
+
+ExternalByteArray::~ExternalByteArray() {
+  Close();
+}
+
+int32_t ExternalByteArray::CopyTo(OutputStream* os,
+                                  int32_t offset,
+                                  int32_t length) {
+  assert(os);
+  os->Write(Begin(), offset, length);
+  return length;
+}
+
+void ExternalByteArray::InternalPut(int32_t index, byte_t b) {
+  UNREFERENCED_PARAMETER(index);
+  UNREFERENCED_PARAMETER(b);
+  assert(false);
+}
+
+int32_t ExternalByteArray::InternalPut(int32_t index,
+                                       byte_t* b,
+                                       int32_t offset,
+                                       int32_t length) {
+  UNREFERENCED_PARAMETER(index);
+  UNREFERENCED_PARAMETER(b);
+  UNREFERENCED_PARAMETER(offset);
+  UNREFERENCED_PARAMETER(length);
+  assert(false);
+  return 0;
+}
+
+byte_t ExternalByteArray::InternalGet(int32_t index) {
+  return b_[index];
+}
+
+int32_t ExternalByteArray::InternalGet(int32_t index,
+                                       byte_t* b,
+                                       int32_t offset,
+                                       int32_t length) {
+  assert(b);
+  memcpy(b + offset, b_ + index, length);
+  return length;
+}
+
+void ExternalByteArray::Close() {
+  // The buffer belongs to the caller.
+  b_ = NULL;
+}
+
+byte_t* ExternalByteArray::Begin() {
+  // Writes are rejected by ByteArray::Put(), so handing out a non-const
+  // pointer never modifies the caller's buffer.
+  return const_cast<byte_t*>(b_);
+}
+
+}  // namespace sfntly
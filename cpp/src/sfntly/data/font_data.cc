@@ -47,6 +47,10 @@ int32_t FontData::Length() const {
   return std::min<int32_t>(array_->Length() - bound_offset_, bound_length_);
 }
 
+bool FontData::ReadOnly() const {
+  return array_->read_only();
+}
+
 FontData::FontData(ByteArray* ba) {
   Init(ba);
 }
@@ -23,6 +23,7 @@
 
 #include "sfntly/port/type.h"
 #include "sfntly/data/byte_array.h"
+#include "sfntly/port/arena.h"
 #include "sfntly/port/refcount.h"
 
 namespace sfntly {
@@ -48,7 +49,7 @@ struct DataSize {
   };
 };
 
-class FontData : virtual public RefCount {
+class FontData : virtual public RefCount, public ArenaObject {
  public:
   // Gets the maximum size of the FontData. This is the maximum number of bytes
   // that the font data can hold and all of it may not be filled with data or
@@ -87,6 +88,19 @@ class FontData : virtual public RefCount {
   // Gets the length of the data.
   virtual int32_t Length() const;
 
+  // Determines whether or not the underlying byte array rejects writes. Table
+  // builders backed by read-only data make a private copy before modifying it.
+  bool ReadOnly() const;
+
+  // Gets a pointer to the bytes of the data when they are all stored
+  // contiguously in memory. The pointer is only valid until the data is next
+  // written.
+  // Note: C++ port only, there is no Java equivalent.
+  // @return the pointer; NULL if the data is empty or not contiguous
+  const byte_t* ContiguousBytes() {
+    return Length() > 0 ? BoundPointer(0, Length()) : NULL;
+  }
+
  protected:
   // Constructor.
   // @param ba the byte array to use for the backing data
@@ -119,6 +133,22 @@ class FontData : virtual public RefCount {
   // @return the bound compensated length
   int32_t BoundLength(int32_t offset, int32_t length);
 
+  // Gets a pointer into the underlying storage for the bytes from offset to
+  // offset + length, taking into account any bounds on the data. Inlined since
+  // it guards the fast path of every primitive read.
+  // @param offset the offset of the first byte
+  // @param length the number of bytes that must be readable from the pointer
+  // @return the pointer; NULL if any of the bytes are outside of the readable
+  //         data or the underlying array has no contiguous storage
+  byte_t* BoundPointer(int32_t offset, int32_t length) {
+    if (offset < 0 || length > bound_length_ - offset ||
+        (int64_t)bound_offset_ + offset + length > array_->Length()) {
+      return NULL;
+    }
+    byte_t* begin = array_->Begin();
+    return begin ? begin + bound_offset_ + offset : NULL;
+  }
+
   static const int32_t GROWABLE_SIZE = INT_MAX;
 
   // TODO(arthurhsu): style guide violation: refactor this protected member
@@ -127,6 +157,9 @@ class FontData : virtual public RefCount {
  private:
   int32_t bound_offset_;
   int32_t bound_length_;
+
+  // Reads through to the storage of the data it shares.
+  friend class CopyOnWriteByteArray;
 };
 typedef Ptr<FontData> FontDataPtr;
 
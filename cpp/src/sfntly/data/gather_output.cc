@@ -0,0 +1,109 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/data/gather_output.h"
+
+#include <string.h>
+
+namespace sfntly {
+
+namespace {
+
+// Shared source of the zero bytes of padding segments.
+const byte_t kZeros[16] = { 0 };
+
+}  // namespace
+
+GatherOutput::GatherOutput() : size_(0) {
+}
+
+GatherOutput::~GatherOutput() {
+}
+
+void GatherOutput::Append(ReadableFontData* data) {
+  assert(data);
+  int32_t length = data->Length();
+  if (length <= 0) {
+    return;
+  }
+  const byte_t* b = data->ContiguousBytes();
+  if (b) {
+    referenced_data_.push_back(data);
+    AppendSegment(b, length);
+    return;
+  }
+  buffers_.push_back(ByteVector(length));
+  ByteVector& buffer = buffers_.back();
+  int32_t bytes_read = data->ReadBytes(0, &(buffer[0]), 0, length);
+  AppendSegment(&(buffer[0]), bytes_read > 0 ? bytes_read : 0);
+}
+
+void GatherOutput::AppendCopy(const byte_t* b, size_t length) {
+  if (length == 0) {
+    return;
+  }
+  assert(b);
+  buffers_.push_back(ByteVector(b, b + length));
+  AppendSegment(&(buffers_.back()[0]), length);
+}
+
+void GatherOutput::AppendPadding(size_t count) {
+  while (count > 0) {
+    size_t length = count < sizeof(kZeros) ? count : sizeof(kZeros);
+    AppendSegment(kZeros, length);
+    count -= length;
+  }
+}
+
+size_t GatherOutput::CopyTo(byte_t* dst, size_t capacity) const {
+  if (dst == NULL || capacity < size_) {
+    return 0;
+  }
+  byte_t* p = dst;
+  for (SegmentList::const_iterator s = segments_.begin(), e = segments_.end();
+       s != e; ++s) {
+    memcpy(p, s->data, s->length);
+    p += s->length;
+  }
+  return size_;
+}
+
+void GatherOutput::WriteTo(OutputStream* os) const {
+  assert(os);
+  for (SegmentList::const_iterator s = segments_.begin(), e = segments_.end();
+       s != e; ++s) {
+    // OutputStream takes non-const buffers but does not modify them.
+    os->Write(const_cast<byte_t*>(s->data), 0, (int32_t)s->length);
+  }
+}
+
+void GatherOutput::Clear() {
+  segments_.clear();
+  size_ = 0;
+  buffers_.clear();
+  referenced_data_.clear();
+}
+
+void GatherOutput::AppendSegment(const byte_t* b, size_t length) {
+  if (length == 0) {
+    return;
+  }
+  Segment segment = { b, length };
+  segments_.push_back(segment);
+  size_ += length;
+}
+
+}  // namespace sfntly
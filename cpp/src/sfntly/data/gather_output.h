@@ -0,0 +1,95 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_DATA_GATHER_OUTPUT_H_
+#define SFNTLY_CPP_SRC_SFNTLY_DATA_GATHER_OUTPUT_H_
+
+#include <deque>
+#include <vector>
+
+#include "sfntly/data/readable_font_data.h"
+#include "sfntly/port/output_stream.h"
+#include "sfntly/port/type.h"
+
+namespace sfntly {
+
+// Scatter-gather output: an ordered list of (pointer, length) segments that
+// make up a serialized font. Segments reference the existing storage of font
+// data wherever it is contiguous in memory, so nothing is copied until the
+// caller hands the segments to writev() or makes one final copy. Small pieces
+// such as headers, and data without contiguous storage, are copied into
+// buffers owned by the GatherOutput.
+// The segments stay valid for the lifetime of the GatherOutput, which keeps
+// the referenced font data alive, as long as that data is not modified.
+// Note: C++ port only, there is no Java equivalent.
+class GatherOutput {
+ public:
+  struct Segment {
+    const byte_t* data;
+    size_t length;
+  };
+  typedef std::vector<Segment> SegmentList;
+
+  GatherOutput();
+  ~GatherOutput();
+
+  // Appends all of the bytes of the font data, by reference where possible.
+  // @param data the font data
+  void Append(ReadableFontData* data);
+
+  // Appends a copy of the bytes given.
+  // @param b the bytes to copy
+  // @param length the number of bytes
+  void AppendCopy(const byte_t* b, size_t length);
+
+  // Appends zero bytes.
+  // @param count the number of zero bytes
+  void AppendPadding(size_t count);
+
+  // Gets the segments in output order.
+  const SegmentList& segments() const { return segments_; }
+
+  // Gets the total number of bytes in all of the segments.
+  size_t Size() const { return size_; }
+
+  // Copies all of the segments into a buffer.
+  // @param dst the destination
+  // @param capacity the size of the destination in bytes
+  // @return the number of bytes copied; 0 if the buffer is too small
+  size_t CopyTo(byte_t* dst, size_t capacity) const;
+
+  // Writes all of the segments to the stream.
+  // @param os the destination
+  void WriteTo(OutputStream* os) const;
+
+  // Discards all of the segments.
+  void Clear();
+
+ private:
+  void AppendSegment(const byte_t* b, size_t length);
+
+  SegmentList segments_;
+  size_t size_;
+  // Owned copies; a deque never moves its elements when appended to.
+  std::deque<ByteVector> buffers_;
+  std::vector<ReadableFontDataPtr> referenced_data_;
+
+  NO_COPY_AND_ASSIGN(GatherOutput);
+};
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_DATA_GATHER_OUTPUT_H_
@@ -76,7 +76,7 @@ void GrowableMemoryByteArray::Close() {
 }
 
 byte_t* GrowableMemoryByteArray::Begin() {
-  return &(b_[0]);
+  return b_.empty() ? NULL : &(b_[0]);
 }
 
 }  // namespace sfntly
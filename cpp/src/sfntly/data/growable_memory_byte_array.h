@@ -43,6 +43,8 @@ class GrowableMemoryByteArray : public ByteArray,
   }
   virtual int32_t CopyTo(OutputStream* os) { return ByteArray::CopyTo(os); }
 
+  virtual byte_t* Begin();
+
  protected:
   virtual void InternalPut(int32_t index, byte_t b);
   virtual int32_t InternalPut(int32_t index,
@@ -55,7 +57,6 @@ class GrowableMemoryByteArray : public ByteArray,
                               int32_t offset,
                               int32_t length);
   virtual void Close();
-  virtual byte_t* Begin();
 
  private:
   ByteVector b_;
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/data/mapped_byte_array.h"
+
+#if !defined (WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <limits.h>
+#include <string.h>
+
+namespace sfntly {
+
+MappedByteArray::~MappedByteArray() {
+  Close();
+}
+
+// static
+CALLER_ATTACH
+MappedByteArray* MappedByteArray::CreateMappedByteArray(const char* file_path) {
+  assert(file_path);
+  MappedByteArrayPtr array = new MappedByteArray();
+  if (!array->Map(file_path)) {
+    return NULL;
+  }
+  return array.Detach();
+}
+
+int32_t MappedByteArray::CopyTo(OutputStream* os,
+                                int32_t offset,
+                                int32_t length) {
+  assert(os);
+  os->Write(b_, offset, length);
+  return length;
+}
+
+void MappedByteArray::InternalPut(int32_t index, byte_t b) {
+  UNREFERENCED_PARAMETER(index);
+  UNREFERENCED_PARAMETER(b);
+  assert(false);
+}
+
+int32_t MappedByteArray::InternalPut(int32_t index,
+                                     byte_t* b,
+                                     int32_t offset,
+                                     int32_t length) {
+  UNREFERENCED_PARAMETER(index);
+  UNREFERENCED_PARAMETER(b);
+  UNREFERENCED_PARAMETER(offset);
+  UNREFERENCED_PARAMETER(length);
+  assert(false);
+  return 0;
+}
+
+byte_t MappedByteArray::InternalGet(int32_t index) {
+  return b_[index];
+}
+
+int32_t MappedByteArray::InternalGet(int32_t index,
+                                     byte_t* b,
+                                     int32_t offset,
+                                     int32_t length) {
+  assert(b);
+  memcpy(b + offset, b_ + index, length);
+  return length;
+}
+
+byte_t* MappedByteArray::Begin() {
+  return b_;
+}
+
+MappedByteArray::MappedByteArray()
+    : ByteArray(0, 0),
+      b_(NULL),
+#if defined (WIN32)
+      file_(INVALID_HANDLE_VALUE),
+      mapping_(NULL) {
+#else
+      mapped_length_(0) {
+#endif
+  set_read_only(true);
+}
+
+#if defined (WIN32)
+
+bool MappedByteArray::Map(const char* file_path) {
+  file_ = ::CreateFileA(file_path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!::GetFileSizeEx(file_, &size) || size.QuadPart == 0 ||
+      size.QuadPart > INT_MAX) {
+    Close();
+    return false;
+  }
+  mapping_ = ::CreateFileMapping(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping_ == NULL) {
+    Close();
+    return false;
+  }
+  b_ = reinterpret_cast<byte_t*>(
+      ::MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (b_ == NULL) {
+    Close();
+    return false;
+  }
+  int32_t length = static_cast<int32_t>(size.QuadPart);
+  Init(length, length, false);
+  return true;
+}
+
+void MappedByteArray::Close() {
+  if (b_) {
+    ::UnmapViewOfFile(b_);
+    b_ = NULL;
+  }
+  if (mapping_) {
+    ::CloseHandle(mapping_);
+    mapping_ = NULL;
+  }
+  if (file_ != INVALID_HANDLE_VALUE) {
+    ::CloseHandle(file_);
+    file_ = INVALID_HANDLE_VALUE;
+  }
+}
+
+#else  // Assume POSIX mmap.
+
+bool MappedByteArray::Map(const char* file_path) {
+  int fd = open(file_path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0 ||
+      file_stat.st_size > INT_MAX) {
+    close(fd);
+    return false;
+  }
+  void* address = mmap(NULL, (size_t)file_stat.st_size, PROT_READ,
+                       MAP_PRIVATE, fd, 0);
+  // The mapping keeps its own reference to the file.
+  close(fd);
+  if (address == MAP_FAILED) {
+    return false;
+  }
+  b_ = reinterpret_cast<byte_t*>(address);
+  mapped_length_ = (size_t)file_stat.st_size;
+  int32_t length = static_cast<int32_t>(mapped_length_);
+  Init(length, length, false);
+  return true;
+}
+
+void MappedByteArray::Close() {
+  if (b_) {
+    munmap(b_, mapped_length_);
+    b_ = NULL;
+    mapped_length_ = 0;
+  }
+}
+
+#endif
+
+}  // namespace sfntly
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_DATA_MAPPED_BYTE_ARRAY_H_
+#define SFNTLY_CPP_SRC_SFNTLY_DATA_MAPPED_BYTE_ARRAY_H_
+
+#if defined (WIN32)
+#include <windows.h>
+#endif
+
+#include "sfntly/data/byte_array.h"
+
+namespace sfntly {
+
+// A read-only ByteArray backed by a memory mapped file. Pages are brought in
+// by the OS on first access, so reading a font this way costs memory only for
+// the parts of the file that are actually touched. The mapping is released
+// when the last reference to the array (including slices of FontData wrapping
+// it) goes away.
+// Note: C++ port only, there is no Java equivalent.
+class MappedByteArray : public ByteArray, public RefCounted<MappedByteArray> {
+ public:
+  virtual ~MappedByteArray();
+
+  // Map the file at the given path.
+  // @param file_path the path of the file to map
+  // @return a new read-only array covering the whole file; NULL if the file
+  //         cannot be opened, is empty, or cannot be mapped
+  static CALLER_ATTACH MappedByteArray* CreateMappedByteArray(
+      const char* file_path);
+
+  virtual int32_t CopyTo(OutputStream* os, int32_t offset, int32_t length);
+
+  // Make gcc -Woverloaded-virtual happy.
+  virtual int32_t CopyTo(ByteArray* array) { return ByteArray::CopyTo(array); }
+  virtual int32_t CopyTo(ByteArray* array, int32_t offset, int32_t length) {
+    return ByteArray::CopyTo(array, offset, length);
+  }
+  virtual int32_t CopyTo(int32_t dst_offset,
+                         ByteArray* array,
+                         int32_t src_offset,
+                         int32_t length) {
+    return ByteArray::CopyTo(dst_offset, array, src_offset, length);
+  }
+  virtual int32_t CopyTo(OutputStream* os) { return ByteArray::CopyTo(os); }
+
+  virtual byte_t* Begin();
+
+ protected:
+  // Writes are rejected by ByteArray::Put() before reaching these.
+  virtual void InternalPut(int32_t index, byte_t b);
+  virtual int32_t InternalPut(int32_t index,
+                              byte_t* b,
+                              int32_t offset,
+                              int32_t length);
+  virtual byte_t InternalGet(int32_t index);
+  virtual int32_t InternalGet(int32_t index,
+                              byte_t* b,
+                              int32_t offset,
+                              int32_t length);
+  virtual void Close();
+
+ private:
+  MappedByteArray();
+  bool Map(const char* file_path);
+
+  byte_t* b_;
+#if defined (WIN32)
+  HANDLE file_;
+  HANDLE mapping_;
+#else
+  size_t mapped_length_;
+#endif
+  NO_COPY_AND_ASSIGN(MappedByteArray);
+};
+typedef Ptr<MappedByteArray> MappedByteArrayPtr;
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_DATA_MAPPED_BYTE_ARRAY_H_
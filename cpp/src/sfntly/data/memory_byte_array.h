@@ -55,6 +55,8 @@ class MemoryByteArray : public ByteArray, public RefCounted<MemoryByteArray> {
   }
   virtual int32_t CopyTo(OutputStream* os) { return ByteArray::CopyTo(os); }
 
+  virtual byte_t* Begin();
+
  protected:
   virtual void InternalPut(int32_t index, byte_t b);
   virtual int32_t InternalPut(int32_t index,
@@ -67,7 +69,6 @@ class MemoryByteArray : public ByteArray, public RefCounted<MemoryByteArray> {
                               int32_t offset,
                               int32_t length);
   virtual void Close();
-  virtual byte_t* Begin();
 
  private:
   void Init();  // C++ port only, used to allocate memory outside constructor.
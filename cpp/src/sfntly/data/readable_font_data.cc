@@ -18,15 +18,20 @@
 
 #include <stdio.h>
 
+#include <algorithm>
+
 #include "sfntly/data/memory_byte_array.h"
 #include "sfntly/data/writable_font_data.h"
+#include "sfntly/port/atomic.h"
+#include "sfntly/port/checksum.h"
+#include "sfntly/port/endian.h"
 #include "sfntly/port/exception_type.h"
 
 namespace sfntly {
 
 ReadableFontData::ReadableFontData(ByteArray* array)
     : FontData(array),
-      checksum_set_(false),
+      checksum_set_(0),
       checksum_(0) {
 }
 
@@ -45,6 +50,11 @@ ReadableFontData* ReadableFontData::CreateReadableFontData(ByteVector* b) {
 }
 
 int64_t ReadableFontData::Checksum() {
+  // Once published the checksum never changes until the ranges do, so the
+  // common case does not need the lock.
+  if (AtomicLoadAcquire(&checksum_set_)) {
+    return checksum_;
+  }
   AutoLock lock(checksum_lock_);
   if (!checksum_set_) {
     ComputeChecksum();
@@ -53,11 +63,16 @@ int64_t ReadableFontData::Checksum() {
 }
 
 void ReadableFontData::SetCheckSumRanges(const IntegerList& ranges) {
+  AutoLock lock(checksum_lock_);
   checksum_range_ = ranges;
-  checksum_set_ = false;  // UNIMPLEMENTED: atomicity
+  AtomicStoreRelease(&checksum_set_, 0);
 }
 
 int32_t ReadableFontData::ReadUByte(int32_t index) {
+  const byte_t* p = BoundPointer(index, DataSize::kBYTE);
+  if (p) {
+    return *p;
+  }
   int32_t b = array_->Get(BoundOffset(index));
 #if !defined (SFNTLY_NO_EXCEPTION)
   if (b < 0) {
@@ -69,6 +84,10 @@ int32_t ReadableFontData::ReadUByte(int32_t index) {
 }
 
 int32_t ReadableFontData::ReadByte(int32_t index) {
+  const byte_t* p = BoundPointer(index, DataSize::kBYTE);
+  if (p) {
+    return static_cast<int8_t>(*p);
+  }
   int32_t b = array_->Get(BoundOffset(index));
 #if !defined (SFNTLY_NO_EXCEPTION)
   if (b < 0) {
@@ -91,20 +110,36 @@ int32_t ReadableFontData::ReadChar(int32_t index) {
 }
 
 int32_t ReadableFontData::ReadUShort(int32_t index) {
+  const byte_t* p = BoundPointer(index, DataSize::kUSHORT);
+  if (p) {
+    return LoadBE16(p);
+  }
   return 0xffff & (ReadUByte(index) << 8 | ReadUByte(index + 1));
 }
 
 int32_t ReadableFontData::ReadShort(int32_t index) {
+  const byte_t* p = BoundPointer(index, DataSize::kSHORT);
+  if (p) {
+    return static_cast<int16_t>(LoadBE16(p));
+  }
   return ((ReadByte(index) << 8 | ReadUByte(index + 1)) << 16) >> 16;
 }
 
 int32_t ReadableFontData::ReadUInt24(int32_t index) {
+  const byte_t* p = BoundPointer(index, DataSize::kUINT24);
+  if (p) {
+    return p[0] << 16 | p[1] << 8 | p[2];
+  }
   return 0xffffff & (ReadUByte(index) << 16 |
                      ReadUByte(index + 1) << 8 |
                      ReadUByte(index + 2));
 }
 
 int64_t ReadableFontData::ReadULong(int32_t index) {
+  const byte_t* p = BoundPointer(index, DataSize::kULONG);
+  if (p) {
+    return LoadBE32(p);
+  }
   return 0xffffffffL & (ReadUByte(index) << 24 |
                         ReadUByte(index + 1) << 16 |
                         ReadUByte(index + 2) << 8 |
@@ -122,6 +157,11 @@ int32_t ReadableFontData::ReadULongAsInt(int32_t index) {
 }
 
 int64_t ReadableFontData::ReadULongLE(int32_t index) {
+  const byte_t* p = BoundPointer(index, DataSize::kULONG);
+  if (p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+           (uint32_t)p[3] << 24;
+  }
   return 0xffffffffL & (ReadUByte(index) |
                         ReadUByte(index + 1) << 8 |
                         ReadUByte(index + 2) << 16 |
@@ -129,6 +169,10 @@ int64_t ReadableFontData::ReadULongLE(int32_t index) {
 }
 
 int32_t ReadableFontData::ReadLong(int32_t index) {
+  const byte_t* p = BoundPointer(index, DataSize::kLONG);
+  if (p) {
+    return static_cast<int32_t>(LoadBE32(p));
+  }
   return ReadByte(index) << 24 |
          ReadUByte(index + 1) << 16 |
          ReadUByte(index + 2) << 8 |
@@ -151,6 +195,47 @@ int32_t ReadableFontData::ReadFUFWord(int32_t index) {
   return ReadUShort(index);
 }
 
+int32_t ReadableFontData::ReadUShortArray(int32_t index,
+                                          int32_t count,
+                                          uint16_t* out) {
+  count = std::min<int32_t>(count, (Length() - index) / DataSize::kUSHORT);
+  if (index < 0 || count <= 0) {
+    return 0;
+  }
+  const byte_t* p = BoundPointer(index, count * DataSize::kUSHORT);
+  if (p == NULL) {
+    // Gather the bytes first and swap them in place.
+    count = ReadBytes(index, reinterpret_cast<byte_t*>(out), 0,
+                      count * DataSize::kUSHORT) / DataSize::kUSHORT;
+    p = reinterpret_cast<const byte_t*>(out);
+  }
+  FromBE16Array(p, out, count);
+  return count;
+}
+
+int32_t ReadableFontData::ReadShortArray(int32_t index,
+                                         int32_t count,
+                                         int16_t* out) {
+  return ReadUShortArray(index, count, reinterpret_cast<uint16_t*>(out));
+}
+
+int32_t ReadableFontData::ReadULongArray(int32_t index,
+                                         int32_t count,
+                                         uint32_t* out) {
+  count = std::min<int32_t>(count, (Length() - index) / DataSize::kULONG);
+  if (index < 0 || count <= 0) {
+    return 0;
+  }
+  const byte_t* p = BoundPointer(index, count * DataSize::kULONG);
+  if (p == NULL) {
+    count = ReadBytes(index, reinterpret_cast<byte_t*>(out), 0,
+                      count * DataSize::kULONG) / DataSize::kULONG;
+    p = reinterpret_cast<const byte_t*>(out);
+  }
+  FromBE32Array(p, out, count);
+  return count;
+}
+
 int32_t ReadableFontData::CopyTo(OutputStream* os) {
   return array_->CopyTo(os, BoundOffset(0), Length());
 }
@@ -281,7 +366,7 @@ CALLER_ATTACH FontData* ReadableFontData::Slice(int32_t offset) {
 
 ReadableFontData::ReadableFontData(ReadableFontData* data, int32_t offset)
     : FontData(data, offset),
-      checksum_set_(false),
+      checksum_set_(0),
       checksum_(0) {
 }
 
@@ -289,12 +374,11 @@ ReadableFontData::ReadableFontData(ReadableFontData* data,
                                    int32_t offset,
                                    int32_t length)
     : FontData(data, offset, length),
-      checksum_set_(false),
+      checksum_set_(0),
       checksum_(0) {
 }
 
 void ReadableFontData::ComputeChecksum() {
-  // TODO(arthurhsu): IMPLEMENT: synchronization/atomicity
   int64_t sum = 0;
   if (checksum_range_.empty()) {
     sum = ComputeCheckSum(0, Length());
@@ -310,15 +394,22 @@ void ReadableFontData::ComputeChecksum() {
   }
 
   checksum_ = sum & 0xffffffffL;
-  checksum_set_ = true;
+  AtomicStoreRelease(&checksum_set_, 1);
 }
 
 int64_t ReadableFontData::ComputeCheckSum(int32_t low_bound,
                                           int32_t high_bound) {
   int64_t sum = 0;
-  // Checksum all whole 4-byte chunks.
-  for (int32_t i = low_bound; i <= high_bound - 4; i += 4) {
-    sum += ReadULong(i);
+  // Checksum all whole 4-byte chunks, straight from memory when possible.
+  int32_t whole_chunks = (high_bound - low_bound) / 4;
+  const byte_t* p = whole_chunks > 0 ?
+      BoundPointer(low_bound, whole_chunks * 4) : NULL;
+  if (p) {
+    sum = SumBigEndianULongs(p, whole_chunks);
+  } else {
+    for (int32_t i = low_bound; i <= high_bound - 4; i += 4) {
+      sum += ReadULong(i);
+    }
   }
 
   // Add last fragment if not 4-byte multiple
@@ -164,6 +164,31 @@ class ReadableFontData : public FontData,
   // @throws IndexOutOfBoundsException if index is outside the FontData's range
   virtual int32_t ReadFUFWord(int32_t index);
 
+  // Read consecutive USHORTs starting at the given index in a single pass.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param index index into the font data of the first USHORT
+  // @param count the number of USHORTs to read
+  // @param out the destination, with room for count values
+  // @return the number of values actually read; fewer than count if the font
+  //         data ends first
+  int32_t ReadUShortArray(int32_t index, int32_t count, uint16_t* out);
+
+  // Read consecutive SHORTs starting at the given index in a single pass.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param index index into the font data of the first SHORT
+  // @param count the number of SHORTs to read
+  // @param out the destination, with room for count values
+  // @return the number of values actually read
+  int32_t ReadShortArray(int32_t index, int32_t count, int16_t* out);
+
+  // Read consecutive ULONGs starting at the given index in a single pass.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param index index into the font data of the first ULONG
+  // @param count the number of ULONGs to read
+  // @param out the destination, with room for count values
+  // @return the number of values actually read
+  int32_t ReadULongArray(int32_t index, int32_t count, uint32_t* out);
+
   // Note: Not ported because they just throw UnsupportedOperationException()
   //       in Java.
   /*
@@ -296,8 +321,11 @@ class ReadableFontData : public FontData,
   // @return the checksum for the total range
   int64_t ComputeCheckSum(int32_t low_bound, int32_t high_bound);
 
+  // Guards computing the checksum and changing its ranges. checksum_set_ is
+  // published with release semantics after checksum_ is written so readers
+  // that see it set can skip the lock.
   Lock checksum_lock_;
-  bool checksum_set_;
+  int32_t checksum_set_;
   int64_t checksum_;
   IntegerList checksum_range_;
 };
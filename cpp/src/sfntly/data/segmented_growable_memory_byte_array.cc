@@ -0,0 +1,140 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/data/segmented_growable_memory_byte_array.h"
+
+#include <limits.h>
+#include <string.h>
+
+#include <algorithm>
+
+namespace sfntly {
+
+SegmentedGrowableMemoryByteArray::SegmentedGrowableMemoryByteArray()
+    : ByteArray(0, INT_MAX, true),
+      segment_bits_(kDefaultSegmentBits),
+      segment_size_(1 << kDefaultSegmentBits) {
+}
+
+SegmentedGrowableMemoryByteArray::SegmentedGrowableMemoryByteArray(
+    int32_t segment_bits)
+    : ByteArray(0, INT_MAX, true),
+      segment_bits_(segment_bits),
+      segment_size_(1 << segment_bits) {
+  assert(segment_bits > 0 && segment_bits < 31);
+}
+
+SegmentedGrowableMemoryByteArray::~SegmentedGrowableMemoryByteArray() {
+  Close();
+}
+
+int32_t SegmentedGrowableMemoryByteArray::CopyTo(OutputStream* os,
+                                                 int32_t offset,
+                                                 int32_t length) {
+  assert(os);
+  int32_t copy_count = 0;
+  while (copy_count < length) {
+    int32_t segment_index = SegmentIndex(offset);
+    int32_t segment_offset = SegmentOffset(offset);
+    int32_t copy_length = std::min<int32_t>(length - copy_count,
+                                            segment_size_ - segment_offset);
+    if ((size_t)segment_index >= segments_.size()) {
+      break;
+    }
+    os->Write(segments_[segment_index], segment_offset, copy_length);
+    offset += copy_length;
+    copy_count += copy_length;
+  }
+  return copy_count;
+}
+
+void SegmentedGrowableMemoryByteArray::InternalPut(int32_t index, byte_t b) {
+  WritableSegment(SegmentIndex(index))[SegmentOffset(index)] = b;
+}
+
+int32_t SegmentedGrowableMemoryByteArray::InternalPut(int32_t index,
+                                                      byte_t* b,
+                                                      int32_t offset,
+                                                      int32_t length) {
+  int32_t copy_count = 0;
+  while (copy_count < length) {
+    int32_t segment_offset = SegmentOffset(index);
+    byte_t* segment = WritableSegment(SegmentIndex(index));
+    int32_t copy_length = std::min<int32_t>(length - copy_count,
+                                            segment_size_ - segment_offset);
+    memcpy(segment + segment_offset, b + offset, copy_length);
+    index += copy_length;
+    offset += copy_length;
+    copy_count += copy_length;
+  }
+  return copy_count;
+}
+
+byte_t SegmentedGrowableMemoryByteArray::InternalGet(int32_t index) {
+  size_t segment_index = SegmentIndex(index);
+  if (segment_index >= segments_.size()) {
+    return 0;
+  }
+  return segments_[segment_index][SegmentOffset(index)];
+}
+
+int32_t SegmentedGrowableMemoryByteArray::InternalGet(int32_t index,
+                                                      byte_t* b,
+                                                      int32_t offset,
+                                                      int32_t length) {
+  // ByteArray::Get() limits length to the filled length and every segment
+  // up to there has been allocated.
+  int32_t copy_count = 0;
+  while (copy_count < length) {
+    int32_t segment_index = SegmentIndex(index);
+    int32_t segment_offset = SegmentOffset(index);
+    int32_t copy_length = std::min<int32_t>(length - copy_count,
+                                            segment_size_ - segment_offset);
+    memcpy(b + offset, segments_[segment_index] + segment_offset, copy_length);
+    index += copy_length;
+    offset += copy_length;
+    copy_count += copy_length;
+  }
+  return copy_count;
+}
+
+void SegmentedGrowableMemoryByteArray::Close() {
+  for (size_t i = 0; i < segments_.size(); ++i) {
+    delete[] segments_[i];
+  }
+  segments_.clear();
+}
+
+byte_t* SegmentedGrowableMemoryByteArray::Begin() {
+  if (segments_.empty() || Length() > segment_size_) {
+    return NULL;
+  }
+  return segments_[0];
+}
+
+byte_t* SegmentedGrowableMemoryByteArray::WritableSegment(
+    int32_t segment_index) {
+  // Must fill all segments between the last one created and this one so that
+  // everything below the filled length is readable.
+  while ((size_t)segment_index >= segments_.size()) {
+    byte_t* segment = new byte_t[segment_size_];
+    memset(segment, 0, segment_size_);
+    segments_.push_back(segment);
+  }
+  return segments_[segment_index];
+}
+
+}  // namespace sfntly
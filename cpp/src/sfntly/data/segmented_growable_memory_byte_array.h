@@ -0,0 +1,100 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_DATA_SEGMENTED_GROWABLE_MEMORY_BYTE_ARRAY_H_
+#define SFNTLY_CPP_SRC_SFNTLY_DATA_SEGMENTED_GROWABLE_MEMORY_BYTE_ARRAY_H_
+
+#include <vector>
+
+#include "sfntly/data/byte_array.h"
+
+namespace sfntly {
+
+// A growable memory implementation of the ByteArray interface that stores its
+// data in a chain of separately allocated segments. Growing never moves the
+// bytes already written, so building data of unknown size costs one copy and
+// at most one partly used segment of slack.
+// Note: Unlike the Java version, whose buffers double in size, all segments
+//       here have the same size so that locating a byte is a shift and a mask.
+class SegmentedGrowableMemoryByteArray
+    : public ByteArray,
+      public RefCounted<SegmentedGrowableMemoryByteArray> {
+ public:
+  // Constructor using segments of 2^kDefaultSegmentBits bytes.
+  SegmentedGrowableMemoryByteArray();
+
+  // Constructor.
+  // The segment bits set the size of every segment to 2^(segment bits). If
+  // this is too small there will be many segments and bulk accesses will be
+  // split often. If it's too large there will be a lot of allocated but unused
+  // space at the end.
+  // @param segment_bits the number of bits to use as the offset in a segment
+  explicit SegmentedGrowableMemoryByteArray(int32_t segment_bits);
+  virtual ~SegmentedGrowableMemoryByteArray();
+
+  virtual int32_t CopyTo(OutputStream* os, int32_t offset, int32_t length);
+
+  // Make gcc -Woverloaded-virtual happy.
+  virtual int32_t CopyTo(ByteArray* array) { return ByteArray::CopyTo(array); }
+  virtual int32_t CopyTo(ByteArray* array, int32_t offset, int32_t length) {
+    return ByteArray::CopyTo(array, offset, length);
+  }
+  virtual int32_t CopyTo(int32_t dst_offset,
+                         ByteArray* array,
+                         int32_t src_offset,
+                         int32_t length) {
+    return ByteArray::CopyTo(dst_offset, array, src_offset, length);
+  }
+  virtual int32_t CopyTo(OutputStream* os) { return ByteArray::CopyTo(os); }
+
+  // The data is only contiguous while it fits in the first segment; past that
+  // this returns NULL.
+  virtual byte_t* Begin();
+
+  static const int32_t kDefaultSegmentBits = 16;
+
+ protected:
+  virtual void InternalPut(int32_t index, byte_t b);
+  virtual int32_t InternalPut(int32_t index,
+                              byte_t* b,
+                              int32_t offset,
+                              int32_t length);
+  virtual byte_t InternalGet(int32_t index);
+  virtual int32_t InternalGet(int32_t index,
+                              byte_t* b,
+                              int32_t offset,
+                              int32_t length);
+  virtual void Close();
+
+ private:
+  // Get the segment with the given segment index for writing. If the segment
+  // has not previously been allocated then it is allocated, along with any
+  // segments between it and the last previously allocated one.
+  byte_t* WritableSegment(int32_t segment_index);
+
+  int32_t SegmentIndex(int32_t index) { return index >> segment_bits_; }
+  int32_t SegmentOffset(int32_t index) { return index & (segment_size_ - 1); }
+
+  std::vector<byte_t*> segments_;
+  int32_t segment_bits_;
+  int32_t segment_size_;
+};
+typedef Ptr<SegmentedGrowableMemoryByteArray>
+    SegmentedGrowableMemoryByteArrayPtr;
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_DATA_SEGMENTED_GROWABLE_MEMORY_BYTE_ARRAY_H_
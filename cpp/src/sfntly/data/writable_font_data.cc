@@ -16,11 +16,19 @@
 
 #include "sfntly/data/writable_font_data.h"
 
+#include <algorithm>
+
+#include "sfntly/data/copy_on_write_byte_array.h"
 #include "sfntly/data/memory_byte_array.h"
 #include "sfntly/data/growable_memory_byte_array.h"
+#include "sfntly/data/segmented_growable_memory_byte_array.h"
+#include "sfntly/port/endian.h"
 
 namespace sfntly {
 
+// Stack buffer used to byte swap array writes.
+static const int32_t kArrayWriteBufferSize = 4096;
+
 WritableFontData::WritableFontData(ByteArray* ba) : ReadableFontData(ba) {
 }
 
@@ -29,10 +37,19 @@ WritableFontData::~WritableFontData() {}
 // static
 CALLER_ATTACH
 WritableFontData* WritableFontData::CreateWritableFontData(int32_t length) {
+  return CreateWritableFontData(length, false);
+}
+
+// static
+CALLER_ATTACH
+WritableFontData* WritableFontData::CreateWritableFontData(int32_t length,
+                                                           bool segmented) {
   ByteArrayPtr ba;
   if (length > 0) {
     ba = new MemoryByteArray(length);
     ba->SetFilledLength(length);
+  } else if (segmented) {
+    ba = new SegmentedGrowableMemoryByteArray();
   } else {
     ba = new GrowableMemoryByteArray();
   }
@@ -51,6 +68,16 @@ WritableFontData* WritableFontData::CreateWritableFontData(ByteVector* b) {
   return wfd.Detach();
 }
 
+// static
+CALLER_ATTACH
+WritableFontData* WritableFontData::CreateCopyOnWriteFontData(
+    ReadableFontData* data) {
+  assert(data);
+  ByteArrayPtr ba = new CopyOnWriteByteArray(data);
+  WritableFontDataPtr wfd = new WritableFontData(ba);
+  return wfd.Detach();
+}
+
 int32_t WritableFontData::WriteByte(int32_t index, byte_t b) {
   array_->Put(BoundOffset(index), b);
   return 1;
@@ -155,6 +182,45 @@ int32_t WritableFontData::WriteDateTime(int32_t index, int64_t date) {
   return 8;
 }
 
+int32_t WritableFontData::WriteUShortArray(int32_t index,
+                                           const uint16_t* values,
+                                           int32_t count) {
+  // Swap through a small buffer so that the array sees a few bulk writes.
+  byte_t buffer[kArrayWriteBufferSize];
+  const int32_t chunk = kArrayWriteBufferSize / DataSize::kUSHORT;
+  int32_t written = 0;
+  for (int32_t i = 0; i < count; i += chunk) {
+    int32_t n = std::min<int32_t>(chunk, count - i);
+    ToBE16Array(values + i, buffer, n);
+    int32_t bytes = WriteBytes(index + written, buffer, 0,
+                               n * DataSize::kUSHORT);
+    written += std::max<int32_t>(bytes, 0);
+    if (bytes < n * DataSize::kUSHORT) {
+      break;
+    }
+  }
+  return written;
+}
+
+int32_t WritableFontData::WriteULongArray(int32_t index,
+                                          const uint32_t* values,
+                                          int32_t count) {
+  byte_t buffer[kArrayWriteBufferSize];
+  const int32_t chunk = kArrayWriteBufferSize / DataSize::kULONG;
+  int32_t written = 0;
+  for (int32_t i = 0; i < count; i += chunk) {
+    int32_t n = std::min<int32_t>(chunk, count - i);
+    ToBE32Array(values + i, buffer, n);
+    int32_t bytes = WriteBytes(index + written, buffer, 0,
+                               n * DataSize::kULONG);
+    written += std::max<int32_t>(bytes, 0);
+    if (bytes < n * DataSize::kULONG) {
+      break;
+    }
+  }
+  return written;
+}
+
 void WritableFontData::CopyFrom(InputStream* is, int32_t length) {
   array_->CopyFrom(is, length);
 }
@@ -37,6 +37,18 @@ class WritableFontData : public ReadableFontData {
   // @return a new writable font data
   static CALLER_ATTACH WritableFontData* CreateWritableFontData(int32_t length);
 
+  // Constructs a writable font data object as above, choosing how growable
+  // data is stored.
+  // @param length if length > 0 create a fixed length font data; otherwise
+  //        create a growable font data
+  // @param segmented if true, growable data is kept in fixed size segments
+  //        that are never moved, instead of one contiguous block that is
+  //        reallocated and copied as it grows; ignored if length > 0
+  // @return a new writable font data
+  // Note: C++ port only, the Java version does not choose.
+  static CALLER_ATTACH WritableFontData* CreateWritableFontData(int32_t length,
+                                                                bool segmented);
+
   // Constructs a writable font data object. The new font data object will wrap
   // the bytes passed in to the factory and it will take make a copy of those
   // bytes.
@@ -44,6 +56,15 @@ class WritableFontData : public ReadableFontData {
   // @return a new writable font data
   static CALLER_ATTACH WritableFontData* CreateWritableFontData(ByteVector* b);
 
+  // Constructs a writable font data object that shares the bytes of the data
+  // passed in until the first write to it, when it takes its own copy. The
+  // source data must not be modified while it is shared.
+  // @param data the data to share
+  // @return a new fixed length writable font data
+  // Note: C++ port only, there is no Java equivalent.
+  static CALLER_ATTACH
+      WritableFontData* CreateCopyOnWriteFontData(ReadableFontData* data);
+
   // Write a byte at the given index.
   // @param index index into the font data
   // @param b the byte to write
@@ -168,6 +189,24 @@ class WritableFontData : public ReadableFontData {
   // @throws IndexOutOfBoundsException if index is outside the FontData's range
   virtual int32_t WriteDateTime(int32_t index, int64_t date);
 
+  // Write consecutive USHORTs starting at the given index in a single pass.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param index index into the font data of the first USHORT
+  // @param values the USHORTs
+  // @param count the number of values
+  // @return the number of bytes actually written
+  int32_t WriteUShortArray(int32_t index, const uint16_t* values,
+                           int32_t count);
+
+  // Write consecutive ULONGs starting at the given index in a single pass.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param index index into the font data of the first ULONG
+  // @param values the ULONGs
+  // @param count the number of values
+  // @return the number of bytes actually written
+  int32_t WriteULongArray(int32_t index, const uint32_t* values,
+                          int32_t count);
+
   // Copy from the InputStream into this FontData.
   // @param is the source
   // @param length the number of bytes to copy
@@ -16,7 +16,9 @@
 
 #include "sfntly/font.h"
 
+#include <limits.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <functional>
 #include <algorithm>
@@ -26,10 +28,14 @@
 #include <iterator>
 
 #include "sfntly/data/font_input_stream.h"
+#include "sfntly/data/memory_byte_array.h"
 #include "sfntly/font_factory.h"
 #include "sfntly/math/fixed1616.h"
 #include "sfntly/math/font_math.h"
+#include "sfntly/port/atomic.h"
 #include "sfntly/port/exception_type.h"
+#include "sfntly/port/checksum.h"
+#include "sfntly/port/memory_output_stream.h"
 #include "sfntly/table/core/font_header_table.h"
 #include "sfntly/table/core/horizontal_device_metrics_table.h"
 #include "sfntly/table/core/horizontal_header_table.h"
@@ -43,71 +49,341 @@ namespace sfntly {
 const int32_t SFNTVERSION_MAJOR = 1;
 const int32_t SFNTVERSION_MINOR = 0;
 
+// Neighbouring tables at most this far apart are read from a file together.
+const int32_t kTableReadGap = 4 * 1024;
+
+// The offset of checkSumAdjustment in the head table.
+const int32_t kHeadCheckSumAdjustment = 8;
+
+// Stores a ULONG in big endian byte order.
+static void StoreULong(int64_t value, byte_t* b) {
+  b[0] = (byte_t)(value >> 24);
+  b[1] = (byte_t)(value >> 16);
+  b[2] = (byte_t)(value >> 8);
+  b[3] = (byte_t)value;
+}
+
+// Copies the data of a head table with checkSumAdjustment set to the given
+// value. Returns false, copying nothing, if the adjustment is -1 or the table
+// is too short to have one.
+static bool CopyHeadTable(ReadableFontData* data,
+                          int64_t checksum_adjustment,
+                          ByteVector* head) {
+  if (checksum_adjustment < 0 ||
+      data->Length() < kHeadCheckSumAdjustment + DataSize::kULONG) {
+    return false;
+  }
+  head->resize(data->Length());
+  data->ReadBytes(0, &((*head)[0]), 0, head->size());
+  StoreULong(checksum_adjustment, &((*head)[kHeadCheckSumAdjustment]));
+  return true;
+}
+
+// Computes the checksums of a range of tables, possibly on an executor.
+class TableChecksums : public ParallelForBody {
+ public:
+  TableChecksums(const std::vector<Table*>* tables,
+                 std::vector<int64_t>* checksums)
+      : tables_(tables), checksums_(checksums) {
+  }
+
+  virtual void Run(int32_t begin, int32_t end) {
+    for (int32_t i = begin; i < end; ++i) {
+      (*checksums_)[i] = (*tables_)[i]->CalculatedChecksum();
+    }
+  }
+
+ private:
+  const std::vector<Table*>* tables_;
+  std::vector<int64_t>* checksums_;
+};
+
 /******************************************************************************
  * Font class
  ******************************************************************************/
 Font::~Font() {}
 
+CALLER_ATTACH Font* Font::GetOTFFont(FontFactory* factory,
+                                     WritableFontData* wfd,
+                                     int32_t offset_to_offset_table) {
+  return GetOTFFont(factory, wfd, offset_to_offset_table, NULL);
+}
+
+CALLER_ATTACH Font* Font::GetOTFFont(FontFactory* factory,
+                                     WritableFontData* wfd,
+                                     int32_t offset_to_offset_table,
+                                     TableCache* table_cache) {
+  assert(wfd);
+  ByteVector digest;
+  FontPtr font =
+      new Font(wfd->ReadFixed(offset_to_offset_table + Offset::kSfntVersion),
+               &digest);
+  font->arena_ = Arena::Current();
+  font->table_cache_ = table_cache;
+
+  HeaderOffsetSortedSet records;
+  ReadTableRecords(wfd, offset_to_offset_table,
+                   wfd->ReadUShort(offset_to_offset_table + Offset::kNumTables),
+                   &records);
+  FilterTables(factory ? factory->table_filter() : NULL, &records,
+               &font->unloaded_tables_);
+  font->unbuilt_tables_.reserve(records.size());
+  font->tables_.reserve(records.size());
+  for (HeaderOffsetSortedSet::iterator record = records.begin(),
+                                       record_end = records.end();
+                                       record != record_end; ++record) {
+    // The entry is filled in place so that no reference changes hands.
+    std::pair<TableDataBlockMap::iterator, bool> inserted =
+        font->unbuilt_tables_.insert(
+            TableDataBlockMap::value_type((*record)->tag(), DataBlockEntry()));
+    if (!inserted.second) {
+      continue;
+    }
+    DataBlockEntry* block = &(inserted.first->second);
+    block->first = *record;
+    block->second.Attach(down_cast<WritableFontData*>(
+        wfd->Slice((*record)->offset(), (*record)->length())));
+    if (table_cache) {
+      table_cache->ShareDataBlock(block);
+    }
+  }
+  font->IndexTables();
+  return font.Detach();
+}
+
+int32_t Font::num_tables() {
+  int32_t count = 0;
+  for (TableSlotMap::iterator slot = table_slots_.begin(),
+                              slot_end = table_slots_.end();
+                              slot != slot_end; ++slot) {
+    // Tables that failed to build are gone from the font.
+    if (!AtomicLoadAcquire(&(slot->second.built)) ||
+        slot->second.table != NULL) {
+      ++count;
+    }
+  }
+  return count;
+}
+
 bool Font::HasTable(int32_t tag) {
-  TableMap::const_iterator result = tables_.find(tag);
-  TableMap::const_iterator end = tables_.end();
-  return (result != end);
+  TableSlotMap::iterator slot = table_slots_.find(tag);
+  return slot != table_slots_.end() &&
+         (!AtomicLoadAcquire(&(slot->second.built)) ||
+          slot->second.table != NULL);
 }
 
 Table* Font::GetTable(int32_t tag) {
-  if (!HasTable(tag)) {
+  // The slots are fixed once the font is made and a built table never
+  // changes, so only building one needs the lock.
+  TableSlotMap::iterator slot = table_slots_.find(tag);
+  if (slot == table_slots_.end()) {
     return NULL;
   }
-  return tables_[tag];
+  if (AtomicLoadAcquire(&(slot->second.built))) {
+    return slot->second.table;
+  }
+  AutoLock lock(lock_);
+  TableMap::iterator table = tables_.find(tag);
+  if (table != tables_.end()) {
+    return table->second;
+  }
+  return BuildTable(tag);
 }
 
 const TableMap* Font::GetTableMap() {
+  BuildAllTables();
   return &tables_;
 }
 
 void Font::Serialize(OutputStream* os, IntegerList* table_ordering) {
+  Serialize(os, table_ordering, NULL, true);
+}
+
+void Font::Serialize(GatherOutput* output, IntegerList* table_ordering) {
+  Serialize(output, table_ordering, NULL, true);
+}
+
+size_t Font::SerializedSize(const IntegerList& table_ordering) {
+  BuildAllTables();
+  IntegerList ordering(table_ordering);
+  IntegerList final_table_ordering;
+  GenerateTableOrdering(&ordering, &final_table_ordering);
+  size_t size = Offset::kTableRecordBegin;
+  for (IntegerList::iterator tag = final_table_ordering.begin(),
+                             tag_end = final_table_ordering.end();
+                             tag != tag_end; ++tag) {
+    Table* table = GetTable(*tag);
+    if (table != NULL) {
+      size += Offset::kTableRecordSize + ((table->DataLength() + 3) & ~3);
+    }
+  }
+  return size;
+}
+
+size_t Font::SerializeTo(byte_t* dst,
+                         size_t capacity,
+                         const IntegerList& table_ordering) {
+  return SerializeTo(dst, capacity, table_ordering, NULL, true);
+}
+
+void Font::Serialize(OutputStream* os,
+                     IntegerList* table_ordering,
+                     Executor* executor,
+                     bool checksums) {
   assert(table_ordering);
+  BuildAllTables();
   IntegerList final_table_ordering;
   GenerateTableOrdering(table_ordering, &final_table_ordering);
   TableHeaderList table_records;
-  BuildTableHeadersForSerialization(&final_table_ordering, &table_records);
+  BuildTableHeadersForSerialization(&final_table_ordering, executor,
+                                    checksums,
+                                    &table_records);
+
+  MemoryOutputStream header;
+  FontOutputStream header_fos(&header);
+  SerializeHeader(&header_fos, &table_records);
+  int64_t checksum_adjustment = checksums ?
+      ChecksumAdjustment(header.Get(), header.Size(), &table_records) : -1;
 
   FontOutputStream fos(os);
+  fos.Write(header.Get(), 0, header.Size());
+  SerializeTables(&fos, &table_records, checksum_adjustment);
+}
+
+void Font::Serialize(GatherOutput* output,
+                     IntegerList* table_ordering,
+                     Executor* executor,
+                     bool checksums) {
+  assert(output);
+  assert(table_ordering);
+  BuildAllTables();
+  IntegerList final_table_ordering;
+  GenerateTableOrdering(table_ordering, &final_table_ordering);
+  TableHeaderList table_records;
+  BuildTableHeadersForSerialization(&final_table_ordering, executor,
+                                    checksums,
+                                    &table_records);
+
+  // The sfnt header and table directory are small enough to copy.
+  MemoryOutputStream header;
+  FontOutputStream fos(&header);
   SerializeHeader(&fos, &table_records);
-  SerializeTables(&fos, &table_records);
+  output->AppendCopy(header.Get(), header.Size());
+  int64_t checksum_adjustment = checksums ?
+      ChecksumAdjustment(header.Get(), header.Size(), &table_records) : -1;
+  SerializeTables(output, &table_records, checksum_adjustment);
+}
+
+size_t Font::SerializeTo(byte_t* dst,
+                         size_t capacity,
+                         const IntegerList& table_ordering,
+                         Executor* executor,
+                         bool checksums) {
+  size_t size = SerializedSize(table_ordering);
+  if (dst == NULL || capacity < size) {
+    return 0;
+  }
+  IntegerList ordering(table_ordering);
+  IntegerList final_table_ordering;
+  GenerateTableOrdering(&ordering, &final_table_ordering);
+  TableHeaderList table_records;
+  BuildTableHeadersForSerialization(&final_table_ordering, executor,
+                                    checksums,
+                                    &table_records);
+
+  MemoryOutputStream header;
+  FontOutputStream fos(&header);
+  SerializeHeader(&fos, &table_records);
+  memcpy(dst, header.Get(), header.Size());
+  int64_t checksum_adjustment = checksums ?
+      ChecksumAdjustment(header.Get(), header.Size(), &table_records) : -1;
+
+  // The table records carry each table's offset in the output.
+  for (TableHeaderList::iterator record = table_records.begin(),
+                                 end_of_headers = table_records.end();
+                                 record != end_of_headers; ++record) {
+    BorrowedPtr<Table> target_table = GetTable((*record)->tag());
+    if (target_table == NULL) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+      throw IOException("Table out of sync with font header.");
+#endif
+      return 0;
+    }
+    byte_t* table_start = dst + (*record)->offset();
+    int32_t table_size = target_table->DataLength();
+    int32_t bytes_read =
+        target_table->ReadFontData()->ReadBytes(0, table_start, 0, table_size);
+    if (bytes_read != (*record)->length()) {
+      assert(false);
+    }
+    memset(table_start + table_size, 0, ((table_size + 3) & ~3) - table_size);
+    if ((*record)->tag() == Tag::head && checksum_adjustment >= 0 &&
+        table_size >= kHeadCheckSumAdjustment + DataSize::kULONG) {
+      StoreULong(checksum_adjustment,
+                 table_start + kHeadCheckSumAdjustment);
+    }
+  }
+  return size;
 }
 
 Font::Font(int32_t sfnt_version, ByteVector* digest)
-    : sfnt_version_(sfnt_version) {
+    : sfnt_version_(sfnt_version),
+      all_tables_built_(0) {
   // non-trivial assignments that makes debugging hard if placed in
   // initialization list
   digest_ = *digest;
 }
 
 void Font::BuildTableHeadersForSerialization(IntegerList* table_ordering,
+                                             Executor* executor,
+                                             bool checksums,
                                              TableHeaderList* table_headers) {
   assert(table_headers);
   assert(table_ordering);
 
   IntegerList final_table_ordering;
   GenerateTableOrdering(table_ordering, &final_table_ordering);
-  int32_t table_offset = Offset::kTableRecordBegin + num_tables() *
-                         Offset::kTableRecordSize;
+  std::vector<Table*> tables;
+  tables.reserve(final_table_ordering.size());
   for (IntegerList::iterator tag = final_table_ordering.begin(),
                              tag_end = final_table_ordering.end();
                              tag != tag_end; ++tag) {
-    if (tables_.find(*tag) == tables_.end()) {
-      continue;
-    }
-    TablePtr table = tables_[*tag];
-    if (table != NULL) {
-      HeaderPtr header =
-          new Header(*tag, table->CalculatedChecksum(), table_offset,
-                     table->header()->length());
-      table_headers->push_back(header);
-      table_offset += (table->DataLength() + 3) & ~3;
+    TableMap::iterator table = tables_.find(*tag);
+    if (table != tables_.end() && table->second != NULL) {
+      tables.push_back(table->second);
     }
   }
+
+  std::vector<int64_t> table_checksums(tables.size(), 0);
+  if (checksums) {
+    // Table sizes vary widely, so every table may be a task of its own.
+    TableChecksums body(&tables, &table_checksums);
+    ParallelFor(executor, 0, (int32_t)tables.size(), 1, &body);
+  }
+
+  int32_t table_offset = Offset::kTableRecordBegin + num_tables() *
+                         Offset::kTableRecordSize;
+  for (size_t i = 0; i < tables.size(); ++i) {
+    Table* table = tables[i];
+    table_headers->push_back(
+        new Header(table->header()->tag(), table_checksums[i],
+                   table_offset, table->header()->length()));
+    table_offset += (table->DataLength() + 3) & ~3;
+  }
+}
+
+// static
+int64_t Font::ChecksumAdjustment(const byte_t* header,
+                                 size_t header_size,
+                                 TableHeaderList* table_headers) {
+  assert(header_size % 4 == 0);
+  uint64_t sum = SumBigEndianULongs(header, header_size / 4);
+  for (TableHeaderList::iterator record = table_headers->begin(),
+                                 record_end = table_headers->end();
+                                 record != record_end; ++record) {
+    sum += (*record)->checksum();
+  }
+  return (0xB1B0AFBAL - (int64_t)(sum & 0xffffffffL)) & 0xffffffffL;
 }
 
 void Font::SerializeHeader(FontOutputStream* fos,
@@ -136,27 +412,69 @@ void Font::SerializeHeader(FontOutputStream* fos,
 }
 
 void Font::SerializeTables(FontOutputStream* fos,
-                           TableHeaderList* table_headers) {
+                           TableHeaderList* table_headers,
+                           int64_t checksum_adjustment) {
   assert(fos);
   assert(table_headers);
   for (TableHeaderList::iterator record = table_headers->begin(),
                                  end_of_headers = table_headers->end();
                                  record != end_of_headers; ++record) {
-    TablePtr target_table = GetTable((*record)->tag());
+    BorrowedPtr<Table> target_table = GetTable((*record)->tag());
     if (target_table == NULL) {
 #if !defined (SFNTLY_NO_EXCEPTION)
       throw IOException("Table out of sync with font header.");
 #endif
       return;
     }
-    int32_t table_size = target_table->Serialize(fos);
+    int32_t table_size;
+    ByteVector head;
+    if ((*record)->tag() == Tag::head &&
+        CopyHeadTable(target_table->ReadFontData(), checksum_adjustment,
+                      &head)) {
+      table_size = (int32_t)head.size();
+      fos->Write(&head);
+    } else {
+      table_size = target_table->Serialize(fos);
+    }
     if (table_size != (*record)->length()) {
       assert(false);
     }
     int32_t filler_size = ((table_size + 3) & ~3) - table_size;
-    for (int32_t i = 0; i < filler_size; ++i) {
-      fos->Write(static_cast<byte_t>(0));
+    if (filler_size > 0) {
+      byte_t filler[3] = { 0, 0, 0 };
+      fos->Write(filler, 0, filler_size);
+    }
+  }
+}
+
+void Font::SerializeTables(GatherOutput* output,
+                           TableHeaderList* table_headers,
+                           int64_t checksum_adjustment) {
+  assert(output);
+  assert(table_headers);
+  for (TableHeaderList::iterator record = table_headers->begin(),
+                                 end_of_headers = table_headers->end();
+                                 record != end_of_headers; ++record) {
+    BorrowedPtr<Table> target_table = GetTable((*record)->tag());
+    if (target_table == NULL) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+      throw IOException("Table out of sync with font header.");
+#endif
+      return;
     }
+    BorrowedPtr<ReadableFontData> data = target_table->ReadFontData();
+    int32_t table_size = data->Length();
+    if (table_size != (*record)->length()) {
+      assert(false);
+    }
+    ByteVector head;
+    if ((*record)->tag() == Tag::head &&
+        CopyHeadTable(data, checksum_adjustment, &head)) {
+      output->AppendCopy(&(head[0]), head.size());
+    } else {
+      output->Append(data);
+    }
+    output->AppendPadding(((table_size + 3) & ~3) - table_size);
   }
 }
 
@@ -207,6 +525,265 @@ void Font::DefaultTableOrdering(IntegerList* default_table_ordering) {
             default_table_ordering->begin());
 }
 
+void Font::TableDependencies(int32_t tag, IntegerList* dependencies) {
+  assert(dependencies);
+  dependencies->clear();
+  if (tag == Tag::hmtx) {
+    dependencies->push_back(Tag::hhea);
+    dependencies->push_back(Tag::maxp);
+  } else if (tag == Tag::loca) {
+    dependencies->push_back(Tag::head);
+    dependencies->push_back(Tag::maxp);
+#if defined (SFNTLY_EXPERIMENTAL)
+  } else if (tag == Tag::hdmx) {
+    dependencies->push_back(Tag::maxp);
+#endif
+  }
+}
+
+void Font::ReadTableRecords(ReadableFontData* fd,
+                            int32_t offset,
+                            int32_t num_tables,
+                            HeaderOffsetSortedSet* records) {
+  assert(records);
+  int32_t table_offset = offset + Offset::kTableRecordBegin;
+  for (int32_t table_number = 0;
+       table_number < num_tables;
+       table_number++, table_offset += Offset::kTableRecordSize) {
+    int32_t tag = fd->ReadULongAsInt(table_offset + Offset::kTableTag);
+    int64_t checksum = fd->ReadULong(table_offset + Offset::kTableCheckSum);
+    int32_t offset = fd->ReadULongAsInt(table_offset + Offset::kTableOffset);
+    int32_t length = fd->ReadULongAsInt(table_offset + Offset::kTableLength);
+    HeaderPtr table = new Header(tag, checksum, offset, length);
+    records->insert(table);
+  }
+}
+
+void Font::FilterTables(const IntegerSet* filter,
+                        HeaderOffsetSortedSet* records,
+                        HeaderTagSortedSet* unloaded_tables) {
+  if (filter == NULL) {
+    return;
+  }
+  // Keep what InterRelateBuilders() needs for the tables asked for.
+  IntegerSet tags(*filter);
+  for (IntegerSet::const_iterator tag = filter->begin(),
+                                  tag_end = filter->end();
+                                  tag != tag_end; ++tag) {
+    IntegerList dependencies;
+    TableDependencies(*tag, &dependencies);
+    tags.insert(dependencies.begin(), dependencies.end());
+  }
+  for (HeaderOffsetSortedSet::iterator record = records->begin();
+       record != records->end();) {
+    if (tags.count((*record)->tag())) {
+      ++record;
+    } else {
+      unloaded_tables->insert(*record);
+      records->erase(record++);
+    }
+  }
+}
+
+CALLER_ATTACH Table* Font::LoadUnloadedTable(int32_t tag,
+                                             ReadableFontData* source) {
+  assert(source);
+  HeaderPtr record;
+  for (HeaderTagSortedSet::iterator header = unloaded_tables_.begin(),
+                                    header_end = unloaded_tables_.end();
+                                    header != header_end; ++header) {
+    if ((*header)->tag() == tag) {
+      record = *header;
+      break;
+    }
+  }
+  if (record == NULL || record->offset() < 0 || record->length() < 0 ||
+      record->offset() > source->Length() - record->length()) {
+    return NULL;
+  }
+  TableMap related_tables;
+  IntegerList dependencies;
+  TableDependencies(tag, &dependencies);
+  for (IntegerList::iterator dependency = dependencies.begin(),
+                             dependency_end = dependencies.end();
+                             dependency != dependency_end; ++dependency) {
+    TablePtr related_table = GetTable(*dependency);
+    if (related_table == NULL) {
+      related_table.Attach(LoadUnloadedTable(*dependency, source));
+    }
+    if (related_table != NULL) {
+      related_tables.insert(TableMapEntry(*dependency, related_table));
+    }
+  }
+  ReadableFontDataPtr data;
+  data.Attach(down_cast<ReadableFontData*>(
+      source->Slice(record->offset(), record->length())));
+  return Table::GetTable(record, data, &related_tables);
+}
+
+Table* Font::BuildTable(int32_t tag) {
+  TableDataBlockMap::iterator record = unbuilt_tables_.find(tag);
+  if (record == unbuilt_tables_.end()) {
+    // A table whose record is gone but which was never published failed when
+    // a table it needs threw.
+    TableSlotMap::iterator slot = table_slots_.find(tag);
+    if (slot != table_slots_.end() && !slot->second.built) {
+      PublishTable(tag, NULL);
+    }
+    return NULL;
+  }
+  ArenaScope scope(arena_);
+  TablePtr table;
+  IntegerList key;
+  if (table_cache_ != NULL) {
+    TableCacheKey(tag, &key);
+    table = table_cache_->FindTable(key);
+  }
+  DataBlockEntry table_data;
+  table_data.first.swap(record->second.first);
+  table_data.second.swap(record->second.second);
+  unbuilt_tables_.erase(record);
+
+  if (table == NULL) {
+    // The tables it needs are built first and pass their values to it.
+    TableMap related_tables;
+    IntegerList dependencies;
+    TableDependencies(tag, &dependencies);
+    for (IntegerList::iterator dependency = dependencies.begin(),
+                               dependency_end = dependencies.end();
+                               dependency != dependency_end; ++dependency) {
+      TableMap::iterator built = tables_.find(*dependency);
+      Table* related_table =
+          built != tables_.end() ? built->second.p_ : BuildTable(*dependency);
+      if (related_table != NULL) {
+        related_tables.insert(TableMapEntry(*dependency, related_table));
+      }
+    }
+    table.Attach(Table::GetTable(table_data.first, table_data.second,
+                                 &related_tables));
+    if (table != NULL && table_cache_ != NULL) {
+      table = table_cache_->ShareTable(key, table);
+    }
+  }
+  if (table == NULL) {
+    PublishTable(tag, NULL);
+#if !defined (SFNTLY_NO_EXCEPTION)
+    std::string builder_string = "Unable to build table - ";
+    char* table_name = TagToString(tag);
+    builder_string += table_name;
+    delete[] table_name;
+    throw RuntimeException(builder_string.c_str());
+#endif
+    return NULL;
+  }
+  tables_.insert(TableMapEntry(tag, table));
+  PublishTable(tag, table);
+  return table;
+}
+
+void Font::IndexTables() {
+  for (TableMap::iterator table = tables_.begin(), table_end = tables_.end();
+                          table != table_end; ++table) {
+    TableSlot* slot = &(table_slots_[table->first]);
+    slot->built = 1;
+    slot->table = table->second;
+  }
+  for (TableDataBlockMap::iterator record = unbuilt_tables_.begin(),
+                                   record_end = unbuilt_tables_.end();
+                                   record != record_end; ++record) {
+    table_slots_[record->first];
+  }
+  all_tables_built_ = unbuilt_tables_.empty() ? 1 : 0;
+}
+
+void Font::PublishTable(int32_t tag, Table* table) {
+  TableSlotMap::iterator slot = table_slots_.find(tag);
+  assert(slot != table_slots_.end());
+  slot->second.table = table;
+  AtomicStoreRelease(&(slot->second.built), 1);
+}
+
+void Font::BuildAllTables() {
+  if (AtomicLoadAcquire(&all_tables_built_)) {
+    return;
+  }
+  AutoLock lock(lock_);
+  while (!unbuilt_tables_.empty()) {
+    BuildTable(unbuilt_tables_.begin()->first);
+  }
+  // Only now is tables_ final, so GetTableMap() may skip the lock after.
+  AtomicStoreRelease(&all_tables_built_, 1);
+}
+
+void Font::TableCacheKey(int32_t tag, IntegerList* key) {
+  assert(key);
+  key->clear();
+  key->push_back(tag);
+  IntegerList tags;
+  tags.push_back(tag);
+  IntegerList dependencies;
+  TableDependencies(tag, &dependencies);
+  tags.insert(tags.end(), dependencies.begin(), dependencies.end());
+  for (IntegerList::iterator t = tags.begin(), e = tags.end(); t != e; ++t) {
+    Header* header = NULL;
+    TableDataBlockMap::iterator record = unbuilt_tables_.find(*t);
+    if (record != unbuilt_tables_.end()) {
+      header = record->second.first;
+    } else {
+      TableMap::iterator table = tables_.find(*t);
+      if (table != tables_.end()) {
+        header = table->second->header();
+      }
+    }
+    key->push_back(header ? header->offset() : -1);
+    key->push_back(header ? header->length() : -1);
+  }
+}
+
+/******************************************************************************
+ * Font::TableCache class
+ ******************************************************************************/
+Font::TableCache::TableCache() {}
+
+Font::TableCache::~TableCache() {}
+
+size_t Font::TableCache::num_tables() {
+  AutoLock lock(lock_);
+  return tables_.size();
+}
+
+void Font::TableCache::ShareDataBlock(DataBlockEntry* block) {
+  assert(block);
+  IntegerList key;
+  key.push_back(block->first->tag());
+  key.push_back(block->first->offset());
+  key.push_back(block->first->length());
+  AutoLock lock(lock_);
+  std::map<IntegerList, DataBlockEntry>::iterator shared =
+      data_blocks_.find(key);
+  if (shared != data_blocks_.end()) {
+    *block = shared->second;
+  } else {
+    data_blocks_.insert(std::make_pair(key, *block));
+  }
+}
+
+Table* Font::TableCache::FindTable(const IntegerList& key) {
+  AutoLock lock(lock_);
+  std::map<IntegerList, TablePtr>::iterator shared = tables_.find(key);
+  return shared != tables_.end() ? shared->second.p_ : NULL;
+}
+
+Table* Font::TableCache::ShareTable(const IntegerList& key, Table* table) {
+  AutoLock lock(lock_);
+  std::map<IntegerList, TablePtr>::iterator shared = tables_.find(key);
+  if (shared != tables_.end()) {
+    return shared->second;
+  }
+  tables_.insert(std::make_pair(key, TablePtr(table)));
+  return table;
+}
+
 /******************************************************************************
  * Font::Builder class
  ******************************************************************************/
@@ -234,6 +811,15 @@ CALLER_ATTACH Font::Builder* Font::Builder::GetOTFBuilder(
   return builder.Detach();
 }
 
+CALLER_ATTACH Font::Builder* Font::Builder::GetOTFBuilder(
+    FontFactory* factory,
+    RandomAccessFileInputStream* is,
+    int32_t offset_to_offset_table) {
+  FontBuilderPtr builder = new Builder(factory);
+  builder->LoadFont(is, offset_to_offset_table);
+  return builder.Detach();
+}
+
 bool Font::Builder::ReadyToBuild() {
   // just read in data with no manipulation
   if (table_builders_.empty() && !data_blocks_.empty()) {
@@ -252,15 +838,25 @@ bool Font::Builder::ReadyToBuild() {
 }
 
 CALLER_ATTACH Font* Font::Builder::Build() {
+  ArenaScope scope(arena_);
   FontPtr font = new Font(sfnt_version_, &digest_);
-
-  if (!table_builders_.empty()) {
-    // Note: Different from Java. Directly use font->tables_ here to avoid
-    //       STL container copying.
-    BuildTablesFromBuilders(font, &table_builders_, &font->tables_);
+  font->tables_.reserve(table_builders_.size() + unbuilt_tables_.size());
+
+  // Note: Different from Java. Directly use font->tables_ here to avoid
+  //       STL container copying.
+  bool built = table_builders_.empty() ||
+      BuildTablesFromBuilders(font, &table_builders_, &font->tables_);
+  // Tables whose builders were never made are built by the font on first
+  // access, unless building the others failed.
+  if (built) {
+    font->unbuilt_tables_.swap(unbuilt_tables_);
   }
+  font->unloaded_tables_.swap(unloaded_tables_);
+  font->arena_ = arena_;
+  font->IndexTables();
 
   table_builders_.clear();
+  unbuilt_tables_.clear();
   data_blocks_.clear();
   return font.Detach();
 }
@@ -272,22 +868,33 @@ void Font::Builder::SetDigest(ByteVector* digest) {
 
 void Font::Builder::ClearTableBuilders() {
   table_builders_.clear();
+  unbuilt_tables_.clear();
 }
 
 bool Font::Builder::HasTableBuilder(int32_t tag) {
-  return (table_builders_.find(tag) != table_builders_.end());
+  return table_builders_.find(tag) != table_builders_.end() ||
+         unbuilt_tables_.find(tag) != unbuilt_tables_.end();
 }
 
 Table::Builder* Font::Builder::GetTableBuilder(int32_t tag) {
-  if (HasTableBuilder(tag))
-    return table_builders_[tag];
-  return NULL;
+  TableBuilderMap::iterator builder = table_builders_.find(tag);
+  if (builder != table_builders_.end()) {
+    return builder->second;
+  }
+  return BuildTableBuilder(tag);
+}
+
+TableBuilderMap* Font::Builder::table_builders() {
+  BuildAllTableBuilders();
+  return &table_builders_;
 }
 
 Table::Builder* Font::Builder::NewTableBuilder(int32_t tag) {
+  ArenaScope scope(arena_);
   HeaderPtr header = new Header(tag);
   TableBuilderPtr builder;
   builder.Attach(Table::Builder::GetBuilder(header, NULL));
+  unbuilt_tables_.erase(tag);
   table_builders_.insert(TableBuilderEntry(header->tag(), builder));
   return builder;
 }
@@ -295,14 +902,15 @@ Table::Builder* Font::Builder::NewTableBuilder(int32_t tag) {
 Table::Builder* Font::Builder::NewTableBuilder(int32_t tag,
                                                ReadableFontData* src_data) {
   assert(src_data);
+  ArenaScope scope(arena_);
+  // Share the original data; it is only copied if the builder writes to it.
   WritableFontDataPtr data;
-  data.Attach(WritableFontData::CreateWritableFontData(src_data->Length()));
-  // TODO(stuarg): take over original data instead?
-  src_data->CopyTo(data);
+  data.Attach(WritableFontData::CreateCopyOnWriteFontData(src_data));
 
   HeaderPtr header = new Header(tag, data->Length());
   TableBuilderPtr builder;
   builder.Attach(Table::Builder::GetBuilder(header, data));
+  unbuilt_tables_.erase(tag);
   table_builders_.insert(TableBuilderEntry(tag, builder));
   return builder;
 }
@@ -312,10 +920,12 @@ void Font::Builder::RemoveTableBuilder(int32_t tag) {
   if (target != table_builders_.end()) {
     table_builders_.erase(target);
   }
+  unbuilt_tables_.erase(tag);
 }
 
 Font::Builder::Builder(FontFactory* factory)
-    : factory_(factory),
+    : arena_(Arena::Current()),
+      factory_(factory),
       sfnt_version_(Fixed1616::Fixed(SFNTVERSION_MAJOR, SFNTVERSION_MINOR)) {
 }
 
@@ -325,8 +935,10 @@ void Font::Builder::LoadFont(InputStream* is) {
   FontInputStream font_is(is);
   HeaderOffsetSortedSet records;
   ReadHeader(&font_is, &records);
+  Font::FilterTables(factory_ ? factory_->table_filter() : NULL, &records,
+                     &unloaded_tables_);
   LoadTableData(&records, &font_is, &data_blocks_);
-  BuildAllTableBuilders(&data_blocks_, &table_builders_);
+  DeferTableBuilders(&data_blocks_);
   font_is.Close();
 }
 
@@ -336,25 +948,70 @@ void Font::Builder::LoadFont(WritableFontData* wfd,
   assert(wfd);
   HeaderOffsetSortedSet records;
   ReadHeader(wfd, offset_to_offset_table, &records);
+  Font::FilterTables(factory_ ? factory_->table_filter() : NULL, &records,
+                     &unloaded_tables_);
   LoadTableData(&records, wfd, &data_blocks_);
-  BuildAllTableBuilders(&data_blocks_, &table_builders_);
+  DeferTableBuilders(&data_blocks_);
+}
+
+void Font::Builder::LoadFont(RandomAccessFileInputStream* is,
+                             int32_t offset_to_offset_table) {
+  // Note: we do not throw exception here for is.  This is more of an assertion.
+  assert(is);
+  HeaderOffsetSortedSet records;
+  ReadHeader(is, offset_to_offset_table, &records);
+  Font::FilterTables(factory_ ? factory_->table_filter() : NULL, &records,
+                     &unloaded_tables_);
+  LoadTableData(&records, is, &data_blocks_);
+  DeferTableBuilders(&data_blocks_);
 }
 
 int32_t Font::Builder::SfntWrapperSize() {
   return Offset::kSfntHeaderSize +
-         (Offset::kTableRecordSize * table_builders_.size());
+         (Offset::kTableRecordSize * number_of_table_builders());
 }
 
-void Font::Builder::BuildAllTableBuilders(DataBlockMap* table_data,
-                                          TableBuilderMap* builder_map) {
+void Font::Builder::DeferTableBuilders(DataBlockMap* table_data) {
   for (DataBlockMap::iterator record = table_data->begin(),
                               record_end = table_data->end();
                               record != record_end; ++record) {
-    TableBuilderPtr builder;
-    builder.Attach(GetTableBuilder(record->first.p_, record->second.p_));
-    builder_map->insert(TableBuilderEntry(record->first->tag(), builder));
+    unbuilt_tables_.insert(std::make_pair(record->first->tag(), *record));
+  }
+}
+
+Table::Builder* Font::Builder::BuildTableBuilder(int32_t tag) {
+  TableDataBlockMap::iterator record = unbuilt_tables_.find(tag);
+  if (record == unbuilt_tables_.end()) {
+    return NULL;
+  }
+  ArenaScope scope(arena_);
+  TableBuilderPtr builder;
+  builder.Attach(GetTableBuilder(record->second.first, record->second.second));
+  unbuilt_tables_.erase(record);
+  table_builders_.insert(TableBuilderEntry(tag, builder));
+
+  // Relate it to the builders of the tables it needs, made first if need be.
+  TableBuilderMap related_builders;
+  related_builders.insert(TableBuilderEntry(tag, builder));
+  IntegerList dependencies;
+  TableDependencies(tag, &dependencies);
+  for (IntegerList::iterator dependency = dependencies.begin(),
+                             dependency_end = dependencies.end();
+                             dependency != dependency_end; ++dependency) {
+    Table::Builder* dependency_builder = GetTableBuilder(*dependency);
+    if (dependency_builder != NULL) {
+      related_builders.insert(
+          TableBuilderEntry(*dependency, dependency_builder));
+    }
+  }
+  InterRelateBuilders(&related_builders);
+  return builder;
+}
+
+void Font::Builder::BuildAllTableBuilders() {
+  while (!unbuilt_tables_.empty()) {
+    BuildTableBuilder(unbuilt_tables_.begin()->first);
   }
-  InterRelateBuilders(&table_builders_);
 }
 
 CALLER_ATTACH
@@ -363,12 +1020,18 @@ Table::Builder* Font::Builder::GetTableBuilder(Header* header,
   return Table::Builder::GetBuilder(header, data);
 }
 
-void Font::Builder::BuildTablesFromBuilders(Font* font,
+bool Font::Builder::BuildTablesFromBuilders(Font* font,
                                             TableBuilderMap* builder_map,
                                             TableMap* table_map) {
   UNREFERENCED_PARAMETER(font);
   InterRelateBuilders(builder_map);
 
+  Executor* executor = factory_ ? factory_->executor() : NULL;
+  if (executor != NULL && executor->num_threads() > 0 &&
+      builder_map->size() > 1) {
+    return BuildTablesConcurrently(executor, builder_map, table_map);
+  }
+
   // Now build all the tables.
   for (TableBuilderMap::iterator builder = builder_map->begin(),
                                  builder_end = builder_map->end();
@@ -386,10 +1049,100 @@ void Font::Builder::BuildTablesFromBuilders(Font* font,
       delete[] table_name;
       throw RuntimeException(builder_string.c_str());
 #endif
-      return;
+      return false;
+    }
+    int32_t tag = table->header()->tag();
+    (*table_map)[tag].swap(table);
+  }
+  return true;
+}
+
+// Builds one table of a font builder on an executor.
+class TableBuildTask : public Executor::Task {
+ public:
+  TableBuildTask(Table::Builder* builder, Arena* arena)
+      : builder_(builder), arena_(arena) {
+  }
+
+  virtual void Run() {
+    ArenaScope scope(arena_);
+#if !defined (SFNTLY_NO_EXCEPTION)
+    // Failures are reported on the thread that asked for the build.
+    try {
+#endif
+      if (builder_ != NULL && builder_->ReadyToBuild()) {
+        table_.Attach(down_cast<Table*>(builder_->Build()));
+      }
+#if !defined (SFNTLY_NO_EXCEPTION)
+    } catch (...) {
+      table_.Release();
+    }
+#endif
+  }
+
+  TablePtr& table() { return table_; }
+
+ private:
+  TableBuilderPtr builder_;
+  ArenaPtr arena_;
+  TablePtr table_;
+};
+
+bool Font::Builder::BuildTablesConcurrently(Executor* executor,
+                                            TableBuilderMap* builder_map,
+                                            TableMap* table_map) {
+  assert(executor);
+  IntegerSet required_tags;
+  for (TableBuilderMap::iterator builder = builder_map->begin(),
+                                 builder_end = builder_map->end();
+                                 builder != builder_end; ++builder) {
+    IntegerList dependencies;
+    TableDependencies(builder->first, &dependencies);
+    required_tags.insert(dependencies.begin(), dependencies.end());
+  }
+
+  std::vector<TableBuildTask> tasks;
+  tasks.reserve(builder_map->size());
+  for (TableBuilderMap::iterator builder = builder_map->begin(),
+                                 builder_end = builder_map->end();
+                                 builder != builder_end; ++builder) {
+    tasks.push_back(TableBuildTask(builder->second, arena_));
+  }
+  Executor::TaskList required_tasks;
+  Executor::TaskList other_tasks;
+  size_t index = 0;
+  for (TableBuilderMap::iterator builder = builder_map->begin(),
+                                 builder_end = builder_map->end();
+                                 builder != builder_end; ++builder, ++index) {
+    if (required_tags.count(builder->first)) {
+      required_tasks.push_back(&tasks[index]);
+    } else {
+      other_tasks.push_back(&tasks[index]);
+    }
+  }
+  executor->RunTasks(&required_tasks);
+  executor->RunTasks(&other_tasks);
+
+  index = 0;
+  for (TableBuilderMap::iterator builder = builder_map->begin(),
+                                 builder_end = builder_map->end();
+                                 builder != builder_end; ++builder, ++index) {
+    TablePtr& table = tasks[index].table();
+    if (table == NULL) {
+      table_map->clear();
+#if !defined (SFNTLY_NO_EXCEPTION)
+      std::string builder_string = "Unable to build table - ";
+      char* table_name = TagToString(builder->first);
+      builder_string += table_name;
+      delete[] table_name;
+      throw RuntimeException(builder_string.c_str());
+#endif
+      return false;
     }
-    table_map->insert(TableMapEntry(table->header()->tag(), table));
+    int32_t tag = table->header()->tag();
+    (*table_map)[tag].swap(table);
   }
+  return true;
 }
 
 static Table::Builder* GetBuilder(TableBuilderMap* builder_map, int32_t tag) {
@@ -413,7 +1166,7 @@ void Font::Builder::InterRelateBuilders(TableBuilderMap* builder_map) {
 
   Table::Builder* raw_hhea_builder = GetBuilder(builder_map, Tag::hhea);
   HorizontalHeaderTableBuilderPtr horizontal_header_builder;
-  if (raw_head_builder != NULL) {
+  if (raw_hhea_builder != NULL) {
       horizontal_header_builder =
           down_cast<HorizontalHeaderTable::Builder*>(raw_hhea_builder);
   }
@@ -507,18 +1260,33 @@ void Font::Builder::ReadHeader(ReadableFontData* fd,
   search_range_ = fd->ReadUShort(offset + Offset::kSearchRange);
   entry_selector_ = fd->ReadUShort(offset + Offset::kEntrySelector);
   range_shift_ = fd->ReadUShort(offset + Offset::kRangeShift);
+  ReadTableRecords(fd, offset, num_tables_, records);
+}
 
-  int32_t table_offset = offset + Offset::kTableRecordBegin;
-  for (int32_t table_number = 0;
-       table_number < num_tables_;
-       table_number++, table_offset += Offset::kTableRecordSize) {
-    int32_t tag = fd->ReadULongAsInt(table_offset + Offset::kTableTag);
-    int64_t checksum = fd->ReadULong(table_offset + Offset::kTableCheckSum);
-    int32_t offset = fd->ReadULongAsInt(table_offset + Offset::kTableOffset);
-    int32_t length = fd->ReadULongAsInt(table_offset + Offset::kTableLength);
-    HeaderPtr table = new Header(tag, checksum, offset, length);
-    records->insert(table);
+void Font::Builder::ReadHeader(RandomAccessFileInputStream* is,
+                               int32_t offset,
+                               HeaderOffsetSortedSet* records) {
+  assert(records);
+  // One read for the offset table and one for the table records.
+  ByteVector directory(Offset::kTableRecordBegin);
+  if (is->ReadAt(offset, &(directory[0]), Offset::kTableRecordBegin) ==
+      Offset::kTableRecordBegin) {
+    int32_t num_tables = (directory[Offset::kNumTables] << 8) |
+                         directory[Offset::kNumTables + 1];
+    directory.resize(Offset::kTableRecordBegin +
+                     num_tables * Offset::kTableRecordSize);
+    int32_t records_length = directory.size() - Offset::kTableRecordBegin;
+    if (records_length > 0) {
+      directory.resize(Offset::kTableRecordBegin +
+          is->ReadAt(offset + Offset::kTableRecordBegin,
+                     &(directory[Offset::kTableRecordBegin]),
+                     records_length));
+    }
   }
+  ByteArrayPtr ba = new MemoryByteArray(&(directory[0]),
+                                        (int32_t)directory.size());
+  ReadableFontDataPtr fd = new ReadableFontData(ba);
+  ReadHeader(fd, 0, records);
 }
 
 void Font::Builder::LoadTableData(HeaderOffsetSortedSet* headers,
@@ -554,4 +1322,43 @@ void Font::Builder::LoadTableData(HeaderOffsetSortedSet* headers,
   }
 }
 
+void Font::Builder::LoadTableData(HeaderOffsetSortedSet* headers,
+                                  RandomAccessFileInputStream* is,
+                                  DataBlockMap* table_data) {
+  assert(table_data);
+  // Read each run of neighbouring tables with a single ReadAt and hand out
+  // slices of it, as when loading from memory. The headers are sorted by
+  // descending offset.
+  HeaderOffsetSortedSet::reverse_iterator run_begin = headers->rbegin();
+  while (run_begin != headers->rend()) {
+    int64_t start = (*run_begin)->offset();
+    int64_t end = start + (*run_begin)->length();
+    HeaderOffsetSortedSet::reverse_iterator run_end = run_begin;
+    for (++run_end;
+         run_end != headers->rend() &&
+         (*run_end)->offset() <= end + kTableReadGap;
+         ++run_end) {
+      end = std::max<int64_t>(end, (int64_t)(*run_end)->offset() +
+                                   (*run_end)->length());
+    }
+    end = std::min<int64_t>(end, is->Length());
+    if (start < 0 || end <= start || end - start > INT_MAX) {
+      run_begin = run_end;
+      continue;
+    }
+    ByteArrayPtr ba = new MemoryByteArray((int32_t)(end - start));
+    ba->SetFilledLength(
+        is->ReadAt(start, ba->Begin(), (int32_t)(end - start)));
+    WritableFontDataPtr run = new WritableFontData(ba);
+    for (; run_begin != run_end; ++run_begin) {
+      FontDataPtr sliced_data;
+      sliced_data.Attach(
+          run->Slice((*run_begin)->offset() - (int32_t)start,
+                     (*run_begin)->length()));
+      WritableFontDataPtr data = down_cast<WritableFontData*>(sliced_data.p_);
+      table_data->insert(DataBlockEntry(*run_begin, data));
+    }
+  }
+}
+
 }  // namespace sfntly
@@ -17,13 +17,20 @@
 #ifndef SFNTLY_CPP_SRC_SFNTLY_FONT_H_
 #define SFNTLY_CPP_SRC_SFNTLY_FONT_H_
 
+#include <map>
 #include <vector>
 
+#include "sfntly/port/arena.h"
+#include "sfntly/port/lock.h"
 #include "sfntly/port/refcount.h"
 #include "sfntly/port/type.h"
 #include "sfntly/port/endian.h"
+#include "sfntly/port/random_access_file_input_stream.h"
+#include "sfntly/port/executor.h"
+#include "sfntly/port/flat_map.h"
 #include "sfntly/data/font_input_stream.h"
 #include "sfntly/data/font_output_stream.h"
+#include "sfntly/data/gather_output.h"
 #include "sfntly/data/writable_font_data.h"
 #include "sfntly/table/table.h"
 
@@ -138,6 +145,14 @@ class Font : public RefCounted<Font> {
                       WritableFontData* ba,
                       int32_t offset_to_offset_table);
     static CALLER_ATTACH Builder* GetOTFBuilder(FontFactory* factory);
+    // Loads the font with a few large positional reads of the file and leaves
+    // the stream position alone, so several fonts may be loaded from one open
+    // file at once.
+    // Note: C++ port only, there is no Java equivalent.
+    static CALLER_ATTACH Builder*
+        GetOTFBuilder(FontFactory* factory,
+                      RandomAccessFileInputStream* is,
+                      int32_t offset_to_offset_table);
 
     // Get the font factory that created this font builder.
     FontFactory* GetFontFactory() { return factory_; }
@@ -159,6 +174,8 @@ class Font : public RefCounted<Font> {
 
     // Get the table builder for the given tag. If there is no builder for that
     // tag then return a null.
+    // Note: the builders of tables loaded from font data are only made on
+    // first access, together with the builders of the tables they need.
     Table::Builder* GetTableBuilder(int32_t tag);
 
     // Creates a new table builder for the table type given by the table id tag.
@@ -169,15 +186,16 @@ class Font : public RefCounted<Font> {
     virtual Table::Builder* NewTableBuilder(int32_t tag);
 
     // Creates a new table builder for the table type given by the table id tag.
-    // It makes a copy of the data provided and uses that copy for the table.
+    // It shares the data provided and only copies it for the table if the
+    // builder modifies it, so the data must not be changed by anyone else.
     // This new table has been added to the font and will replace any existing
     // builder for that table.
     virtual Table::Builder* NewTableBuilder(int32_t tag,
                                             ReadableFontData* src_data);
 
     // Get a map of the table builders in this font builder accessed by table
-    // tag.
-    virtual TableBuilderMap* table_builders() { return &table_builders_; }
+    // tag. Makes the builders of all tables loaded.
+    virtual TableBuilderMap* table_builders();
 
     // Remove the specified table builder from the font builder.
     // Note: different from Java: we don't return object in removeTableBuilder
@@ -185,22 +203,47 @@ class Font : public RefCounted<Font> {
 
     // Get the number of table builders in the font builder.
     virtual int32_t number_of_table_builders() {
-      return (int32_t)table_builders_.size();
+      return (int32_t)(table_builders_.size() + unbuilt_tables_.size());
     }
 
+    // Get the records of the tables that were not loaded because of the font
+    // factory's table filter, sorted by tag.
+    // Note: C++ port only, there is no Java equivalent.
+    const HeaderTagSortedSet* unloaded_tables() { return &unloaded_tables_; }
+
    private:
     explicit Builder(FontFactory* factory);
     virtual void LoadFont(InputStream* is);
     virtual void LoadFont(WritableFontData* wfd,
                           int32_t offset_to_offset_table);
+    virtual void LoadFont(RandomAccessFileInputStream* is,
+                          int32_t offset_to_offset_table);
     int32_t SfntWrapperSize();
-    void BuildAllTableBuilders(DataBlockMap* table_data,
-                               TableBuilderMap* builder_map);
+
+    // Keep the loaded table data for building table builders on demand.
+    void DeferTableBuilders(DataBlockMap* table_data);
+
+    // Make the builder for a loaded table and relate it to the builders of
+    // the tables it needs; NULL if there is no such table.
+    Table::Builder* BuildTableBuilder(int32_t tag);
+
+    // Make the builders of all loaded tables.
+    void BuildAllTableBuilders();
+
     CALLER_ATTACH Table::Builder*
         GetTableBuilder(Header* header, WritableFontData* data);
-    void BuildTablesFromBuilders(Font* font,
+    // Build the tables of the builders into tables.
+    // @return false if a table could not be built; tables is then empty
+    bool BuildTablesFromBuilders(Font* font,
                                  TableBuilderMap* builder_map,
                                  TableMap* tables);
+
+    // Build the tables on the executor: the tables other tables depend on
+    // first, then all the others, each batch concurrently.
+    // @return false if a table could not be built; table_map is then empty
+    bool BuildTablesConcurrently(Executor* executor,
+                                 TableBuilderMap* builder_map,
+                                 TableMap* table_map);
     static void InterRelateBuilders(TableBuilderMap* builder_map);
 
     void ReadHeader(FontInputStream* is,
@@ -210,6 +253,10 @@ class Font : public RefCounted<Font> {
                     int32_t offset,
                     HeaderOffsetSortedSet* records);
 
+    void ReadHeader(RandomAccessFileInputStream* is,
+                    int32_t offset,
+                    HeaderOffsetSortedSet* records);
+
     void LoadTableData(HeaderOffsetSortedSet* headers,
                        FontInputStream* is,
                        DataBlockMap* table_data);
@@ -218,6 +265,14 @@ class Font : public RefCounted<Font> {
                        WritableFontData* fd,
                        DataBlockMap* table_data);
 
+    void LoadTableData(HeaderOffsetSortedSet* headers,
+                       RandomAccessFileInputStream* is,
+                       DataBlockMap* table_data);
+
+    // The arena current when the builder was created, if any. The builder
+    // keeps placing the tables it builds there.
+    ArenaPtr arena_;
+
     TableBuilderMap table_builders_;
     FontFactory* factory_;  // dumb pointer, avoid circular refcounting
     int32_t sfnt_version_;
@@ -226,11 +281,74 @@ class Font : public RefCounted<Font> {
     int32_t entry_selector_;
     int32_t range_shift_;
     DataBlockMap data_blocks_;
+    TableDataBlockMap unbuilt_tables_;
+    HeaderTagSortedSet unloaded_tables_;
     ByteVector digest_;
+
+    friend class Font;
+  };
+
+  // The tables shared by the read-only fonts of a font collection. Tables
+  // whose data is at the same place in the collection are read once and
+  // referenced by all the fonts; tables which are built with values from
+  // other tables (hmtx, loca and hdmx) only if those tables are shared too.
+  // Thread safe.
+  // Note: C++ port only, there is no Java equivalent.
+  class TableCache : public RefCounted<TableCache> {
+   public:
+    TableCache();
+    virtual ~TableCache();
+
+    // Get the number of distinct tables made so far.
+    size_t num_tables();
+
+   private:
+    // Replace the record and data of a table with those of a table at the
+    // same place loaded before, or keep them for the tables loaded after.
+    void ShareDataBlock(DataBlockEntry* block);
+
+    // Get the table kept for the key; NULL if there is none.
+    Table* FindTable(const IntegerList& key);
+
+    // Get the table kept for the key, keeping table for it if there is none.
+    Table* ShareTable(const IntegerList& key, Table* table);
+
+    Lock lock_;
+    std::map<IntegerList, DataBlockEntry> data_blocks_;
+    std::map<IntegerList, TablePtr> tables_;
+
+    friend class Font;
   };
+  typedef Ptr<TableCache> TableCachePtr;
 
   virtual ~Font();
 
+  // Get a read-only font straight from the data of a font file, without going
+  // through a builder. Only the table directory is read; each table is made
+  // from a slice of the data the first time it is accessed, without copying.
+  // The table filter of the factory is applied as when loading for building.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param factory the factory whose settings are used; may be NULL
+  // @param wfd the data of the font file
+  // @param offset_to_offset_table the offset of the font in the data
+  // @return the font
+  static CALLER_ATTACH Font* GetOTFFont(FontFactory* factory,
+                                        WritableFontData* wfd,
+                                        int32_t offset_to_offset_table);
+
+  // Get a read-only font for a member of a font collection, sharing the
+  // tables it has in common with the other fonts got with the same cache.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param factory the factory whose settings are used; may be NULL
+  // @param wfd the data of the font collection file
+  // @param offset_to_offset_table the offset of the font in the data
+  // @param table_cache the tables shared by the fonts of the collection
+  // @return the font
+  static CALLER_ATTACH Font* GetOTFFont(FontFactory* factory,
+                                        WritableFontData* wfd,
+                                        int32_t offset_to_offset_table,
+                                        TableCache* table_cache);
+
   // Gets the sfnt version set in the sfnt wrapper of the font.
   int32_t sfnt_version() { return sfnt_version_; }
 
@@ -242,7 +360,7 @@ class Font : public RefCounted<Font> {
   int64_t checksum() { return checksum_; }
 
   // Get the number of tables in this font.
-  int32_t num_tables() { return (int32_t)tables_.size(); }
+  int32_t num_tables();
 
   // Whether the font has a particular table.
   bool HasTable(int32_t tag);
@@ -250,16 +368,38 @@ class Font : public RefCounted<Font> {
   // UNIMPLEMENTED: public Iterator<? extends Table> iterator
 
   // Get the table in this font with the specified id.
+  // Note: tables whose builders were never accessed are only built on first
+  // access. Thread safe; only building a table takes a lock.
   // @param tag the identifier of the table
   // @return the table specified if it exists; null otherwise
   // C++ port: rename table() to GetTable()
   Table* GetTable(int32_t tag);
 
-  // Get a map of the tables in this font accessed by table tag.
+  // Get a map of the tables in this font accessed by table tag. Builds all
+  // tables not built yet.
   // @return an unmodifiable view of the tables in this font
   // Note: renamed tableMap() to GetTableMap()
   const TableMap* GetTableMap();
 
+  // Get the records of the tables in the font file that were not loaded
+  // because of the font factory's table filter, sorted by tag. Their offset
+  // and length locate the table data in the file. These tables are not part
+  // of the font and are not serialized with it.
+  // Note: C++ port only, there is no Java equivalent.
+  const HeaderTagSortedSet* unloaded_tables() { return &unloaded_tables_; }
+
+  // Load a table that was not loaded because of the font factory's table
+  // filter from the data the font was loaded from. The table is not added to
+  // the font. The tables it depends on are taken from the font, or loaded
+  // along with it if they were not loaded either. Thread safe.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param tag the identifier of the table
+  // @param source the data of the whole font file the font was loaded from
+  // @return the table; NULL if the tag is not in unloaded_tables() or the
+  //         table lies beyond the end of the source
+  CALLER_ATTACH Table* LoadUnloadedTable(int32_t tag,
+                                         ReadableFontData* source);
+
   // UNIMPLEMENTED: toString()
 
   // Serialize the font to the output stream.
@@ -267,6 +407,55 @@ class Font : public RefCounted<Font> {
   // @param tableOrdering the table ordering to apply
   void Serialize(OutputStream* os, IntegerList* table_ordering);
 
+  // Serialize the font into scatter-gather segments. The tables are referenced
+  // rather than copied wherever their data is contiguous in memory.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param output the destination for the font serialization
+  // @param table_ordering the table ordering to apply
+  void Serialize(GatherOutput* output, IntegerList* table_ordering);
+
+  // Get the exact number of bytes the serialized font takes.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param table_ordering the table ordering to apply
+  // @return the size of the serialized font in bytes
+  size_t SerializedSize(const IntegerList& table_ordering);
+
+  // Serialize the font straight into a buffer provided by the caller.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param dst the destination for the font serialization
+  // @param capacity the size of the destination in bytes; at least
+  //        SerializedSize()
+  // @param table_ordering the table ordering to apply
+  // @return the number of bytes written; 0 if the destination is too small
+  size_t SerializeTo(byte_t* dst,
+                     size_t capacity,
+                     const IntegerList& table_ordering);
+
+  // Serialize the font as the methods above do, computing the checksums of
+  // the tables concurrently on an executor. The checksum of the whole font
+  // is summed from the table checksums and the table directory, and written
+  // to head.checkSumAdjustment, without reading the output again. Without
+  // checksums the table records get a zero checksum and the head table is
+  // written unchanged, which saves reading every table for output whose
+  // validity is checked elsewhere.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param executor the executor to compute the checksums on; NULL to
+  //        compute them on the calling thread
+  // @param checksums whether to compute the checksums
+  void Serialize(OutputStream* os,
+                 IntegerList* table_ordering,
+                 Executor* executor,
+                 bool checksums);
+  void Serialize(GatherOutput* output,
+                 IntegerList* table_ordering,
+                 Executor* executor,
+                 bool checksums);
+  size_t SerializeTo(byte_t* dst,
+                     size_t capacity,
+                     const IntegerList& table_ordering,
+                     Executor* executor,
+                     bool checksums);
+
  private:
   // Offsets to specific elements in the underlying data. These offsets are
   // relative to the start of the table or the start of sub-blocks within the
@@ -308,10 +497,26 @@ class Font : public RefCounted<Font> {
   // generated.
   // @param tableOrdering the tables to generate headers for and the order to
   //        sort them
+  // @param executor the executor to compute the table checksums on; may be
+  //        NULL
+  // @param checksums whether to compute the table checksums
   // @return a list of table headers ready for serialization
   void BuildTableHeadersForSerialization(IntegerList* table_ordering,
+                                         Executor* executor,
+                                         bool checksums,
                                          TableHeaderList* table_headers);
 
+  // Get the value of head.checkSumAdjustment for the font: 0xB1B0AFBA minus
+  // the sum of the sfnt header and table directory and of the checksums of
+  // the tables, which are 4-byte aligned and padded with zeros. The head
+  // table checksum leaves checkSumAdjustment out.
+  // @param header the serialized sfnt header and table directory
+  // @param header_size the size of the header in bytes, a multiple of 4
+  // @param table_headers the headers of the tables
+  static int64_t ChecksumAdjustment(const byte_t* header,
+                                    size_t header_size,
+                                    TableHeaderList* table_headers);
+
   // Searialize the headers.
   // @param fos the destination stream for the headers
   // @param tableHeaders the headers to serialize
@@ -321,8 +526,21 @@ class Font : public RefCounted<Font> {
   // Serialize the tables.
   // @param fos the destination stream for the headers
   // @param tableHeaders the headers for the tables to serialize
+  // @param checksum_adjustment the head.checkSumAdjustment to write; -1 to
+  //        write the head table unchanged
   // @throws IOException
-  void SerializeTables(FontOutputStream* fos, TableHeaderList* table_headers);
+  void SerializeTables(FontOutputStream* fos,
+                       TableHeaderList* table_headers,
+                       int64_t checksum_adjustment);
+
+  // Serialize the tables into scatter-gather segments.
+  // @param output the destination for the tables
+  // @param table_headers the headers for the tables to serialize
+  // @param checksum_adjustment the head.checkSumAdjustment to write; -1 to
+  //        write the head table unchanged
+  void SerializeTables(GatherOutput* output,
+                       TableHeaderList* table_headers,
+                       int64_t checksum_adjustment);
 
   // Generate the full table ordering to used for serialization. The full
   // ordering uses the partial ordering as a seed and then adds all remaining
@@ -337,10 +555,73 @@ class Font : public RefCounted<Font> {
   // @param (out) default_table_ordering the default table ordering
   void DefaultTableOrdering(IntegerList* default_table_ordering);
 
+  // Get the tables a table needs the builders of to be built, as set up by
+  // Builder::InterRelateBuilders().
+  static void TableDependencies(int32_t tag, IntegerList* dependencies);
+
+  // Read the table records of the font directory at offset into records.
+  static void ReadTableRecords(ReadableFontData* fd,
+                               int32_t offset,
+                               int32_t num_tables,
+                               HeaderOffsetSortedSet* records);
+
+  // Move the records of the tables a font factory's table filter leaves out
+  // from records to unloaded_tables. Nothing is moved if filter is NULL.
+  static void FilterTables(const IntegerSet* filter,
+                           HeaderOffsetSortedSet* records,
+                           HeaderTagSortedSet* unloaded_tables);
+
+  // Make a slot for each table of the font, built or not. Called once the
+  // tables are in place, before the font is handed out.
+  void IndexTables();
+
+  // Build a table not built yet; NULL if there is no such table. The lock
+  // must be held.
+  Table* BuildTable(int32_t tag);
+
+  // Publish the outcome of building a table to the readers of its slot; table
+  // is NULL if building failed. The lock must be held.
+  void PublishTable(int32_t tag, Table* table);
+
+  // Build all tables not built yet.
+  void BuildAllTables();
+
+  // Get the key a not yet built table is shared by in table_cache_: its tag,
+  // offset and length followed by the offset and length of each table it
+  // depends on. The lock must be held.
+  void TableCacheKey(int32_t tag, IntegerList* key);
+
+  // The arena the objects of the font are in, if any.
+  ArenaPtr arena_;
+
   int32_t sfnt_version_;
   ByteVector digest_;
   int64_t checksum_;
   TableMap tables_;
+  HeaderTagSortedSet unloaded_tables_;
+
+  // Guards building the tables in unbuilt_tables_ into tables_.
+  Lock lock_;
+  TableDataBlockMap unbuilt_tables_;
+
+  // A table of the font as seen by readers that do not take lock_. Once built
+  // is published with a release store, table never changes: the table, or
+  // NULL if building it failed.
+  struct TableSlot {
+    TableSlot() : built(0), table(NULL) {}
+    int32_t built;
+    Table* table;
+  };
+  typedef FlatMap<int32_t, TableSlot> TableSlotMap;
+  // One slot per table, filled in by IndexTables() and never resized after,
+  // so the slots stay put while tables are built.
+  TableSlotMap table_slots_;
+  // Whether BuildAllTables() has finished, published the same way.
+  int32_t all_tables_built_;
+  TableCachePtr table_cache_;
+
+  // The factory sets the digest of the fonts it loads.
+  friend class FontFactory;
 };
 typedef Ptr<Font> FontPtr;
 typedef std::vector<FontPtr> FontArray;
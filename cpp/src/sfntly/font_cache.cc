@@ -0,0 +1,100 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/font_cache.h"
+
+namespace sfntly {
+
+FontCache::FontCache(size_t budget) : budget_(budget), size_(0) {
+}
+
+FontCache::~FontCache() {
+}
+
+bool FontCache::Get(const ByteVector& key, FontArray* output) {
+  assert(output);
+  AutoLock lock(lock_);
+  EntryMap::iterator entry = entries_.find(key);
+  if (entry == entries_.end()) {
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, entry->second.lru_position);
+  output->insert(output->end(),
+                 entry->second.fonts.begin(),
+                 entry->second.fonts.end());
+  return true;
+}
+
+void FontCache::Put(const ByteVector& key,
+                    size_t size,
+                    const FontArray& fonts) {
+  AutoLock lock(lock_);
+  if (size > budget_ || entries_.find(key) != entries_.end()) {
+    return;
+  }
+  lru_.push_front(key);
+  Entry& entry = entries_[key];
+  entry.fonts = fonts;
+  entry.size = size;
+  entry.lru_position = lru_.begin();
+  size_ += size;
+  Evict();
+}
+
+void FontCache::SetBudget(size_t budget) {
+  AutoLock lock(lock_);
+  budget_ = budget;
+  Evict();
+}
+
+void FontCache::Clear() {
+  // The fonts are released after the lock is, their destruction may take a
+  // while.
+  EntryMap entries;
+  {
+    AutoLock lock(lock_);
+    entries.swap(entries_);
+    lru_.clear();
+    size_ = 0;
+  }
+}
+
+size_t FontCache::budget() {
+  AutoLock lock(lock_);
+  return budget_;
+}
+
+size_t FontCache::size() {
+  AutoLock lock(lock_);
+  return size_;
+}
+
+size_t FontCache::num_entries() {
+  AutoLock lock(lock_);
+  return entries_.size();
+}
+
+void FontCache::Evict() {
+  while (size_ > budget_ && !lru_.empty()) {
+    EntryMap::iterator entry = entries_.find(lru_.back());
+    assert(entry != entries_.end());
+    size_ -= entry->second.size;
+    entries_.erase(entry);
+    lru_.pop_back();
+  }
+}
+
+}  // namespace sfntly
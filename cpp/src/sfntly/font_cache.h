@@ -0,0 +1,108 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_FONT_CACHE_H_
+#define SFNTLY_CPP_SRC_SFNTLY_FONT_CACHE_H_
+
+#include <list>
+#include <map>
+
+#include "sfntly/font.h"
+#include "sfntly/port/lock.h"
+#include "sfntly/port/refcount.h"
+#include "sfntly/port/type.h"
+
+// The fonts cached are shared by every thread loading them, which plain
+// reference counts do not allow; see sfntly/port/refcount.h.
+#if defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+#error "FontCache needs atomic reference counts"
+#endif
+
+namespace sfntly {
+
+// A cache of parsed fonts keyed by a fingerprint of the data they were loaded
+// from, so that loading the same font file again returns the fonts already
+// parsed instead of parsing it once more. The fonts are shared by everyone
+// loading them and must not be modified; changes are made through builders
+// as usual. The cache holds on to fonts until the total size of the data
+// they were loaded from exceeds its budget, then the least recently used ones
+// are dropped. All methods may be called from several threads at once.
+// See FontFactory::SetFontCache().
+// Note: C++ port only, there is no Java equivalent.
+class FontCache : public RefCounted<FontCache, AtomicRefCountPolicy> {
+ public:
+  // Constructor.
+  // @param budget the maximum total size in bytes of the font data cached
+  explicit FontCache(size_t budget);
+  virtual ~FontCache();
+
+  // Append the fonts cached under the key to output, marking them as the most
+  // recently used.
+  // @param key the key of the fonts
+  // @param output the destination
+  // @return true if the fonts were found
+  bool Get(const ByteVector& key, FontArray* output);
+
+  // Cache the fonts loaded from data of the given size under the key, dropping
+  // the least recently used fonts to stay within the budget. Nothing is cached
+  // if the data alone exceeds the budget, or if the key is already cached.
+  // @param key the key of the fonts
+  // @param size the size in bytes of the data the fonts were loaded from
+  // @param fonts the fonts
+  void Put(const ByteVector& key, size_t size, const FontArray& fonts);
+
+  // Set the maximum total size in bytes of the font data cached, dropping the
+  // least recently used fonts if it is now exceeded.
+  void SetBudget(size_t budget);
+
+  // Drop all cached fonts.
+  void Clear();
+
+  size_t budget();
+
+  // Get the total size in bytes of the font data cached.
+  size_t size();
+
+  // Get the number of fonts and font collections cached.
+  size_t num_entries();
+
+ private:
+  typedef std::list<ByteVector> KeyList;
+
+  struct Entry {
+    FontArray fonts;
+    size_t size;
+    // The position of the key in lru_.
+    KeyList::iterator lru_position;
+  };
+  typedef std::map<ByteVector, Entry> EntryMap;
+
+  // Drop the least recently used entries until the budget is met. The lock
+  // must be held.
+  void Evict();
+
+  Lock lock_;
+  size_t budget_;
+  size_t size_;
+  // The keys of the entries, the most recently used first.
+  KeyList lru_;
+  EntryMap entries_;
+};
+typedef Ptr<FontCache> FontCachePtr;
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_FONT_CACHE_H_
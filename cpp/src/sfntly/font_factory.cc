@@ -16,12 +16,68 @@
 
 #include "sfntly/font_factory.h"
 
+#include <limits.h>
 #include <string.h>
 
+#include "sfntly/data/external_byte_array.h"
+#include "sfntly/data/mapped_byte_array.h"
+#include "sfntly/data/memory_byte_array.h"
+#include "sfntly/port/exception_type.h"
+#include "sfntly/port/fingerprint.h"
 #include "sfntly/tag.h"
 
 namespace sfntly {
 
+class FontFactory::CollectionMemberLoad : public Executor::Task {
+ public:
+  CollectionMemberLoad(FontFactory* factory,
+                       WritableFontData* wfd,
+                       int32_t offset_to_offset_table,
+                       Font::TableCache* table_cache,
+                       Arena* arena)
+      : factory_(factory),
+        wfd_(wfd),
+        offset_to_offset_table_(offset_to_offset_table),
+        table_cache_(table_cache),
+        arena_(arena),
+        failed_(false) {
+  }
+
+  virtual void Run() {
+    ArenaScope scope(arena_);
+#if !defined (SFNTLY_NO_EXCEPTION)
+    // Failures are reported on the thread that asked for the load.
+    try {
+#endif
+      if (table_cache_ != NULL) {
+        font_.Attach(Font::GetOTFFont(factory_, wfd_, offset_to_offset_table_,
+                                      table_cache_));
+      } else {
+        builder_.Attach(factory_->LoadSingleOTFForBuilding(
+            wfd_, offset_to_offset_table_));
+      }
+#if !defined (SFNTLY_NO_EXCEPTION)
+    } catch (...) {
+      failed_ = true;
+    }
+#endif
+  }
+
+  Font* font() { return font_; }
+  Font::Builder* builder() { return builder_; }
+  bool failed() { return failed_; }
+
+ private:
+  FontFactory* factory_;
+  WritableFontDataPtr wfd_;
+  int32_t offset_to_offset_table_;
+  Font::TableCachePtr table_cache_;
+  ArenaPtr arena_;
+  FontPtr font_;
+  FontBuilderPtr builder_;
+  bool failed_;
+};
+
 FontFactory::~FontFactory() {
 }
 
@@ -38,8 +94,63 @@ bool FontFactory::FingerprintFont() {
   return fingerprint_;
 }
 
+void FontFactory::ComputeChecksums(bool checksums) {
+  checksums_ = checksums;
+}
+
+bool FontFactory::ComputeChecksums() {
+  return checksums_;
+}
+
+void FontFactory::UseArena(bool use_arena) {
+  use_arena_ = use_arena;
+}
+
+bool FontFactory::UseArena() {
+  return use_arena_;
+}
+
+void FontFactory::SetTableFilter(const IntegerSet& tags) {
+  filter_tables_ = true;
+  table_filter_ = tags;
+}
+
+void FontFactory::ClearTableFilter() {
+  filter_tables_ = false;
+  table_filter_.clear();
+}
+
+const IntegerSet* FontFactory::table_filter() {
+  return filter_tables_ ? &table_filter_ : NULL;
+}
+
+void FontFactory::SetExecutor(Executor* executor) {
+#if defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+  // Tasks on other threads would update plain reference counts.
+  assert(executor == NULL || executor->num_threads() == 0);
+#endif
+  executor_ = executor;
+#if !defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+  thread_pool_ = NULL;
+#endif
+}
+
+#if !defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+void FontFactory::SetThreadPool(ThreadPool* pool) {
+  SetExecutor(pool);
+  thread_pool_ = pool;
+}
+
+void FontFactory::SetFontCache(FontCache* cache) {
+  font_cache_ = cache;
+}
+#endif
+
 void FontFactory::LoadFonts(InputStream* is, FontArray* output) {
   assert(output);
+  ArenaPtr arena;
+  arena.Attach(NewArena());
+  ArenaScope scope(arena);
   PushbackInputStream* pbis = down_cast<PushbackInputStream*>(is);
   if (IsCollection(pbis)) {
     LoadCollection(pbis, output);
@@ -55,19 +166,56 @@ void FontFactory::LoadFonts(InputStream* is, FontArray* output) {
 void FontFactory::LoadFonts(ByteVector* b, FontArray* output) {
   WritableFontDataPtr wfd;
   wfd.Attach(WritableFontData::CreateWritableFontData(b));
-  if (IsCollection(wfd)) {
-    LoadCollection(wfd, output);
+  LoadFonts(wfd, false, output);
+}
+
+void FontFactory::LoadFonts(const char* file_path, FontArray* output) {
+  assert(file_path);
+  assert(output);
+  ByteArrayPtr ba;
+  ba.Attach(MappedByteArray::CreateMappedByteArray(file_path));
+  if (ba == NULL) {
     return;
   }
-  FontPtr font;
-  font.Attach(LoadSingleOTF(wfd));
-  if (font) {
-    output->push_back(font);
+  WritableFontDataPtr wfd = new WritableFontData(ba);
+  LoadFonts(wfd, false, output);
+}
+
+void FontFactory::LoadFonts(const byte_t* b,
+                            size_t length,
+                            FontArray* output) {
+  assert(b);
+  assert(output);
+  if (length == 0 || length > INT_MAX) {
+    return;
+  }
+  ByteArrayPtr ba = new ExternalByteArray(b, static_cast<int32_t>(length));
+  WritableFontDataPtr wfd = new WritableFontData(ba);
+  LoadFonts(wfd, true, output);
+}
+
+void FontFactory::LoadFonts(RandomAccessFileInputStream* is,
+                            FontArray* output) {
+  assert(output);
+  FontBuilderArray builders;
+  LoadFontsForBuilding(is, &builders);
+  output->reserve(output->size() + builders.size());
+  for (FontBuilderArray::iterator builder = builders.begin(),
+                                  builders_end = builders.end();
+                                  builder != builders_end; ++builder) {
+    FontPtr font;
+    font.Attach((*builder)->Build());
+    if (font) {
+      output->push_back(font);
+    }
   }
 }
 
 void FontFactory::LoadFontsForBuilding(InputStream* is,
                                        FontBuilderArray* output) {
+  ArenaPtr arena;
+  arena.Attach(NewArena());
+  ArenaScope scope(arena);
   PushbackInputStream* pbis = down_cast<PushbackInputStream*>(is);
   if (IsCollection(pbis)) {
     LoadCollectionForBuilding(pbis, output);
@@ -84,19 +232,79 @@ void FontFactory::LoadFontsForBuilding(ByteVector* b,
                                        FontBuilderArray* output) {
   WritableFontDataPtr wfd;
   wfd.Attach(WritableFontData::CreateWritableFontData(b));
-  if (IsCollection(wfd)) {
+  LoadFontsForBuilding(wfd, output);
+}
+
+void FontFactory::LoadFontsForBuilding(const char* file_path,
+                                       FontBuilderArray* output) {
+  assert(file_path);
+  assert(output);
+  ByteArrayPtr ba;
+  ba.Attach(MappedByteArray::CreateMappedByteArray(file_path));
+  if (ba == NULL) {
+    return;
+  }
+  WritableFontDataPtr wfd = new WritableFontData(ba);
+  LoadFontsForBuilding(wfd, output);
+}
+
+void FontFactory::LoadFontsForBuilding(const byte_t* b,
+                                       size_t length,
+                                       FontBuilderArray* output) {
+  assert(b);
+  assert(output);
+  if (length == 0 || length > INT_MAX) {
+    return;
+  }
+  ByteArrayPtr ba = new ExternalByteArray(b, static_cast<int32_t>(length));
+  WritableFontDataPtr wfd = new WritableFontData(ba);
+  LoadFontsForBuilding(wfd, output);
+}
+
+void FontFactory::LoadFontsForBuilding(RandomAccessFileInputStream* is,
+                                       FontBuilderArray* output) {
+  assert(is);
+  assert(output);
+  ArenaPtr arena;
+  arena.Attach(NewArena());
+  ArenaScope scope(arena);
+  if (IsCollection(is)) {
+    // The fonts of a collection share tables, so read the whole file once and
+    // let them slice it.
+    if (is->Length() > INT_MAX) {
+      return;
+    }
+    int32_t length = (int32_t)is->Length();
+    ByteArrayPtr ba = new MemoryByteArray(length);
+    ba->SetFilledLength(is->ReadAt(0, ba->Begin(), length));
+    WritableFontDataPtr wfd = new WritableFontData(ba);
     LoadCollectionForBuilding(wfd, output);
     return;
   }
   FontBuilderPtr builder;
-  builder.Attach(LoadSingleOTFForBuilding(wfd, 0));
+  builder.Attach(Font::Builder::GetOTFBuilder(this, is, 0));
   if (builder) {
     output->push_back(builder);
   }
 }
 
 void FontFactory::SerializeFont(Font* font, OutputStream* os) {
-  font->Serialize(os, &table_ordering_);
+  font->Serialize(os, &table_ordering_, executor_, checksums_);
+}
+
+void FontFactory::SerializeFont(Font* font, GatherOutput* output) {
+  font->Serialize(output, &table_ordering_, executor_, checksums_);
+}
+
+size_t FontFactory::SerializedFontSize(Font* font) {
+  return font->SerializedSize(table_ordering_);
+}
+
+size_t FontFactory::SerializeFontTo(Font* font,
+                                    byte_t* dst,
+                                    size_t capacity) {
+  return font->SerializeTo(dst, capacity, table_ordering_, executor_,
+                           checksums_);
 }
 
 void FontFactory::SetSerializationTableOrdering(
@@ -105,19 +313,108 @@ void FontFactory::SetSerializationTableOrdering(
 }
 
 CALLER_ATTACH Font::Builder* FontFactory::NewFontBuilder() {
+  ArenaPtr arena;
+  arena.Attach(NewArena());
+  ArenaScope scope(arena);
   return Font::Builder::GetOTFBuilder(this);
 }
 
+void FontFactory::LoadFonts(WritableFontData* wfd,
+                            bool borrowed,
+                            FontArray* output) {
+  assert(output);
+#if defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+  const bool cached = false;
+#else
+  const bool cached = font_cache_ != NULL;
+#endif
+  ByteVector fingerprint;
+  if (fingerprint_ || cached) {
+    Fingerprint(wfd, &fingerprint);
+  }
+  ByteVector key;
+  WritableFontDataPtr data = wfd;
+#if !defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+  if (cached && !fingerprint.empty()) {
+    FontCacheKey(fingerprint, &key);
+    if (font_cache_->Get(key, output)) {
+      return;
+    }
+    if (borrowed) {
+      // The cached fonts may outlive the buffer.
+      int32_t length = wfd->Length();
+      ByteArrayPtr ba = new MemoryByteArray(length);
+      ba->SetFilledLength(wfd->ReadBytes(0, ba->Begin(), 0, length));
+      data = new WritableFontData(ba);
+    }
+  }
+#endif
+
+  FontArray fonts;
+  LoadFonts(data, &fonts);
+  for (FontArray::iterator font = fonts.begin(), fonts_end = fonts.end();
+                           font != fonts_end; ++font) {
+    (*font)->digest_ = fingerprint;
+  }
+#if !defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+  if (!key.empty() && !fonts.empty()) {
+    font_cache_->Put(key, data->Length(), fonts);
+  }
+#endif
+  output->insert(output->end(), fonts.begin(), fonts.end());
+}
+
+void FontFactory::LoadFonts(WritableFontData* wfd, FontArray* output) {
+  ArenaPtr arena;
+  arena.Attach(NewArena());
+  ArenaScope scope(arena);
+  if (IsCollection(wfd)) {
+    LoadCollection(wfd, output);
+    return;
+  }
+  FontPtr font;
+  font.Attach(LoadSingleOTF(wfd, 0));
+  if (font) {
+    output->push_back(font);
+  }
+}
+
+void FontFactory::LoadFontsForBuilding(WritableFontData* wfd,
+                                       FontBuilderArray* output) {
+  ArenaPtr arena;
+  arena.Attach(NewArena());
+  ArenaScope scope(arena);
+  size_t first_builder = output->size();
+  if (IsCollection(wfd)) {
+    LoadCollectionForBuilding(wfd, output);
+  } else {
+    FontBuilderPtr builder;
+    builder.Attach(LoadSingleOTFForBuilding(wfd, 0));
+    if (builder) {
+      output->push_back(builder);
+    }
+  }
+  if (fingerprint_) {
+    ByteVector fingerprint;
+    Fingerprint(wfd, &fingerprint);
+    for (size_t i = first_builder; i < output->size(); ++i) {
+      output->at(i)->SetDigest(&fingerprint);
+    }
+  }
+}
+
 CALLER_ATTACH Font* FontFactory::LoadSingleOTF(InputStream* is) {
   FontBuilderPtr builder;
   builder.Attach(LoadSingleOTFForBuilding(is));
   return builder->Build();
 }
 
-CALLER_ATTACH Font* FontFactory::LoadSingleOTF(WritableFontData* wfd) {
-  FontBuilderPtr builder;
-  builder.Attach(LoadSingleOTFForBuilding(wfd, 0));
-  return builder->Build();
+CALLER_ATTACH Font* FontFactory::LoadSingleOTF(
+    WritableFontData* wfd,
+    int32_t offset_to_offset_table) {
+  // The digest is set by LoadFonts(), which has the whole data.
+  // Fonts that are not built on are read straight from the data.
+  return Font::GetOTFFont(this, wfd, offset_to_offset_table);
 }
 
 void FontFactory::LoadCollection(InputStream* is, FontArray* output) {
@@ -133,15 +430,13 @@ void FontFactory::LoadCollection(InputStream* is, FontArray* output) {
 }
 
 void FontFactory::LoadCollection(WritableFontData* wfd, FontArray* output) {
-  FontBuilderArray builders;
-  LoadCollectionForBuilding(wfd, &builders);
-  output->reserve(builders.size());
-  for (FontBuilderArray::iterator builder = builders.begin(),
-                                  builders_end = builders.end();
-                                  builder != builders_end; ++builder) {
-    FontPtr font;
-    font.Attach((*builder)->Build());
-    output->push_back(font);
+  // Tables shared by the member fonts are only read once.
+  Font::TableCachePtr table_cache = new Font::TableCache();
+  std::vector<CollectionMemberLoad> loads;
+  LoadCollectionMembers(wfd, table_cache, &loads);
+  output->reserve(loads.size());
+  for (size_t i = 0; i < loads.size(); ++i) {
+    output->push_back(loads[i].font());
   }
 }
 
@@ -159,7 +454,7 @@ CALLER_ATTACH Font::Builder*
   // UNIMPLEMENTED: SHA-1 hash checking via Java DigestStream
   Font::Builder* builder =
       Font::Builder::GetOTFBuilder(this, wfd, offset_to_offset_table);
-  // UNIMPLEMENTED: setDigest
+  // The digest is set by LoadFontsForBuilding(), which has the whole data.
   return builder;
 }
 
@@ -179,17 +474,47 @@ void FontFactory::LoadCollectionForBuilding(WritableFontData* wfd,
   UNREFERENCED_PARAMETER(ttc_tag);
   int32_t version = wfd->ReadFixed(Offset::kVersion);
   UNREFERENCED_PARAMETER(version);
+  std::vector<CollectionMemberLoad> loads;
+  LoadCollectionMembers(wfd, NULL, &loads);
+  builders->reserve(loads.size());
+  for (size_t i = 0; i < loads.size(); ++i) {
+    builders->push_back(loads[i].builder());
+  }
+}
+
+void FontFactory::LoadCollectionMembers(
+    WritableFontData* wfd,
+    Font::TableCache* table_cache,
+    std::vector<CollectionMemberLoad>* loads) {
+  assert(loads);
   int32_t num_fonts = wfd->ReadULongAsInt(Offset::kNumFonts);
+  if (num_fonts <= 0) {
+    return;
+  }
 
-  builders->reserve(num_fonts);
+  loads->reserve(num_fonts);
   int32_t offset_table_offset = Offset::kOffsetTable;
   for (int32_t font_number = 0;
                font_number < num_fonts;
                font_number++, offset_table_offset += DataSize::kULONG) {
     int32_t offset = wfd->ReadULongAsInt(offset_table_offset);
-    FontBuilderPtr builder;
-    builder.Attach(LoadSingleOTFForBuilding(wfd, offset));
-    builders->push_back(builder);
+    loads->push_back(CollectionMemberLoad(this, wfd, offset, table_cache,
+                                          Arena::Current()));
+  }
+  TaskGroup group(executor_);
+  for (size_t i = 0; i < loads->size(); ++i) {
+    group.Add(&(loads->at(i)));
+  }
+  group.Wait();
+
+  for (size_t i = 0; i < loads->size(); ++i) {
+    if (loads->at(i).failed()) {
+      loads->clear();
+#if !defined (SFNTLY_NO_EXCEPTION)
+      throw RuntimeException("Unable to load font collection member");
+#endif
+      return;
+    }
   }
 }
 
@@ -200,6 +525,14 @@ bool FontFactory::IsCollection(PushbackInputStream* pbis) {
   return Tag::ttcf == GenerateTag(tag[0], tag[1], tag[2], tag[3]);
 }
 
+bool FontFactory::IsCollection(RandomAccessFileInputStream* is) {
+  byte_t tag[4];
+  if (is->ReadAt(0, tag, sizeof(tag)) != sizeof(tag)) {
+    return false;
+  }
+  return Tag::ttcf == GenerateTag(tag[0], tag[1], tag[2], tag[3]);
+}
+
 bool FontFactory::IsCollection(ReadableFontData* rfd) {
   ByteVector tag(4);
   rfd->ReadBytes(0, &(tag[0]), 0, tag.size());
@@ -207,8 +540,57 @@ bool FontFactory::IsCollection(ReadableFontData* rfd) {
          GenerateTag(tag[0], tag[1], tag[2], tag[3]);
 }
 
+// static
+void FontFactory::Fingerprint(ReadableFontData* data,
+                              ByteVector* fingerprint) {
+  assert(fingerprint);
+  fingerprint->clear();
+  if (data->Length() <= 0) {
+    return;
+  }
+  const byte_t* b = data->ContiguousBytes();
+  if (b != NULL) {
+    Fingerprint128(b, data->Length(), fingerprint);
+    return;
+  }
+  ByteVector bytes(data->Length());
+  if (data->ReadBytes(0, &(bytes[0]), 0, bytes.size()) ==
+      static_cast<int32_t>(bytes.size())) {
+    Fingerprint128(&(bytes[0]), bytes.size(), fingerprint);
+  }
+}
+
+void FontFactory::FontCacheKey(const ByteVector& fingerprint,
+                               ByteVector* key) {
+  assert(key);
+  *key = fingerprint;
+  if (!filter_tables_) {
+    return;
+  }
+  // A marker keeps an empty filter apart from none.
+  key->push_back(1);
+  for (IntegerSet::iterator tag = table_filter_.begin(),
+                            tags_end = table_filter_.end();
+                            tag != tags_end; ++tag) {
+    for (int32_t shift = 24; shift >= 0; shift -= 8) {
+      key->push_back(static_cast<byte_t>(*tag >> shift));
+    }
+  }
+}
+
+CALLER_ATTACH Arena* FontFactory::NewArena() {
+  ArenaPtr arena;
+  if (use_arena_) {
+    arena = new Arena();
+  }
+  return arena.Detach();
+}
+
 FontFactory::FontFactory()
-    : fingerprint_(false) {
+    : fingerprint_(false),
+      checksums_(true),
+      use_arena_(false),
+      filter_tables_(false) {
 }
 
 }  // namespace sfntly
@@ -20,8 +20,13 @@
 #include <vector>
 
 #include "sfntly/port/refcount.h"
+#include "sfntly/port/executor.h"
 #include "sfntly/port/type.h"
 #include "sfntly/font.h"
+#if !defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+#include "sfntly/port/thread_pool.h"
+#include "sfntly/font_cache.h"
+#endif
 
 namespace sfntly {
 
@@ -32,15 +37,93 @@ class FontFactory : public RefCounted<FontFactory> {
   // Factory method for the construction of a font factory.
   static CALLER_ATTACH FontFactory* GetInstance();
 
-  // Toggle whether fonts that are loaded are fingerprinted with a SHA-1 hash.
-  // If a font is fingerprinted then a SHA-1 hash is generated at load time and
+  // Toggle whether fonts that are loaded are fingerprinted with a hash.
+  // If a font is fingerprinted then a hash is generated at load time and
   // stored in the font. This is useful for uniquely identifying fonts. By
-  // default this is turned on.
+  // default this is turned off.
+  // Note: the C++ port uses a fast 128-bit non-cryptographic hash (see
+  // Fingerprint128()) instead of SHA-1. Only fonts loaded from a byte array,
+  // a file path or a borrowed buffer are fingerprinted; for a font collection
+  // the fingerprint is that of the whole collection.
   // @param fingerprint whether fingerprinting should be turned on or off
-  // TODO(arthurhsu): IMPLEMENT: C++ port currently don't do any SHA-1
   void FingerprintFont(bool fingerprint);
   bool FingerprintFont();
 
+  // Toggle whether each font (or font collection) that is loaded, and each new
+  // font builder, gets an Arena of its own. The headers, font data slices,
+  // tables and builders created while loading or building it are then placed
+  // in the arena and freed together once the font and every one of them are
+  // gone, so a table kept after its font keeps all of the font's memory. Off
+  // by default.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param use_arena whether arenas should be used
+  void UseArena(bool use_arena);
+  bool UseArena();
+
+  // Restrict the tables read from font files to those with the given tags,
+  // plus the tables they need to be parsed (hhea and maxp for hmtx, head and
+  // maxp for loca, maxp for hdmx). With an empty set only the table directory
+  // is read. The records of the skipped tables are kept in the fonts and
+  // builders loaded (see Font::unloaded_tables()), and a font loads them on
+  // request with Font::LoadUnloadedTable(). All tables are loaded by default.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param tags the tags of the tables to load
+  void SetTableFilter(const IntegerSet& tags);
+
+  // Load all tables of font files again.
+  void ClearTableFilter();
+
+  // Get the tables loaded from font files; NULL if all of them are.
+  const IntegerSet* table_filter();
+
+  // Set the executor the work of this factory and of its font builders is
+  // handed to: the tables of a font builder are built concurrently, tables
+  // the others depend on first, the member fonts of a font collection are
+  // loaded concurrently and the table checksums of the fonts serialized are
+  // computed concurrently. Embedders may pass an executor of their own to
+  // keep that work on threads they manage. With no executor, the default,
+  // everything runs on the calling thread. Builds with
+  // SFNTLY_THREAD_CONFINED_REFCOUNT may only set an executor without threads.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param executor the executor to use; NULL to work on the calling thread
+  void SetExecutor(Executor* executor);
+
+  // Get the executor work is handed to; NULL if there is none.
+  Executor* executor() { return executor_; }
+
+#if !defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+  // Same as SetExecutor(); kept for code written before executors.
+  void SetThreadPool(ThreadPool* pool);
+
+  // Get the thread pool set with SetThreadPool(); NULL if there is none or
+  // another executor has been set since.
+  ThreadPool* thread_pool() { return thread_pool_; }
+
+  // Set the cache the fonts loaded from a byte array, a file path or a
+  // borrowed buffer are looked up in and added to, by the fingerprint of the
+  // data and the table filter. Loading data already cached returns the fonts
+  // already parsed, which are shared with every other caller. A cache may be
+  // shared by several factories. A font loaded from a borrowed buffer is
+  // loaded from a copy of the buffer when it is cached, since it may outlive
+  // the buffer. Fonts loaded into builders are never cached.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param cache the cache to use; NULL, the default, for none
+  void SetFontCache(FontCache* cache);
+
+  // Get the cache fonts are looked up in; NULL if there is none.
+  FontCache* font_cache() { return font_cache_; }
+#endif
+
+  // Toggle whether the table checksums and head.checkSumAdjustment of the
+  // fonts serialized are computed. The checksums are computed on the
+  // executor, if any. Without them the table records get a zero checksum and
+  // the head table is written unchanged, which is faster for output whose
+  // validity is checked elsewhere. By default this is turned on.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param checksums whether checksums should be computed
+  void ComputeChecksums(bool checksums);
+  bool ComputeChecksums();
+
   // Load the font(s) from the input stream. The current settings on the factory
   // are used during the loading process. One or more fonts are returned if the
   // stream contains valid font data. Some font container formats may have more
@@ -58,6 +141,35 @@ class FontFactory : public RefCounted<FontFactory> {
   // will be returned.
   void LoadFonts(ByteVector* b, FontArray* output);
 
+  // Memory mapped font loading
+  // Load the font(s) from the file at the given path. The file is mapped
+  // read-only into memory and the tables of the returned fonts are slices of
+  // that mapping rather than copies, so only the tables which are actually
+  // accessed are paged in. The mapping is released once the last font (or
+  // table) referencing it is destroyed. Tables are copied on their first
+  // modification through a builder; the file itself is never written. If the
+  // file cannot be mapped or its data cannot be parsed an array of size zero
+  // will be returned.
+  void LoadFonts(const char* file_path, FontArray* output);
+
+  // Borrowed buffer font loading
+  // Load the font(s) from a buffer owned by the caller. Nothing is copied: the
+  // tables of the returned fonts are read-only slices of |b|, and a table is
+  // only copied if it is later modified through a builder. The caller must
+  // keep |b| alive and unmodified for as long as any of the returned fonts, or
+  // any table or data obtained from them, is in use. If the data cannot be
+  // parsed or is invalid an array of size zero will be returned.
+  void LoadFonts(const byte_t* b, size_t length, FontArray* output);
+
+  // Positional file font loading
+  // Load the font(s) from a file opened with a RandomAccessFileInputStream.
+  // The font is read with a few large positional reads instead of through the
+  // stream position, which is left unchanged, so fonts can be loaded from one
+  // open file on several threads at once. If the data cannot be parsed or is
+  // invalid an array of size zero will be returned.
+  // Note: C++ port only, there is no Java equivalent.
+  void LoadFonts(RandomAccessFileInputStream* is, FontArray* output);
+
   // Load the font(s) from the input stream into font builders. The current
   // settings on the factory are used during the loading process. One or more
   // font builders are returned if the stream contains valid font data. Some
@@ -74,6 +186,23 @@ class FontFactory : public RefCounted<FontFactory> {
   // cannot be parsed or is invalid an array of size zero will be returned.
   void LoadFontsForBuilding(ByteVector* b, FontBuilderArray* output);
 
+  // Load the font(s) from the file at the given path into font builders. The
+  // file is memory mapped as described in LoadFonts(const char*, FontArray*).
+  void LoadFontsForBuilding(const char* file_path, FontBuilderArray* output);
+
+  // Load the font(s) from a buffer owned by the caller into font builders. The
+  // same lifetime contract as LoadFonts(const byte_t*, size_t, FontArray*)
+  // applies to the builders and the fonts built from them.
+  void LoadFontsForBuilding(const byte_t* b,
+                            size_t length,
+                            FontBuilderArray* output);
+
+  // Load the font(s) from a file opened with a RandomAccessFileInputStream
+  // into font builders, as described in
+  // LoadFonts(RandomAccessFileInputStream*, FontArray*).
+  void LoadFontsForBuilding(RandomAccessFileInputStream* is,
+                            FontBuilderArray* output);
+
   // Font serialization
   // Serialize the font to the output stream.
   // NOTE: in this port we attempted not to implement I/O stream because dealing
@@ -81,6 +210,30 @@ class FontFactory : public RefCounted<FontFactory> {
   //       Byte buffer it is.
   void SerializeFont(Font* font, OutputStream* os);
 
+  // Serialize the font into scatter-gather segments using the table ordering
+  // set on the factory; see Font::Serialize(GatherOutput*, IntegerList*).
+  // Note: C++ port only, there is no Java equivalent.
+  // @param font the font to serialize
+  // @param output the destination
+  void SerializeFont(Font* font, GatherOutput* output);
+
+  // Get the exact size of the font serialized with the table ordering set on
+  // the factory.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param font the font to measure
+  // @return the size in bytes
+  size_t SerializedFontSize(Font* font);
+
+  // Serialize the font with the table ordering set on the factory straight
+  // into a buffer provided by the caller, e.g. shared memory or a pooled
+  // buffer sized with SerializedFontSize().
+  // Note: C++ port only, there is no Java equivalent.
+  // @param font the font to serialize
+  // @param dst the destination
+  // @param capacity the size of the destination in bytes
+  // @return the number of bytes written; 0 if the destination is too small
+  size_t SerializeFontTo(Font* font, byte_t* dst, size_t capacity);
+
   // Set the table ordering to be used in serializing a font. The table ordering
   // is an ordered list of table ids and tables will be serialized in the order
   // given. Any tables whose id is not listed in the ordering will be placed in
@@ -110,10 +263,20 @@ class FontFactory : public RefCounted<FontFactory> {
     };
   };
 
+  // Loads one member font of a font collection, possibly on the executor.
+  class CollectionMemberLoad;
+
   FontFactory();
 
+  // Load the fonts from wfd through the font cache, if any. If borrowed, wfd
+  // is only valid for the duration of the call.
+  void LoadFonts(WritableFontData* wfd, bool borrowed, FontArray* output);
+  void LoadFonts(WritableFontData* wfd, FontArray* output);
+  void LoadFontsForBuilding(WritableFontData* wfd, FontBuilderArray* output);
+
   CALLER_ATTACH Font* LoadSingleOTF(InputStream* is);
-  CALLER_ATTACH Font* LoadSingleOTF(WritableFontData* wfd);
+  CALLER_ATTACH Font* LoadSingleOTF(WritableFontData* wfd,
+                                    int32_t offset_to_offset_table);
 
   void LoadCollection(InputStream* is, FontArray* output);
   void LoadCollection(WritableFontData* wfd, FontArray* output);
@@ -127,11 +290,38 @@ class FontFactory : public RefCounted<FontFactory> {
   void LoadCollectionForBuilding(WritableFontData* ba,
                                  FontBuilderArray* builders);
 
+  // Load the member fonts of the font collection, on the executor if there
+  // is one: as read-only fonts sharing table_cache, or as builders if
+  // table_cache is NULL.
+  void LoadCollectionMembers(WritableFontData* wfd,
+                             Font::TableCache* table_cache,
+                             std::vector<CollectionMemberLoad>* loads);
+
   static bool IsCollection(PushbackInputStream* pbis);
+  static bool IsCollection(RandomAccessFileInputStream* is);
   static bool IsCollection(ReadableFontData* wfd);
 
+  // Compute the fingerprint of the data; left empty if it cannot be read.
+  static void Fingerprint(ReadableFontData* data, ByteVector* fingerprint);
+
+  // Get the key the fonts loaded from data with the given fingerprint are
+  // cached under: the fingerprint followed by the table filter, if any.
+  void FontCacheKey(const ByteVector& fingerprint, ByteVector* key);
+
+  // Create the arena for a new font; NULL if arenas are not used.
+  CALLER_ATTACH Arena* NewArena();
+
   bool fingerprint_;
+  bool checksums_;
+  bool use_arena_;
+  bool filter_tables_;
+  IntegerSet table_filter_;
   IntegerList table_ordering_;
+  ExecutorPtr executor_;
+#if !defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+  ThreadPoolPtr thread_pool_;
+  FontCachePtr font_cache_;
+#endif
 };
 typedef Ptr<FontFactory> FontFactoryPtr;
 
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/port/arena.h"
+
+#include "sfntly/port/config.h"
+
+namespace sfntly {
+
+namespace {
+
+// Every arena object is preceded by the arena it was placed in, or NULL for
+// the heap, padded to keep the object aligned for the pointers and 64-bit
+// integers it holds.
+const size_t kObjectPrefix = 8;
+const size_t kAlignment = 16;
+
+SFNTLY_THREAD_LOCAL Arena* g_current_arena = NULL;
+
+}  // namespace
+
+/******************************************************************************
+ * ArenaObject class
+ ******************************************************************************/
+void* ArenaObject::operator new(size_t size) {
+  Arena* arena = g_current_arena;
+  byte_t* p;
+  if (arena) {
+    p = static_cast<byte_t*>(arena->Allocate(kObjectPrefix + size));
+    // The object keeps its memory alive, however long it is referenced.
+    arena->AddRef();
+  } else {
+    p = static_cast<byte_t*>(::operator new(kObjectPrefix + size));
+  }
+  *reinterpret_cast<Arena**>(p) = arena;
+  return p + kObjectPrefix;
+}
+
+void ArenaObject::operator delete(void* p) {
+  if (p == NULL) {
+    return;
+  }
+  // Memory in an arena goes with the arena, once its last object is gone.
+  byte_t* allocation = static_cast<byte_t*>(p) - kObjectPrefix;
+  Arena* arena = *reinterpret_cast<Arena**>(allocation);
+  if (arena) {
+    arena->Release();
+  } else {
+    ::operator delete(allocation);
+  }
+}
+
+/******************************************************************************
+ * Arena class
+ ******************************************************************************/
+Arena::Arena()
+    : block_size_(kDefaultBlockSize),
+      next_(NULL),
+      end_(NULL),
+      allocations_(0),
+      bytes_allocated_(0) {
+}
+
+Arena::Arena(size_t block_size)
+    : block_size_(block_size),
+      next_(NULL),
+      end_(NULL),
+      allocations_(0),
+      bytes_allocated_(0) {
+}
+
+Arena::~Arena() {
+  for (size_t i = 0; i < blocks_.size(); ++i) {
+    delete[] blocks_[i];
+  }
+}
+
+void* Arena::Allocate(size_t size) {
+  size = (size + kAlignment - 1) & ~(kAlignment - 1);
+  AutoLock lock(lock_);
+  ++allocations_;
+  bytes_allocated_ += size;
+  // Large allocations get a block of their own so the current one is kept.
+  if (size > block_size_ / 4) {
+    return NewBlock(size);
+  }
+  if (next_ == NULL || (size_t)(end_ - next_) < size) {
+    next_ = NewBlock(block_size_);
+    end_ = next_ + block_size_;
+  }
+  byte_t* p = next_;
+  next_ += size;
+  return p;
+}
+
+size_t Arena::allocations() {
+  AutoLock lock(lock_);
+  return allocations_;
+}
+
+size_t Arena::bytes_allocated() {
+  AutoLock lock(lock_);
+  return bytes_allocated_;
+}
+
+size_t Arena::blocks() {
+  AutoLock lock(lock_);
+  return blocks_.size();
+}
+
+Arena* Arena::Current() {
+  return g_current_arena;
+}
+
+byte_t* Arena::NewBlock(size_t size) {
+  // operator new[] returns memory aligned for any fundamental type.
+  byte_t* block = new byte_t[size];
+  blocks_.push_back(block);
+  return block;
+}
+
+/******************************************************************************
+ * ArenaScope class
+ ******************************************************************************/
+ArenaScope::ArenaScope(Arena* arena) : previous_(g_current_arena) {
+  if (arena) {
+    g_current_arena = arena;
+  }
+}
+
+ArenaScope::~ArenaScope() {
+  g_current_arena = previous_;
+}
+
+}  // namespace sfntly
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_ARENA_H_
+#define SFNTLY_CPP_SRC_SFNTLY_PORT_ARENA_H_
+
+#include <vector>
+
+#include "sfntly/port/lock.h"
+#include "sfntly/port/refcount.h"
+#include "sfntly/port/type.h"
+
+namespace sfntly {
+
+// A bump allocator for the many small ref counted objects that make up a font:
+// headers, font data slices, byte arrays, tables and their builders, i.e. the
+// objects of the classes derived from ArenaObject. While an ArenaScope is
+// active on a thread every such object created on that thread is placed in
+// its arena. Each object holds a reference to its arena, as does whoever made
+// it the current arena, usually a font or font builder, and the memory is
+// released in one shot when the last of them is gone. Objects taken from a
+// font with an arena may thus outlive the font, but keep all of its memory.
+// Memory of objects freed early is not reused, so an arena suits objects that
+// live and die with one font.
+// Note: C++ port only, there is no Java equivalent.
+class Arena : public RefCounted<Arena, AtomicRefCountPolicy> {
+ public:
+  static const size_t kDefaultBlockSize = 64 * 1024;
+
+  Arena();
+  explicit Arena(size_t block_size);
+  virtual ~Arena();
+
+  // Allocates size bytes aligned for any object. Thread safe.
+  void* Allocate(size_t size);
+
+  // Statistics since construction.
+  size_t allocations();
+  size_t bytes_allocated();
+  size_t blocks();
+
+  // Gets the arena new objects on this thread are placed in; NULL if none.
+  static Arena* Current();
+
+ private:
+  byte_t* NewBlock(size_t size);
+
+  Lock lock_;
+  size_t block_size_;
+  std::vector<byte_t*> blocks_;
+  byte_t* next_;
+  byte_t* end_;
+  size_t allocations_;
+  size_t bytes_allocated_;
+
+  NO_COPY_AND_ASSIGN(Arena);
+};
+typedef Ptr<Arena> ArenaPtr;
+
+// Makes an arena current on this thread while the scope is alive. Scopes nest;
+// a NULL arena leaves the current arena unchanged.
+class ArenaScope {
+ public:
+  explicit ArenaScope(Arena* arena);
+  ~ArenaScope();
+
+ private:
+  Arena* previous_;
+  NO_COPY_AND_ASSIGN(ArenaScope);
+};
+
+// Base of the classes whose objects are placed in the current arena, if any,
+// and hold a reference to it until they are deleted. Objects of other classes
+// always live on the heap and pay nothing for arenas.
+// Note: C++ port only, there is no Java equivalent.
+class ArenaObject {
+ public:
+  static void* operator new(size_t size);
+  static void operator delete(void* p);
+};
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_ARENA_H_
@@ -17,6 +17,8 @@
 #ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_ATOMIC_H_
 #define SFNTLY_CPP_SRC_SFNTLY_PORT_ATOMIC_H_
 
+#include "sfntly/port/type.h"
+
 #if defined (WIN32)
 
 #include <windows.h>
@@ -37,6 +39,48 @@ static inline size_t AtomicDecrement(size_t* address) {
 #endif
 }
 
+// Stores new_value at address if it still holds old_value.
+// @return true if the value was stored
+static inline bool AtomicCompareAndSwap(size_t* address,
+                                        size_t old_value,
+                                        size_t new_value) {
+#if defined (_WIN64)
+  return InterlockedCompareExchange64(reinterpret_cast<LONGLONG*>(address),
+                                      new_value, old_value) ==
+         (LONGLONG)old_value;
+#else
+  return InterlockedCompareExchange(reinterpret_cast<LONG*>(address),
+                                    new_value, old_value) == (LONG)old_value;
+#endif
+}
+
+static inline bool AtomicCompareAndSwapPointer(void** address,
+                                               void* old_value,
+                                               void* new_value) {
+  return InterlockedCompareExchangePointer(address, new_value, old_value) ==
+         old_value;
+}
+
+// Volatile accesses are acquire/release on MSVC; the barriers make the intent
+// explicit and keep other compilers honest.
+static inline int32_t AtomicLoadAcquire(volatile int32_t* address) {
+  int32_t value = *address;
+  MemoryBarrier();
+  return value;
+}
+
+static inline void AtomicStoreRelease(volatile int32_t* address,
+                                      int32_t value) {
+  MemoryBarrier();
+  *address = value;
+}
+
+static inline size_t AtomicLoadAcquire(volatile size_t* address) {
+  size_t value = *address;
+  MemoryBarrier();
+  return value;
+}
+
 #elif defined (__APPLE__)
 
 #include <libkern/OSAtomic.h>
@@ -49,6 +93,37 @@ static inline size_t AtomicDecrement(size_t* address) {
   return OSAtomicDecrement32Barrier(reinterpret_cast<int32_t*>(address));
 }
 
+static inline bool AtomicCompareAndSwap(size_t* address,
+                                        size_t old_value,
+                                        size_t new_value) {
+  return OSAtomicCompareAndSwapLongBarrier(old_value, new_value,
+                                           reinterpret_cast<long*>(address));
+}
+
+static inline bool AtomicCompareAndSwapPointer(void** address,
+                                               void* old_value,
+                                               void* new_value) {
+  return OSAtomicCompareAndSwapPtrBarrier(old_value, new_value, address);
+}
+
+static inline int32_t AtomicLoadAcquire(volatile int32_t* address) {
+  int32_t value = *address;
+  OSMemoryBarrier();
+  return value;
+}
+
+static inline void AtomicStoreRelease(volatile int32_t* address,
+                                      int32_t value) {
+  OSMemoryBarrier();
+  *address = value;
+}
+
+static inline size_t AtomicLoadAcquire(volatile size_t* address) {
+  size_t value = *address;
+  OSMemoryBarrier();
+  return value;
+}
+
 // Originally we check __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4, however, there are
 // issues that clang not carring over this definition.  Therefore we boldly
 // assume it's gcc or gcc-compatible here.  Compilation shall still fail since
@@ -66,6 +141,31 @@ static inline size_t AtomicDecrement(size_t* address) {
   return __sync_sub_and_fetch(address, 1);
 }
 
+static inline bool AtomicCompareAndSwap(size_t* address,
+                                        size_t old_value,
+                                        size_t new_value) {
+  return __sync_bool_compare_and_swap(address, old_value, new_value);
+}
+
+static inline bool AtomicCompareAndSwapPointer(void** address,
+                                               void* old_value,
+                                               void* new_value) {
+  return __sync_bool_compare_and_swap(address, old_value, new_value);
+}
+
+static inline int32_t AtomicLoadAcquire(volatile int32_t* address) {
+  return __atomic_load_n(address, __ATOMIC_ACQUIRE);
+}
+
+static inline void AtomicStoreRelease(volatile int32_t* address,
+                                      int32_t value) {
+  __atomic_store_n(address, value, __ATOMIC_RELEASE);
+}
+
+static inline size_t AtomicLoadAcquire(volatile size_t* address) {
+  return __atomic_load_n(address, __ATOMIC_ACQUIRE);
+}
+
 #endif  // WIN32
 
 #endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_ATOMIC_H_
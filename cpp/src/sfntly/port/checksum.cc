@@ -0,0 +1,146 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/port/checksum.h"
+
+#include "sfntly/port/atomic.h"
+#include "sfntly/port/config.h"
+#include "sfntly/port/endian.h"
+
+#if defined (SFNTLY_SSE2)
+#include <emmintrin.h>
+#endif
+#if defined (SFNTLY_AVX2)
+#include <immintrin.h>
+#endif
+
+namespace sfntly {
+
+namespace {
+
+typedef uint64_t (*SumFunction)(const byte_t* b, size_t count);
+
+uint64_t SumScalar(const byte_t* b, size_t count) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < count; ++i, b += 4) {
+    sum += LoadBE32(b);
+  }
+  return sum;
+}
+
+#if defined (SFNTLY_SSE2)
+// Four words per step: byte swap each 32-bit lane with shifts, then widen the
+// lanes to 64 bits so the accumulators never overflow.
+uint64_t SumSSE2(const byte_t* b, size_t count) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i mask = _mm_set1_epi32(0x0000ff00);
+  __m128i acc = zero;
+  size_t blocks = count / 4;
+  for (size_t i = 0; i < blocks; ++i, b += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+    __m128i s = _mm_or_si128(
+        _mm_or_si128(_mm_slli_epi32(v, 24), _mm_srli_epi32(v, 24)),
+        _mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, mask), 8),
+                     _mm_and_si128(_mm_srli_epi32(v, 8), mask)));
+    acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(s, zero));
+    acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(s, zero));
+  }
+  uint64_t lanes[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+  return lanes[0] + lanes[1] + SumScalar(b, count % 4);
+}
+#endif
+
+#if defined (SFNTLY_AVX2)
+// Eight words per step, byte swapping with a single shuffle.
+__attribute__((target("avx2")))
+uint64_t SumAVX2(const byte_t* b, size_t count) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                                        11, 10, 9, 8, 15, 14, 13, 12,
+                                        3, 2, 1, 0, 7, 6, 5, 4,
+                                        11, 10, 9, 8, 15, 14, 13, 12);
+  __m256i acc = zero;
+  size_t blocks = count / 8;
+  for (size_t i = 0; i < blocks; ++i, b += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+    __m256i s = _mm256_shuffle_epi8(v, swap);
+    acc = _mm256_add_epi64(acc, _mm256_unpacklo_epi32(s, zero));
+    acc = _mm256_add_epi64(acc, _mm256_unpackhi_epi32(s, zero));
+  }
+  uint64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + SumSSE2(b, count % 8);
+}
+#endif
+
+// The kernels by index. The table and the index of the kernel to use are both
+// constant initialized, so that static initializers elsewhere may sum too.
+enum SumKernel {
+  kSumUnselected = 0,
+  kSumScalar,
+  kSumSSE2,
+  kSumAVX2
+};
+
+const SumFunction kSumFunctions[] = {
+  NULL,
+  SumScalar,
+#if defined (SFNTLY_SSE2)
+  SumSSE2,
+#else
+  SumScalar,
+#endif
+#if defined (SFNTLY_AVX2)
+  SumAVX2,
+#else
+  SumScalar,
+#endif
+};
+
+volatile int32_t g_sum_kernel = kSumUnselected;
+
+int32_t SelectSumKernel() {
+#if defined (SFNTLY_AVX2)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return kSumAVX2;
+  }
+#endif
+#if defined (SFNTLY_SSE2)
+  return kSumSSE2;
+#else
+  return kSumScalar;
+#endif
+}
+
+// Picks the kernel on first use. Threads racing here all pick the same one.
+SumFunction GetSumFunction() {
+  int32_t kernel = AtomicLoadAcquire(&g_sum_kernel);
+  if (kernel == kSumUnselected) {
+    kernel = SelectSumKernel();
+    AtomicStoreRelease(&g_sum_kernel, kernel);
+  }
+  return kSumFunctions[kernel];
+}
+
+}  // namespace
+
+uint64_t SumBigEndianULongs(const byte_t* b, size_t count) {
+  return GetSumFunction()(b, count);
+}
+
+}  // namespace sfntly
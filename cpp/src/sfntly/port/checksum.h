@@ -0,0 +1,36 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_CHECKSUM_H_
+#define SFNTLY_CPP_SRC_SFNTLY_PORT_CHECKSUM_H_
+
+#include <stddef.h>
+
+#include "sfntly/port/type.h"
+
+namespace sfntly {
+
+// Sum of count consecutive unsigned 32-bit big endian words starting at b,
+// which need not be aligned. The sum is exact, callers truncate it to 32 bits
+// as the OpenType table checksum requires.
+// On x86 this uses AVX2 or SSE2 depending on what the CPU supports at run
+// time; elsewhere it is a plain loop.
+// Note: C++ port only, there is no Java equivalent.
+uint64_t SumBigEndianULongs(const byte_t* b, size_t count);
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_CHECKSUM_H_
@@ -25,4 +25,31 @@
   #endif
 #endif
 
+// Vectorized kernels. SSE2 is part of every x86-64 CPU so it is used whenever
+// the compiler targets it; AVX2 is compiled per function (GCC and clang only)
+// and chosen at run time. Define SFNTLY_NO_SIMD to use plain loops everywhere.
+#if !defined(SFNTLY_NO_SIMD)
+  #if defined (__SSE2__) || defined (_M_X64) || \
+      (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SFNTLY_SSE2
+  #endif
+  #if defined (SFNTLY_SSE2) && defined (__GNUC__) && \
+      (defined (__x86_64__) || defined (__i386__))
+    #define SFNTLY_AVX2
+  #endif
+#endif
+
+// C++11 rvalue references, used for move operations on smart pointers and
+// the containers holding them. The code also builds as C++98 without them.
+#if __cplusplus >= 201103L || (defined (_MSC_VER) && _MSC_VER >= 1900)
+  #define SFNTLY_HAS_RVALUE_REFERENCES
+#endif
+
+// Storage class for thread local variables of plain old data types.
+#if defined (_MSC_VER)
+  #define SFNTLY_THREAD_LOCAL __declspec(thread)
+#else
+  #define SFNTLY_THREAD_LOCAL __thread
+#endif
+
 #endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_CONFIG_H_
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/port/endian.h"
+
+#include "sfntly/port/atomic.h"
+
+#if defined (SFNTLY_SSE2)
+#include <emmintrin.h>
+#endif
+#if defined (SFNTLY_AVX2)
+#include <immintrin.h>
+#endif
+
+namespace sfntly {
+
+namespace {
+
+#if defined (SFNTLY_LITTLE_ENDIAN)
+
+typedef void (*SwapFunction)(const byte_t* src, byte_t* dst, size_t count);
+
+void Swap16Scalar(const byte_t* src, byte_t* dst, size_t count) {
+  for (size_t i = 0; i < count; ++i, src += 2, dst += 2) {
+    uint16_t value;
+    memcpy(&value, src, sizeof(value));
+    value = EndianSwap16(value);
+    memcpy(dst, &value, sizeof(value));
+  }
+}
+
+void Swap32Scalar(const byte_t* src, byte_t* dst, size_t count) {
+  for (size_t i = 0; i < count; ++i, src += 4, dst += 4) {
+    uint32_t value = LoadBE32(src);
+    memcpy(dst, &value, sizeof(value));
+  }
+}
+
+#if defined (SFNTLY_SSE2)
+// Every vector is loaded before it is stored so src == dst is fine.
+void Swap16SSE2(const byte_t* src, byte_t* dst, size_t count) {
+  size_t blocks = count / 8;
+  for (size_t i = 0; i < blocks; ++i, src += 16, dst += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+  }
+  Swap16Scalar(src, dst, count % 8);
+}
+
+void Swap32SSE2(const byte_t* src, byte_t* dst, size_t count) {
+  const __m128i mask = _mm_set1_epi32(0x0000ff00);
+  size_t blocks = count / 4;
+  for (size_t i = 0; i < blocks; ++i, src += 16, dst += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    v = _mm_or_si128(
+        _mm_or_si128(_mm_slli_epi32(v, 24), _mm_srli_epi32(v, 24)),
+        _mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, mask), 8),
+                     _mm_and_si128(_mm_srli_epi32(v, 8), mask)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+  }
+  Swap32Scalar(src, dst, count % 4);
+}
+#endif
+
+#if defined (SFNTLY_AVX2)
+__attribute__((target("avx2")))
+void Swap16AVX2(const byte_t* src, byte_t* dst, size_t count) {
+  const __m256i swap = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6,
+                                        9, 8, 11, 10, 13, 12, 15, 14,
+                                        1, 0, 3, 2, 5, 4, 7, 6,
+                                        9, 8, 11, 10, 13, 12, 15, 14);
+  size_t blocks = count / 16;
+  for (size_t i = 0; i < blocks; ++i, src += 32, dst += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                        _mm256_shuffle_epi8(v, swap));
+  }
+  Swap16SSE2(src, dst, count % 16);
+}
+
+__attribute__((target("avx2")))
+void Swap32AVX2(const byte_t* src, byte_t* dst, size_t count) {
+  const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                                        11, 10, 9, 8, 15, 14, 13, 12,
+                                        3, 2, 1, 0, 7, 6, 5, 4,
+                                        11, 10, 9, 8, 15, 14, 13, 12);
+  size_t blocks = count / 8;
+  for (size_t i = 0; i < blocks; ++i, src += 32, dst += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                        _mm256_shuffle_epi8(v, swap));
+  }
+  Swap32SSE2(src, dst, count % 8);
+}
+#endif
+
+// The kernels by index. The tables and the index of the kernels to use are
+// all constant initialized, so that static initializers elsewhere may swap
+// bytes too.
+enum SwapKernel {
+  kSwapUnselected = 0,
+  kSwapScalar,
+  kSwapSSE2,
+  kSwapAVX2
+};
+
+const SwapFunction kSwap16Functions[] = {
+  NULL,
+  Swap16Scalar,
+#if defined (SFNTLY_SSE2)
+  Swap16SSE2,
+#else
+  Swap16Scalar,
+#endif
+#if defined (SFNTLY_AVX2)
+  Swap16AVX2,
+#else
+  Swap16Scalar,
+#endif
+};
+
+const SwapFunction kSwap32Functions[] = {
+  NULL,
+  Swap32Scalar,
+#if defined (SFNTLY_SSE2)
+  Swap32SSE2,
+#else
+  Swap32Scalar,
+#endif
+#if defined (SFNTLY_AVX2)
+  Swap32AVX2,
+#else
+  Swap32Scalar,
+#endif
+};
+
+volatile int32_t g_swap_kernel = kSwapUnselected;
+
+int32_t SelectSwapKernel() {
+#if defined (SFNTLY_AVX2)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return kSwapAVX2;
+  }
+#endif
+#if defined (SFNTLY_SSE2)
+  return kSwapSSE2;
+#else
+  return kSwapScalar;
+#endif
+}
+
+// Picks the kernels on first use. Threads racing here all pick the same ones.
+int32_t GetSwapKernel() {
+  int32_t kernel = AtomicLoadAcquire(&g_swap_kernel);
+  if (kernel == kSwapUnselected) {
+    kernel = SelectSwapKernel();
+    AtomicStoreRelease(&g_swap_kernel, kernel);
+  }
+  return kernel;
+}
+
+void Swap16(const byte_t* src, byte_t* dst, size_t count) {
+  kSwap16Functions[GetSwapKernel()](src, dst, count);
+}
+
+void Swap32(const byte_t* src, byte_t* dst, size_t count) {
+  kSwap32Functions[GetSwapKernel()](src, dst, count);
+}
+
+#endif  // SFNTLY_LITTLE_ENDIAN
+
+}  // namespace
+
+#if defined (SFNTLY_LITTLE_ENDIAN)
+
+void FromBE16Array(const byte_t* src, uint16_t* dst, size_t count) {
+  Swap16(src, reinterpret_cast<byte_t*>(dst), count);
+}
+
+void FromBE32Array(const byte_t* src, uint32_t* dst, size_t count) {
+  Swap32(src, reinterpret_cast<byte_t*>(dst), count);
+}
+
+void ToBE16Array(const uint16_t* src, byte_t* dst, size_t count) {
+  Swap16(reinterpret_cast<const byte_t*>(src), dst, count);
+}
+
+void ToBE32Array(const uint32_t* src, byte_t* dst, size_t count) {
+  Swap32(reinterpret_cast<const byte_t*>(src), dst, count);
+}
+
+#else  // SFNTLY_BIG_ENDIAN
+
+void FromBE16Array(const byte_t* src, uint16_t* dst, size_t count) {
+  memmove(dst, src, count * sizeof(uint16_t));
+}
+
+void FromBE32Array(const byte_t* src, uint32_t* dst, size_t count) {
+  memmove(dst, src, count * sizeof(uint32_t));
+}
+
+void ToBE16Array(const uint16_t* src, byte_t* dst, size_t count) {
+  memmove(dst, src, count * sizeof(uint16_t));
+}
+
+void ToBE32Array(const uint32_t* src, byte_t* dst, size_t count) {
+  memmove(dst, src, count * sizeof(uint32_t));
+}
+
+#endif  // SFNTLY_LITTLE_ENDIAN
+
+}  // namespace sfntly
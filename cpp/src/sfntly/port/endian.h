@@ -17,6 +17,9 @@
 #ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_ENDIAN_H_
 #define SFNTLY_CPP_SRC_SFNTLY_PORT_ENDIAN_H_
 
+#include <stddef.h>
+#include <string.h>
+
 #include "sfntly/port/config.h"
 #include "sfntly/port/type.h"
 
@@ -72,6 +75,28 @@ static inline uint64_t EndianSwap64(uint64_t value) {
   #define FromLE64(n) EndianSwap64(n)
 #endif
 
+// Load big endian values from memory that need not be aligned.
+static inline uint16_t LoadBE16(const byte_t* p) {
+  uint16_t value;
+  memcpy(&value, p, sizeof(value));
+  return FromBE16(value);
+}
+
+static inline uint32_t LoadBE32(const byte_t* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return static_cast<uint32_t>(FromBE32(value));
+}
+
+// Convert count big endian values at src to host order at dst (FromBE*Array)
+// or count host order values at src to big endian at dst (ToBE*Array). The
+// buffers need not be aligned and may be the same, but must not otherwise
+// overlap. Vectorized on x86, see config.h.
+void FromBE16Array(const byte_t* src, uint16_t* dst, size_t count);
+void FromBE32Array(const byte_t* src, uint32_t* dst, size_t count);
+void ToBE16Array(const uint16_t* src, byte_t* dst, size_t count);
+void ToBE32Array(const uint32_t* src, byte_t* dst, size_t count);
+
 }  // namespace sfntly
 
 #endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_ENDIAN_H_
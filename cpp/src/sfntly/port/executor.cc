@@ -0,0 +1,118 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/port/executor.h"
+
+#include <assert.h>
+
+namespace sfntly {
+
+namespace {
+
+// The number of subranges a ParallelFor() makes per thread.
+const int32_t kRangesPerThread = 4;
+
+class ParallelForTask : public Executor::Task {
+ public:
+  ParallelForTask(ParallelForBody* body, int32_t begin, int32_t end)
+      : body_(body), begin_(begin), end_(end) {
+  }
+
+  virtual void Run() { body_->Run(begin_, end_); }
+
+ private:
+  ParallelForBody* body_;
+  int32_t begin_;
+  int32_t end_;
+};
+
+}  // namespace
+
+/******************************************************************************
+ * TaskGroup class
+ ******************************************************************************/
+TaskGroup::TaskGroup(Executor* executor) : executor_(executor) {
+}
+
+TaskGroup::~TaskGroup() {
+  Wait();
+}
+
+void TaskGroup::Add(Executor::Task* task) {
+  assert(task);
+  tasks_.push_back(task);
+}
+
+void TaskGroup::Wait() {
+  if (tasks_.empty()) {
+    return;
+  }
+  Executor::TaskList tasks;
+  tasks.swap(tasks_);
+  if (executor_ != NULL) {
+    executor_->RunTasks(&tasks);
+  } else {
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      tasks[i]->Run();
+    }
+  }
+}
+
+/******************************************************************************
+ * ParallelFor
+ ******************************************************************************/
+void ParallelFor(Executor* executor,
+                 int32_t begin,
+                 int32_t end,
+                 int32_t grain_size,
+                 ParallelForBody* body) {
+  assert(body);
+  if (end <= begin) {
+    return;
+  }
+  int64_t count = (int64_t)end - begin;
+  int64_t grain = grain_size > 0 ? grain_size : 1;
+  int64_t num_ranges = (count + grain - 1) / grain;
+  int64_t max_ranges =
+      executor ? ((int64_t)executor->num_threads() + 1) * kRangesPerThread : 1;
+  if (num_ranges > max_ranges) {
+    num_ranges = max_ranges;
+  }
+  if (num_ranges <= 1) {
+    body->Run(begin, end);
+    return;
+  }
+
+  // The first count % num_ranges subranges get one index more.
+  std::vector<ParallelForTask> tasks;
+  tasks.reserve((size_t)num_ranges);
+  int64_t range_begin = begin;
+  for (int64_t i = 0; i < num_ranges; ++i) {
+    int64_t range_end = range_begin + count / num_ranges +
+                        (i < count % num_ranges ? 1 : 0);
+    tasks.push_back(ParallelForTask(body, (int32_t)range_begin,
+                                    (int32_t)range_end));
+    range_begin = range_end;
+  }
+  assert(range_begin == end);
+  Executor::TaskList task_list;
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    task_list.push_back(&tasks[i]);
+  }
+  executor->RunTasks(&task_list);
+}
+
+}  // namespace sfntly
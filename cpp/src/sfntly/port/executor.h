@@ -0,0 +1,111 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_EXECUTOR_H_
+#define SFNTLY_CPP_SRC_SFNTLY_PORT_EXECUTOR_H_
+
+#include <vector>
+
+#include "sfntly/port/refcount.h"
+#include "sfntly/port/type.h"
+
+namespace sfntly {
+
+// Runs batches of tasks for the library, e.g. the table builds of a font
+// builder or the member loads of a font collection. Embedders that manage
+// their own threads implement this to have the library work on them; the
+// library itself never starts threads. ThreadPool and WorkStealingScheduler
+// are the executors that come with it. Builds with
+// SFNTLY_THREAD_CONFINED_REFCOUNT may only use executors without threads.
+// Note: C++ port only, there is no Java equivalent.
+class Executor : virtual public RefCount {
+ public:
+  class Task {
+   public:
+    virtual ~Task() {}
+    virtual void Run() = 0;
+  };
+  typedef std::vector<Task*> TaskList;
+
+  virtual ~Executor() {}
+
+  // Run the tasks and wait for all of them to finish. The tasks are owned by
+  // the caller. Tasks may run batches of their own on the same executor, so
+  // a thread waiting for its batch should run queued tasks meanwhile rather
+  // than block.
+  // @param tasks the tasks to run; may run in any order and concurrently
+  virtual void RunTasks(TaskList* tasks) = 0;
+
+  // Get the number of threads that run tasks besides the calling one; 0 if
+  // all tasks run on the calling thread.
+  virtual int32_t num_threads() = 0;
+};
+typedef Ptr<Executor> ExecutorPtr;
+
+// Collects tasks and runs them as one batch on an executor, or on the calling
+// thread without one. A group waits for its tasks when it goes out of scope,
+// so tasks may safely refer to the locals of the function that added them.
+// Note: C++ port only, there is no Java equivalent.
+class TaskGroup {
+ public:
+  // @param executor the executor to run the tasks on; NULL to run them on the
+  //                 thread calling Wait()
+  explicit TaskGroup(Executor* executor);
+  ~TaskGroup();
+
+  // Add a task to run on the next Wait(). The task is owned by the caller.
+  void Add(Executor::Task* task);
+
+  // Run the tasks added so far and wait for all of them to finish.
+  void Wait();
+
+ private:
+  Executor* executor_;
+  Executor::TaskList tasks_;
+
+  NO_COPY_AND_ASSIGN(TaskGroup);
+};
+
+// The work of a ParallelFor() on one subrange.
+// Note: C++ port only, there is no Java equivalent.
+class ParallelForBody {
+ public:
+  virtual ~ParallelForBody() {}
+
+  // Process the indices in [begin, end). Called concurrently for disjoint
+  // subranges.
+  virtual void Run(int32_t begin, int32_t end) = 0;
+};
+
+// Split [begin, end) into subranges of at least grain_size indices, run the
+// body on each of them on the executor and wait for all of them to finish.
+// A few more subranges than threads are made so that threads finishing early
+// can take over the work of the others.
+// Note: C++ port only, there is no Java equivalent.
+// @param executor the executor to run on; NULL to run on the calling thread
+// @param begin the first index
+// @param end one past the last index
+// @param grain_size the smallest number of indices worth a task of its own
+// @param body the work to do on each subrange
+void ParallelFor(Executor* executor,
+                 int32_t begin,
+                 int32_t end,
+                 int32_t grain_size,
+                 ParallelForBody* body);
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_EXECUTOR_H_
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/port/fingerprint.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "sfntly/port/config.h"
+#include "sfntly/port/endian.h"
+
+namespace sfntly {
+
+namespace {
+
+const uint64_t kC1 = 0x87c37b91114253d5ULL;
+const uint64_t kC2 = 0x4cf5ad432745937fULL;
+
+inline uint64_t RotateLeft(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+// The hash is defined on little endian words, whatever the platform.
+inline uint64_t LoadLE64(const byte_t* p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+#if defined (SFNTLY_BIG_ENDIAN)
+  value = EndianSwap64(value);
+#endif
+  return value;
+}
+
+inline void StoreLE64(uint64_t value, byte_t* p) {
+  for (int i = 0; i < 8; ++i, value >>= 8) {
+    p[i] = static_cast<byte_t>(value);
+  }
+}
+
+inline uint64_t Mix(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+}  // namespace
+
+void Fingerprint128(const byte_t* b, size_t length, ByteVector* fingerprint) {
+  assert(b || length == 0);
+  assert(fingerprint);
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+
+  const size_t num_blocks = length / 16;
+  for (size_t i = 0; i < num_blocks; ++i, b += 16) {
+    uint64_t k1 = LoadLE64(b);
+    uint64_t k2 = LoadLE64(b + 8);
+
+    k1 *= kC1; k1 = RotateLeft(k1, 31); k1 *= kC2; h1 ^= k1;
+    h1 = RotateLeft(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+    k2 *= kC2; k2 = RotateLeft(k2, 33); k2 *= kC1; h2 ^= k2;
+    h2 = RotateLeft(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+  }
+
+  // The last 0 to 15 bytes.
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+  size_t tail = length & 15;
+  for (size_t i = tail; i > 8; --i) {
+    k2 = (k2 << 8) | b[i - 1];
+  }
+  for (size_t i = tail < 8 ? tail : 8; i > 0; --i) {
+    k1 = (k1 << 8) | b[i - 1];
+  }
+  if (tail > 8) {
+    k2 *= kC2; k2 = RotateLeft(k2, 33); k2 *= kC1; h2 ^= k2;
+  }
+  if (tail > 0) {
+    k1 *= kC1; k1 = RotateLeft(k1, 31); k1 *= kC2; h1 ^= k1;
+  }
+
+  h1 ^= static_cast<uint64_t>(length);
+  h2 ^= static_cast<uint64_t>(length);
+  h1 += h2;
+  h2 += h1;
+  h1 = Mix(h1);
+  h2 = Mix(h2);
+  h1 += h2;
+  h2 += h1;
+
+  fingerprint->resize(kFingerprintSize);
+  StoreLE64(h1, &((*fingerprint)[0]));
+  StoreLE64(h2, &((*fingerprint)[8]));
+}
+
+}  // namespace sfntly
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_FINGERPRINT_H_
+#define SFNTLY_CPP_SRC_SFNTLY_PORT_FINGERPRINT_H_
+
+#include <stddef.h>
+
+#include "sfntly/port/type.h"
+
+namespace sfntly {
+
+// The size in bytes of the fingerprints made by Fingerprint128.
+const size_t kFingerprintSize = 16;
+
+// Compute a 128-bit fingerprint of length bytes starting at b (MurmurHash3,
+// x64 variant). It is fast and well distributed, so fonts can be told apart
+// and looked up by content, but it is not a cryptographic hash: it must not
+// be relied on against data crafted to collide. The fingerprint is the same
+// on every platform.
+// Note: C++ port only, there is no Java equivalent.
+// @param b the data
+// @param length the size of the data in bytes
+// @param fingerprint receives the kFingerprintSize bytes of the fingerprint
+void Fingerprint128(const byte_t* b, size_t length, ByteVector* fingerprint);
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_FINGERPRINT_H_
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_FLAT_MAP_H_
+#define SFNTLY_CPP_SRC_SFNTLY_PORT_FLAT_MAP_H_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "sfntly/port/config.h"
+
+namespace sfntly {
+
+// An associative container with the interface of the parts of std::map the
+// library uses, kept as a vector of entries sorted by key. Lookups are a
+// binary search over contiguous memory and iteration is in key order, which
+// makes it much faster than std::map for the few dozen entries of a table
+// directory. Inserting and erasing move the entries after the position and
+// invalidate iterators and references, unlike std::map.
+// Note: C++ port only, there is no Java equivalent.
+template <typename Key, typename Value>
+class FlatMap {
+ public:
+  typedef Key key_type;
+  typedef Value mapped_type;
+  typedef std::pair<Key, Value> value_type;
+  typedef typename std::vector<value_type>::iterator iterator;
+  typedef typename std::vector<value_type>::const_iterator const_iterator;
+  typedef typename std::vector<value_type>::size_type size_type;
+
+  iterator begin() { return entries_.begin(); }
+  iterator end() { return entries_.end(); }
+  const_iterator begin() const { return entries_.begin(); }
+  const_iterator end() const { return entries_.end(); }
+
+  size_type size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+  void clear() { entries_.clear(); }
+  void reserve(size_type size) { entries_.reserve(size); }
+  void swap(FlatMap& other) { entries_.swap(other.entries_); }
+
+  iterator lower_bound(const Key& key) {
+    return std::lower_bound(entries_.begin(), entries_.end(), key,
+                            KeyLess());
+  }
+
+  const_iterator lower_bound(const Key& key) const {
+    return std::lower_bound(entries_.begin(), entries_.end(), key,
+                            KeyLess());
+  }
+
+  iterator find(const Key& key) {
+    iterator entry = lower_bound(key);
+    return entry != entries_.end() && !(key < entry->first) ? entry
+                                                              : entries_.end();
+  }
+
+  const_iterator find(const Key& key) const {
+    const_iterator entry = lower_bound(key);
+    return entry != entries_.end() && !(key < entry->first) ? entry
+                                                              : entries_.end();
+  }
+
+  size_type count(const Key& key) const {
+    return find(key) != end() ? 1 : 0;
+  }
+
+  // Insert the entry unless there is one with the same key already.
+  // @return the entry with the key and whether it was inserted
+  std::pair<iterator, bool> insert(const value_type& value) {
+    iterator entry = lower_bound(value.first);
+    if (entry != entries_.end() && !(value.first < entry->first)) {
+      return std::make_pair(entry, false);
+    }
+    return std::make_pair(entries_.insert(entry, value), true);
+  }
+
+#if defined (SFNTLY_HAS_RVALUE_REFERENCES)
+  std::pair<iterator, bool> insert(value_type&& value) {
+    iterator entry = lower_bound(value.first);
+    if (entry != entries_.end() && !(value.first < entry->first)) {
+      return std::make_pair(entry, false);
+    }
+    return std::make_pair(entries_.insert(entry, std::move(value)), true);
+  }
+#endif
+
+  Value& operator[](const Key& key) {
+    return insert(value_type(key, Value())).first->second;
+  }
+
+  void erase(iterator entry) { entries_.erase(entry); }
+
+  size_type erase(const Key& key) {
+    iterator entry = find(key);
+    if (entry == entries_.end()) {
+      return 0;
+    }
+    entries_.erase(entry);
+    return 1;
+  }
+
+ private:
+  struct KeyLess {
+    bool operator()(const value_type& entry, const Key& key) const {
+      return entry.first < key;
+    }
+  };
+
+  std::vector<value_type> entries_;
+};
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_FLAT_MAP_H_
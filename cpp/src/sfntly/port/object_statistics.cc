@@ -0,0 +1,195 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/port/object_statistics.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "sfntly/port/atomic.h"
+#include "sfntly/port/refcount.h"
+
+namespace sfntly {
+
+#if defined (ENABLE_OBJECT_STATISTICS)
+namespace {
+
+// The registered counters as a list which only ever grows at the front, so
+// that it can be read without a lock.
+void* g_type_counters = NULL;
+
+// Extracts the name of TDerived from the signature of
+// RefCounted<TDerived, RefCountPolicy>::TypeSignature(), which is
+//   "... [with TDerived = Foo; RefCountPolicy = ...]" with GCC,
+//   "... [TDerived = Foo, RefCountPolicy = ...]" with clang and
+//   "... RefCounted<class Foo,struct ...>::TypeSignature(void)" with MSVC.
+std::string TypeNameFromSignature(const char* signature) {
+  std::string text(signature);
+  const char* kTemplateArgument = "TDerived = ";
+  const char* kTemplate = "RefCounted<";
+  size_t start = text.find(kTemplateArgument);
+  if (start != std::string::npos) {
+    start += strlen(kTemplateArgument);
+  } else {
+    start = text.find(kTemplate);
+    if (start == std::string::npos) {
+      return text;
+    }
+    start += strlen(kTemplate);
+  }
+  int32_t depth = 0;
+  size_t end = start;
+  for (; end < text.size(); ++end) {
+    char c = text[end];
+    if (c == '<' || c == '(' || c == '[') {
+      ++depth;
+    } else if (c == '>' || c == ')' || c == ']') {
+      if (depth == 0) {
+        break;
+      }
+      --depth;
+    } else if ((c == ',' || c == ';') && depth == 0) {
+      break;
+    }
+  }
+  std::string name = text.substr(start, end - start);
+  const char* kPrefixes[] = { "class ", "struct " };
+  for (size_t i = 0; i < sizeof(kPrefixes) / sizeof(kPrefixes[0]); ++i) {
+    size_t length = strlen(kPrefixes[i]);
+    if (name.compare(0, length, kPrefixes[i]) == 0) {
+      return name.substr(length);
+    }
+  }
+  return name;
+}
+
+bool EntryNameLess(const ObjectStatistics::Entry& a,
+                   const ObjectStatistics::Entry& b) {
+  return a.type_name < b.type_name;
+}
+
+}  // namespace
+
+void RegisterObjectTypeCounters(ObjectTypeCounters* counters,
+                                const char* signature,
+                                size_t object_size) {
+  if (!AtomicCompareAndSwap(&counters->registered, 0, 1)) {
+    return;
+  }
+  counters->signature = signature;
+  counters->object_size = object_size;
+  void* head;
+  do {
+    head = *static_cast<void* volatile*>(&g_type_counters);
+    counters->next = static_cast<ObjectTypeCounters*>(head);
+  } while (!AtomicCompareAndSwapPointer(&g_type_counters, head, counters));
+}
+#endif
+
+static bool EntryTotalGreater(const ObjectStatistics::Entry& a,
+                              const ObjectStatistics::Entry& b) {
+  if (a.total != b.total) {
+    return a.total > b.total;
+  }
+  return a.type_name < b.type_name;
+}
+
+ObjectStatistics::Entry::Entry() : live(0), peak(0), total(0), bytes(0) {
+}
+
+// static
+bool ObjectStatistics::Enabled() {
+#if defined (ENABLE_OBJECT_STATISTICS)
+  return true;
+#else
+  return false;
+#endif
+}
+
+// static
+void ObjectStatistics::Snapshot(EntryList* snapshot) {
+  assert(snapshot);
+  snapshot->clear();
+#if defined (ENABLE_OBJECT_STATISTICS)
+  // Counters are published by a full barrier, and each entry is reached
+  // through the pointer to it.
+  for (ObjectTypeCounters* counters = static_cast<ObjectTypeCounters*>(
+           *static_cast<void* volatile*>(&g_type_counters));
+       counters != NULL; counters = counters->next) {
+    Entry entry;
+    entry.type_name = TypeNameFromSignature(counters->signature);
+    // Objects constructed meanwhile may raise peak past the live count read.
+    size_t live = AtomicLoadAcquire(&counters->live);
+    size_t peak = AtomicLoadAcquire(&counters->peak);
+    entry.total = AtomicLoadAcquire(&counters->constructed);
+    entry.live = live;
+    entry.peak = live > peak ? live : peak;
+    entry.bytes = entry.live * counters->object_size;
+    snapshot->push_back(entry);
+  }
+  std::sort(snapshot->begin(), snapshot->end(), EntryNameLess);
+#endif
+}
+
+// static
+void ObjectStatistics::ResetPeaks() {
+#if defined (ENABLE_OBJECT_STATISTICS)
+  for (ObjectTypeCounters* counters = static_cast<ObjectTypeCounters*>(
+           *static_cast<void* volatile*>(&g_type_counters));
+       counters != NULL; counters = counters->next) {
+    size_t peak = AtomicLoadAcquire(&counters->peak);
+    while (!AtomicCompareAndSwap(&counters->peak, peak,
+                                 AtomicLoadAcquire(&counters->live))) {
+      peak = AtomicLoadAcquire(&counters->peak);
+    }
+  }
+#endif
+}
+
+// static
+void ObjectStatistics::Diff(const EntryList& before,
+                            const EntryList& after,
+                            EntryList* diff) {
+  assert(diff);
+  diff->clear();
+  EntryList::const_iterator b = before.begin(), b_end = before.end();
+  for (EntryList::const_iterator a = after.begin(), a_end = after.end();
+       a != a_end; ++a) {
+    while (b != b_end && b->type_name < a->type_name) {
+      ++b;
+    }
+    Entry entry = *a;
+    if (b != b_end && b->type_name == a->type_name) {
+      entry.live -= b->live;
+      entry.peak -= b->peak;
+      entry.total -= b->total;
+      entry.bytes -= b->bytes;
+    }
+    if (entry.live != 0 || entry.peak != 0 || entry.total != 0) {
+      diff->push_back(entry);
+    }
+  }
+}
+
+// static
+void ObjectStatistics::SortByTotal(EntryList* entries) {
+  assert(entries);
+  std::sort(entries->begin(), entries->end(), EntryTotalGreater);
+}
+
+}  // namespace sfntly
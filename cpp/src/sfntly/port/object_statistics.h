@@ -0,0 +1,89 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_OBJECT_STATISTICS_H_
+#define SFNTLY_CPP_SRC_SFNTLY_PORT_OBJECT_STATISTICS_H_
+
+#include <string>
+#include <vector>
+
+#include "sfntly/port/type.h"
+
+namespace sfntly {
+
+// Read access to the object counts RefCounted keeps per type in debug builds
+// and in release builds configured with SFNTLY_OBJECT_STATISTICS; see
+// sfntly/port/refcount.h. Counting costs two atomic increments per
+// construction and an atomic decrement per destruction, on counters shared by
+// all threads constructing objects of the type. Snapshots taken before and
+// after an operation, such as one subset run, show which types it allocates
+// most and the most objects of each it had alive at once:
+//   ObjectStatistics::EntryList before, after, diff;
+//   ObjectStatistics::ResetPeaks();
+//   ObjectStatistics::Snapshot(&before);
+//   ... operation ...
+//   ObjectStatistics::Snapshot(&after);
+//   ObjectStatistics::Diff(before, after, &diff);
+// Note: C++ port only, there is no Java equivalent.
+class ObjectStatistics {
+ public:
+  struct Entry {
+    Entry();
+
+    std::string type_name;
+    // Objects alive now.
+    int64_t live;
+    // Most objects alive at once since the type was first constructed or
+    // ResetPeaks() last ran.
+    int64_t peak;
+    // Objects constructed so far.
+    int64_t total;
+    // Memory of the live objects themselves, without the buffers and
+    // containers they own.
+    int64_t bytes;
+  };
+  typedef std::vector<Entry> EntryList;
+
+  // Whether this build counts objects at all.
+  static bool Enabled();
+
+  // Get the current counts of every type that has had an object constructed.
+  // @param snapshot receives the entries, sorted by type name
+  static void Snapshot(EntryList* snapshot);
+
+  // Start the peak of every type over from the objects alive now.
+  static void ResetPeaks();
+
+  // Get the changes from one snapshot to a later one. The peak of a diff
+  // entry is how much the peak has grown; with ResetPeaks() called right
+  // before the earlier snapshot, that is the most objects alive at once in
+  // between, less those alive at its start.
+  // @param before the earlier snapshot
+  // @param after the later snapshot
+  // @param diff receives the entries of the types whose counts changed,
+  //             sorted by type name
+  static void Diff(const EntryList& before,
+                   const EntryList& after,
+                   EntryList* diff);
+
+  // Get the entries with the most objects constructed first.
+  // @param entries the entries to sort
+  static void SortByTotal(EntryList* entries);
+};
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_OBJECT_STATISTICS_H_
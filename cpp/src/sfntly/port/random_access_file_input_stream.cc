@@ -0,0 +1,282 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined (WIN32)
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <limits.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "sfntly/port/random_access_file_input_stream.h"
+#include "sfntly/port/exception_type.h"
+
+namespace sfntly {
+
+#if defined (WIN32)
+static void* const kNoFile = NULL;
+#else
+static const int kNoFile = -1;
+#endif
+
+RandomAccessFileInputStream::RandomAccessFileInputStream()
+    : file_(kNoFile),
+      position_(0),
+      length_(0),
+      buffer_start_(0),
+      buffer_length_(0) {
+}
+
+RandomAccessFileInputStream::~RandomAccessFileInputStream() {
+  Close();
+}
+
+int32_t RandomAccessFileInputStream::Available() {
+  return (int32_t)std::min<int64_t>(length_ - position_, INT_MAX);
+}
+
+void RandomAccessFileInputStream::Close() {
+  if (file_ != kNoFile) {
+#if defined (WIN32)
+    CloseHandle(file_);
+#else
+    close(file_);
+#endif
+    file_ = kNoFile;
+    length_ = 0;
+    position_ = 0;
+    buffer_.clear();
+    buffer_start_ = 0;
+    buffer_length_ = 0;
+  }
+}
+
+void RandomAccessFileInputStream::Mark(int32_t readlimit) {
+  // NOP
+  UNREFERENCED_PARAMETER(readlimit);
+}
+
+bool RandomAccessFileInputStream::MarkSupported() {
+  return false;
+}
+
+int32_t RandomAccessFileInputStream::Read() {
+  if (file_ == kNoFile) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+    throw IOException("no opened file");
+#endif
+    return 0;
+  }
+  if (position_ >= length_ || !FillBuffer()) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+    throw IOException("eof reached");
+#endif
+    return 0;
+  }
+  return buffer_[(size_t)(position_++ - buffer_start_)];
+}
+
+int32_t RandomAccessFileInputStream::Read(ByteVector* b) {
+  return Read(b, 0, b->size());
+}
+
+int32_t RandomAccessFileInputStream::Read(ByteVector* b,
+                                          int32_t offset,
+                                          int32_t length) {
+  assert(b);
+  if (file_ == kNoFile) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+    throw IOException("no opened file");
+#endif
+    return 0;
+  }
+  int32_t read_count =
+      (int32_t)std::min<int64_t>(length_ - position_, std::max(length, 0));
+  if (read_count == 0) {
+    return 0;
+  }
+  if (b->size() < (size_t)(offset + read_count)) {
+    b->resize((size_t)(offset + read_count));
+  }
+  byte_t* dst = &((*b)[offset]);
+  int32_t total_read = 0;
+  while (total_read < read_count) {
+    int32_t remaining = read_count - total_read;
+    int32_t bytes_read = 0;
+    if (position_ >= buffer_start_ &&
+        position_ < buffer_start_ + buffer_length_) {
+      bytes_read = std::min<int32_t>(
+          remaining, (int32_t)(buffer_start_ + buffer_length_ - position_));
+      memcpy(dst + total_read,
+             &(buffer_[(size_t)(position_ - buffer_start_)]),
+             bytes_read);
+    } else if (remaining >= kReadAheadSize) {
+      // Large reads go straight to the caller's memory.
+      bytes_read = PRead(position_, dst + total_read, remaining);
+    } else if (FillBuffer()) {
+      continue;
+    }
+    if (bytes_read <= 0) {
+      break;
+    }
+    position_ += bytes_read;
+    total_read += bytes_read;
+  }
+  return total_read;
+}
+
+void RandomAccessFileInputStream::Reset() {
+  // NOP
+}
+
+int64_t RandomAccessFileInputStream::Skip(int64_t n) {
+  if (file_ == kNoFile) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+    throw IOException("no opened file");
+#endif
+    return 0;
+  }
+  int64_t skip_count = 0;
+  if (n < 0) {  // move backwards
+    skip_count = std::max<int64_t>(0 - position_, n);
+  } else {
+    skip_count = std::min<int64_t>(length_ - position_, n);
+  }
+  position_ += skip_count;
+  return skip_count;
+}
+
+void RandomAccessFileInputStream::Unread(ByteVector* b) {
+  Unread(b, 0, b->size());
+}
+
+void RandomAccessFileInputStream::Unread(ByteVector* b,
+                                         int32_t offset,
+                                         int32_t length) {
+  assert(b);
+  assert(b->size() >= size_t(offset + length));
+  UNREFERENCED_PARAMETER(b);
+  UNREFERENCED_PARAMETER(offset);
+  if (file_ == kNoFile) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+    throw IOException("no opened file");
+#endif
+    return;
+  }
+  // The bytes pushed back are the file's own, so only the position moves.
+  position_ -= std::min<int64_t>(position_, length);
+}
+
+bool RandomAccessFileInputStream::Open(const char* file_path) {
+  assert(file_path);
+  if (file_ != kNoFile) {
+    Close();
+  }
+#if defined (WIN32)
+  HANDLE file = CreateFileA(file_path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  LARGE_INTEGER size;
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    return false;
+  }
+  file_ = file;
+  length_ = size.QuadPart;
+#else
+  int file = open(file_path, O_RDONLY);
+  struct stat file_stat;
+  if (file == -1) {
+    return false;
+  }
+  if (fstat(file, &file_stat) == -1) {
+    close(file);
+    return false;
+  }
+  file_ = file;
+  length_ = file_stat.st_size;
+#endif
+  return true;
+}
+
+int32_t RandomAccessFileInputStream::ReadAt(int64_t position,
+                                            byte_t* b,
+                                            int32_t length) {
+  assert(b);
+  if (file_ == kNoFile) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+    throw IOException("no opened file");
+#endif
+    return 0;
+  }
+  if (position < 0 || position >= length_ || length <= 0) {
+    return 0;
+  }
+  return PRead(position, b, (int32_t)std::min<int64_t>(length,
+                                                       length_ - position));
+}
+
+int32_t RandomAccessFileInputStream::PRead(int64_t position,
+                                           byte_t* b,
+                                           int32_t length) {
+  int32_t total_read = 0;
+  while (total_read < length) {
+#if defined (WIN32)
+    OVERLAPPED overlapped;
+    memset(&overlapped, 0, sizeof(overlapped));
+    overlapped.Offset = (DWORD)(position + total_read);
+    overlapped.OffsetHigh = (DWORD)((position + total_read) >> 32);
+    DWORD bytes_read = 0;
+    if (!ReadFile(file_, b + total_read, length - total_read, &bytes_read,
+                  &overlapped) || bytes_read == 0) {
+      break;
+    }
+#else
+    ssize_t bytes_read = pread(file_, b + total_read, length - total_read,
+                               (off_t)(position + total_read));
+    if (bytes_read < 0 && errno == EINTR) {
+      continue;
+    }
+    if (bytes_read <= 0) {
+      break;
+    }
+#endif
+    total_read += (int32_t)bytes_read;
+  }
+  return total_read;
+}
+
+bool RandomAccessFileInputStream::FillBuffer() {
+  if (position_ >= buffer_start_ &&
+      position_ < buffer_start_ + buffer_length_) {
+    return true;
+  }
+  buffer_.resize(kReadAheadSize);
+  buffer_start_ = position_;
+  buffer_length_ = PRead(position_, &(buffer_[0]),
+      (int32_t)std::min<int64_t>(kReadAheadSize, length_ - position_));
+  return buffer_length_ > 0;
+}
+
+}  // namespace sfntly
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_RANDOM_ACCESS_FILE_INPUT_STREAM_H_
+#define SFNTLY_CPP_SRC_SFNTLY_PORT_RANDOM_ACCESS_FILE_INPUT_STREAM_H_
+
+#include "sfntly/port/input_stream.h"
+
+namespace sfntly {
+
+// A file input stream that reads the file with pread() in large blocks rather
+// than through stdio. Sequential reads are served from a read-ahead buffer,
+// so skipping and unreading only move the position. ReadAt() reads at an
+// absolute position without touching the stream position or the buffer and
+// may be called from several threads at once on one open file.
+// Note: C++ port only, there is no Java equivalent.
+class RandomAccessFileInputStream : public PushbackInputStream {
+ public:
+  static const int32_t kReadAheadSize = 64 * 1024;
+
+  RandomAccessFileInputStream();
+  virtual ~RandomAccessFileInputStream();
+
+  // InputStream methods
+  virtual int32_t Available();
+  virtual void Close();
+  virtual void Mark(int32_t readlimit);
+  virtual bool MarkSupported();
+  virtual int32_t Read();
+  virtual int32_t Read(ByteVector* b);
+  virtual int32_t Read(ByteVector* b, int32_t offset, int32_t length);
+  virtual void Reset();
+  virtual int64_t Skip(int64_t n);
+
+  // PushbackInputStream methods
+  virtual void Unread(ByteVector* b);
+  virtual void Unread(ByteVector* b, int32_t offset, int32_t length);
+
+  // Own methods
+  virtual bool Open(const char* file_path);
+
+  // Reads up to length bytes starting at the absolute position into b.
+  // Returns the number of bytes read, which is less than length only at the
+  // end of the file. Thread safe.
+  int32_t ReadAt(int64_t position, byte_t* b, int32_t length);
+
+  int64_t Length() { return length_; }
+  int64_t position() { return position_; }
+
+ private:
+  // Reads from the file with as many system calls as it takes.
+  int32_t PRead(int64_t position, byte_t* b, int32_t length);
+
+  // Refills the read-ahead buffer starting at the current position.
+  bool FillBuffer();
+
+#if defined (WIN32)
+  void* file_;
+#else
+  int file_;
+#endif
+  int64_t position_;
+  int64_t length_;
+  ByteVector buffer_;
+  int64_t buffer_start_;
+  int32_t buffer_length_;
+};
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_RANDOM_ACCESS_FILE_INPUT_STREAM_H_
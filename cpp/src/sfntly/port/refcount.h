@@ -62,6 +62,21 @@
 //    FooPtr end_scope_pointer;
 //    end_scope_pointer.Attach(passThrough);
 //    If you are not passing that object back, you are the end of scope.
+// 7. Reference counts are updated atomically so objects can be shared across
+//    threads. Programs which only ever use each object graph from one thread
+//    at a time can define SFNTLY_THREAD_CONFINED_REFCOUNT to use plain
+//    increments instead; they must then not use a ThreadPool, a FontCache or
+//    anything else that hands objects to other threads, and the headers of
+//    those do not compile in such builds. A class can also pick its policy
+//    with the second template argument of RefCounted.
+// 8. Every copy of a Ptr<> costs an AddRef() and a Release() later.  Ptr<> is
+//    moved without touching the count when the compiler supports rvalue
+//    references, which covers temporaries and growing containers.  Use swap()
+//    or Attach()/Detach() to hand a reference over explicitly, and a
+//    BorrowedPtr<> to refer to an object some Ptr<> keeps alive.
+// 9. Debug builds, and release builds configured with
+//    SFNTLY_OBJECT_STATISTICS, count the live, peak and total objects of every
+//    RefCounted type; see sfntly/port/object_statistics.h.
 
 #ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_REFCOUNT_H_
 #define SFNTLY_CPP_SRC_SFNTLY_PORT_REFCOUNT_H_
@@ -71,12 +86,17 @@
 //  #define REF_COUNT_DEBUGGING
 #endif
 
+#if !defined (NDEBUG) || defined (SFNTLY_OBJECT_STATISTICS)
+  #define ENABLE_OBJECT_STATISTICS
+#endif
+
 #if defined (REF_COUNT_DEBUGGING)
   #include <stdio.h>
   #include <typeinfo>
 #endif
 
 #include "sfntly/port/atomic.h"
+#include "sfntly/port/config.h"
 #include "sfntly/port/type.h"
 
 // Special tag for functions that requires caller to attach instead of using
@@ -119,7 +139,67 @@ class NoAddRefRelease : public T {
   virtual size_t Release() const = 0;
 };
 
-template <typename TDerived>
+#if defined (ENABLE_OBJECT_STATISTICS)
+// Object counts of one RefCounted type, constant initialized so that objects
+// can be counted at any time.  peak is the most objects live at once since
+// the type was registered or ObjectStatistics::ResetPeaks() last ran.
+struct ObjectTypeCounters {
+  size_t constructed;
+  size_t live;
+  size_t peak;
+  size_t registered;
+  size_t object_size;
+  const char* signature;
+  ObjectTypeCounters* next;
+};
+
+// Adds the counters of a type to the registry read by ObjectStatistics, once;
+// defined in object_statistics.cc.
+void RegisterObjectTypeCounters(ObjectTypeCounters* counters,
+                                const char* signature,
+                                size_t object_size);
+
+inline void CountObjectConstruction(ObjectTypeCounters* counters,
+                                    const char* signature,
+                                    size_t object_size) {
+  if (AtomicIncrement(&counters->constructed) == 1) {
+    RegisterObjectTypeCounters(counters, signature, object_size);
+  }
+  // Only an object making a new peak writes it.
+  size_t live = AtomicIncrement(&counters->live);
+  size_t peak = AtomicLoadAcquire(&counters->peak);
+  while (live > peak && !AtomicCompareAndSwap(&counters->peak, peak, live)) {
+    peak = AtomicLoadAcquire(&counters->peak);
+  }
+}
+
+inline void CountObjectDestruction(ObjectTypeCounters* counters) {
+  AtomicDecrement(&counters->live);
+}
+#endif
+
+// Reference count updates for objects which may be referenced from several
+// threads at once.
+struct AtomicRefCountPolicy {
+  static size_t Increment(size_t* count) { return AtomicIncrement(count); }
+  static size_t Decrement(size_t* count) { return AtomicDecrement(count); }
+};
+
+// Reference count updates for objects only ever referenced from one thread at
+// a time.
+struct ThreadConfinedRefCountPolicy {
+  static size_t Increment(size_t* count) { return ++(*count); }
+  static size_t Decrement(size_t* count) { return --(*count); }
+};
+
+#if defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+typedef ThreadConfinedRefCountPolicy DefaultRefCountPolicy;
+#else
+typedef AtomicRefCountPolicy DefaultRefCountPolicy;
+#endif
+
+template <typename TDerived,
+          typename RefCountPolicy = DefaultRefCountPolicy>
 class RefCounted : virtual public RefCount {
  public:
   RefCounted() : ref_count_(0) {
@@ -127,29 +207,41 @@ class RefCounted : virtual public RefCount {
     object_id_ = AtomicIncrement(&next_id_);
     AtomicIncrement(&object_counter_);
     DEBUG_OUTPUT("C ");
+#endif
+#if defined (ENABLE_OBJECT_STATISTICS)
+    CountObjectConstruction(&type_counters_, TypeSignature(),
+                            sizeof(TDerived));
+#endif
+  }
+  RefCounted(const RefCounted&) : ref_count_(0) {
+#if defined (ENABLE_OBJECT_STATISTICS)
+    CountObjectConstruction(&type_counters_, TypeSignature(),
+                            sizeof(TDerived));
 #endif
   }
-  RefCounted(const RefCounted<TDerived>&) : ref_count_(0) {}
   virtual ~RefCounted() {
 #if defined (ENABLE_OBJECT_COUNTER)
     AtomicDecrement(&object_counter_);
     DEBUG_OUTPUT("D ");
+#endif
+#if defined (ENABLE_OBJECT_STATISTICS)
+    CountObjectDestruction(&type_counters_);
 #endif
   }
 
-  RefCounted<TDerived>& operator=(const RefCounted<TDerived>&) {
+  RefCounted& operator=(const RefCounted&) {
     // Each object maintains own ref count, don't propagate.
     return *this;
   }
 
   virtual size_t AddRef() const {
-    size_t new_count = AtomicIncrement(&ref_count_);
+    size_t new_count = RefCountPolicy::Increment(&ref_count_);
     DEBUG_OUTPUT("A ");
     return new_count;
   }
 
   virtual size_t Release() const {
-    size_t new_ref_count = AtomicDecrement(&ref_count_);
+    size_t new_ref_count = RefCountPolicy::Decrement(&ref_count_);
     DEBUG_OUTPUT("R ");
     if (new_ref_count == 0) {
       // A C-style is used to cast away const-ness and to derived.
@@ -161,15 +253,37 @@ class RefCounted : virtual public RefCount {
 
   mutable size_t ref_count_;  // reference count of current object
 #if defined (ENABLE_OBJECT_COUNTER)
+  // Objects of a class may live on different threads whatever the policy, so
+  // these are always updated atomically.
   static size_t object_counter_;
   static size_t next_id_;
   mutable size_t object_id_;
 #endif
+#if defined (ENABLE_OBJECT_STATISTICS)
+  static ObjectTypeCounters type_counters_;
+
+  // A function signature naming TDerived, parsed into the type name when the
+  // statistics are read so that no RTTI is needed.
+  static const char* TypeSignature() {
+#if defined (_MSC_VER)
+    return __FUNCSIG__;
+#else
+    return __PRETTY_FUNCTION__;
+#endif
+  }
+#endif
 };
 
 #if defined (ENABLE_OBJECT_COUNTER)
-template <typename TDerived> size_t RefCounted<TDerived>::object_counter_ = 0;
-template <typename TDerived> size_t RefCounted<TDerived>::next_id_ = 0;
+template <typename TDerived, typename RefCountPolicy>
+size_t RefCounted<TDerived, RefCountPolicy>::object_counter_ = 0;
+template <typename TDerived, typename RefCountPolicy>
+size_t RefCounted<TDerived, RefCountPolicy>::next_id_ = 0;
+#endif
+#if defined (ENABLE_OBJECT_STATISTICS)
+// Zero initialized like all statics, before any code runs.
+template <typename TDerived, typename RefCountPolicy>
+ObjectTypeCounters RefCounted<TDerived, RefCountPolicy>::type_counters_;
 #endif
 
 // semi-smart pointer for RefCount derived objects, similar to CComPtr
@@ -189,6 +303,13 @@ class Ptr {
     *this = p;
   }
 
+#if defined (SFNTLY_HAS_RVALUE_REFERENCES)
+  // Takes over the reference of p, leaving it NULL.
+  Ptr(Ptr<T>&& p) noexcept : p_(p.p_) {
+    p.p_ = NULL;
+  }
+#endif
+
   ~Ptr() {
     Release();
   }
@@ -216,6 +337,18 @@ class Ptr {
     return operator=(p.p_);
   }
 
+#if defined (SFNTLY_HAS_RVALUE_REFERENCES)
+  T* operator=(Ptr<T>&& p) noexcept {
+    if (this != &p) {
+      Ptr<T> old;
+      old.p_ = p_;
+      p_ = p.p_;
+      p.p_ = NULL;
+    }
+    return p_;
+  }
+#endif
+
   operator T*&() {
     return p_;
   }
@@ -269,9 +402,57 @@ class Ptr {
     return pT;
   }
 
+  // Exchanges the objects of two pointers without touching reference counts.
+  void swap(Ptr<T>& p) {
+    T* pT = p_;
+    p_ = p.p_;
+    p.p_ = pT;
+  }
+
   mutable T* p_;
 };
 
+template <typename T>
+inline void swap(Ptr<T>& a, Ptr<T>& b) {
+  a.swap(b);
+}
+
+// Non-owning pointer to a RefCount derived object which some Ptr<> keeps
+// alive, for hot paths that would otherwise AddRef() and Release() a Ptr<>
+// around a few calls.  It never touches the reference count, so it must not
+// outlive the owning references; never Attach() a BorrowedPtr<> to a Ptr<>.
+template <typename T>
+class BorrowedPtr {
+ public:
+  BorrowedPtr() : p_(NULL) {
+  }
+
+  // These constructors shall not be explicit.
+  BorrowedPtr(T* pT) : p_(pT) {
+  }
+
+  BorrowedPtr(const Ptr<T>& p) : p_(p.p_) {
+  }
+
+  operator T*() const {
+    return p_;
+  }
+
+  T& operator*() const {
+    return *p_;
+  }
+
+  NoAddRefRelease<T>* operator->() const {
+    return (NoAddRefRelease<T>*)p_;
+  }
+
+  bool operator!() const {
+    return (p_ == NULL);
+  }
+
+  T* p_;
+};
+
 }  // namespace sfntly
 
 #endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_REFCOUNT_H_
@@ -0,0 +1,368 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/port/thread_pool.h"
+
+#include "sfntly/port/atomic.h"
+
+namespace sfntly {
+
+#if defined (WIN32)
+
+static void InitMutex(OSMutexType* mutex) {
+  ::InitializeCriticalSection(mutex);
+}
+static void DestroyMutex(OSMutexType* mutex) {
+  ::DeleteCriticalSection(mutex);
+}
+static void LockMutex(OSMutexType* mutex) { ::EnterCriticalSection(mutex); }
+static void UnlockMutex(OSMutexType* mutex) { ::LeaveCriticalSection(mutex); }
+
+static void InitCondition(OSConditionType* condition) {
+  ::InitializeConditionVariable(condition);
+}
+static void DestroyCondition(OSConditionType* condition) {
+  UNREFERENCED_PARAMETER(condition);
+}
+static void WaitCondition(OSConditionType* condition, OSMutexType* mutex) {
+  ::SleepConditionVariableCS(condition, mutex, INFINITE);
+}
+static void BroadcastCondition(OSConditionType* condition) {
+  ::WakeAllConditionVariable(condition);
+}
+
+#else  // We assume it's pthread
+
+static void InitMutex(OSMutexType* mutex) { pthread_mutex_init(mutex, NULL); }
+static void DestroyMutex(OSMutexType* mutex) { pthread_mutex_destroy(mutex); }
+static void LockMutex(OSMutexType* mutex) { pthread_mutex_lock(mutex); }
+static void UnlockMutex(OSMutexType* mutex) { pthread_mutex_unlock(mutex); }
+
+static void InitCondition(OSConditionType* condition) {
+  pthread_cond_init(condition, NULL);
+}
+static void DestroyCondition(OSConditionType* condition) {
+  pthread_cond_destroy(condition);
+}
+static void WaitCondition(OSConditionType* condition, OSMutexType* mutex) {
+  pthread_cond_wait(condition, mutex);
+}
+static void BroadcastCondition(OSConditionType* condition) {
+  pthread_cond_broadcast(condition);
+}
+
+#endif
+
+#if defined (WIN32)
+static bool StartThread(OSThreadType* thread,
+                        LPTHREAD_START_ROUTINE main,
+                        void* arg) {
+  *thread = ::CreateThread(NULL, 0, main, arg, 0, NULL);
+  return *thread != NULL;
+}
+static void JoinThread(OSThreadType thread) {
+  ::WaitForSingleObject(thread, INFINITE);
+  ::CloseHandle(thread);
+}
+#else
+static bool StartThread(OSThreadType* thread,
+                        void* (*main)(void*),
+                        void* arg) {
+  return pthread_create(thread, NULL, main, arg) == 0;
+}
+static void JoinThread(OSThreadType thread) { pthread_join(thread, NULL); }
+#endif
+
+/******************************************************************************
+ * ThreadPool class
+ ******************************************************************************/
+ThreadPool::ThreadPool(int32_t num_threads) : stopping_(false) {
+  InitMutex(&mutex_);
+  InitCondition(&task_available_);
+  InitCondition(&batch_done_);
+  for (int32_t i = 0; i < num_threads; ++i) {
+    OSThreadType thread;
+    if (!StartThread(&thread, ThreadMain, this)) {
+      break;
+    }
+    threads_.push_back(thread);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  LockMutex(&mutex_);
+  stopping_ = true;
+  BroadcastCondition(&task_available_);
+  UnlockMutex(&mutex_);
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    JoinThread(threads_[i]);
+  }
+  DestroyCondition(&batch_done_);
+  DestroyCondition(&task_available_);
+  DestroyMutex(&mutex_);
+}
+
+void ThreadPool::RunTasks(TaskList* tasks) {
+  assert(tasks);
+  if (tasks->empty()) {
+    return;
+  }
+  if (threads_.empty() || tasks->size() == 1) {
+    for (TaskList::iterator task = tasks->begin(), task_end = tasks->end();
+                            task != task_end; ++task) {
+      (*task)->Run();
+    }
+    return;
+  }
+
+  Batch batch;
+  batch.remaining = tasks->size();
+  LockMutex(&mutex_);
+  for (TaskList::iterator task = tasks->begin(), task_end = tasks->end();
+                          task != task_end; ++task) {
+    queue_.push_back(QueueEntry(*task, &batch));
+  }
+  BroadcastCondition(&task_available_);
+  // Help with the queued tasks, then wait for those still running elsewhere.
+  while (batch.remaining) {
+    if (!RunNextTask()) {
+      WaitCondition(&batch_done_, &mutex_);
+    }
+  }
+  UnlockMutex(&mutex_);
+}
+
+#if defined (WIN32)
+DWORD WINAPI ThreadPool::ThreadMain(LPVOID pool) {
+#else
+void* ThreadPool::ThreadMain(void* pool) {
+#endif
+  ThreadPool* self = static_cast<ThreadPool*>(pool);
+  LockMutex(&self->mutex_);
+  while (!self->stopping_) {
+    if (!self->RunNextTask()) {
+      WaitCondition(&self->task_available_, &self->mutex_);
+    }
+  }
+  UnlockMutex(&self->mutex_);
+  return 0;
+}
+
+bool ThreadPool::RunNextTask() {
+  if (queue_.empty()) {
+    return false;
+  }
+  QueueEntry entry = queue_.front();
+  queue_.pop_front();
+  UnlockMutex(&mutex_);
+  entry.first->Run();
+  LockMutex(&mutex_);
+  if (--entry.second->remaining == 0) {
+    BroadcastCondition(&batch_done_);
+  }
+  return true;
+}
+
+/******************************************************************************
+ * WorkStealingScheduler class
+ ******************************************************************************/
+SFNTLY_THREAD_LOCAL WorkStealingScheduler::Worker*
+    WorkStealingScheduler::current_worker_ = NULL;
+
+// Counts updated atomically are read with a full barrier as well, so that
+// whatever the tasks of a batch did is visible to the thread that handed it
+// over once it reads zero.
+static bool IsZero(size_t* count) {
+  return AtomicCompareAndSwap(count, 0, 0);
+}
+
+WorkStealingScheduler::WorkStealingScheduler(int32_t num_threads)
+    : queued_(0), sleepers_(0), next_queue_(0), steals_(0), stopping_(false) {
+  InitMutex(&mutex_);
+  InitCondition(&state_changed_);
+  // Workers sleep until a task is queued, so they do not look at the other
+  // workers before all of them are set up.
+  for (int32_t i = 0; i < num_threads; ++i) {
+    Worker* worker = new Worker;
+    worker->scheduler = this;
+    worker->index = workers_.size();
+    InitMutex(&worker->mutex);
+    if (!StartThread(&worker->thread, ThreadMain, worker)) {
+      DestroyMutex(&worker->mutex);
+      delete worker;
+      break;
+    }
+    workers_.push_back(worker);
+  }
+}
+
+WorkStealingScheduler::~WorkStealingScheduler() {
+  LockMutex(&mutex_);
+  stopping_ = true;
+  BroadcastCondition(&state_changed_);
+  UnlockMutex(&mutex_);
+  // Idle workers look into the queues of the others until they are joined.
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    JoinThread(workers_[i]->thread);
+  }
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    DestroyMutex(&workers_[i]->mutex);
+    delete workers_[i];
+  }
+  DestroyCondition(&state_changed_);
+  DestroyMutex(&mutex_);
+}
+
+void WorkStealingScheduler::RunTasks(TaskList* tasks) {
+  assert(tasks);
+  if (tasks->empty()) {
+    return;
+  }
+  if (workers_.empty() || tasks->size() == 1) {
+    for (TaskList::iterator task = tasks->begin(), task_end = tasks->end();
+                            task != task_end; ++task) {
+      (*task)->Run();
+    }
+    return;
+  }
+
+  Worker* self = current_worker_;
+  if (self != NULL && self->scheduler != this) {
+    self = NULL;
+  }
+  Batch batch;
+  batch.remaining = tasks->size();
+  if (self != NULL) {
+    LockMutex(&self->mutex);
+    for (TaskList::iterator task = tasks->begin(), task_end = tasks->end();
+                            task != task_end; ++task) {
+      self->queue.push_back(QueueEntry(*task, &batch));
+      AtomicIncrement(&queued_);
+    }
+    UnlockMutex(&self->mutex);
+  } else {
+    size_t first = AtomicIncrement(&next_queue_);
+    for (size_t i = 0; i < tasks->size(); ++i) {
+      Worker* worker = workers_[(first + i) % workers_.size()];
+      LockMutex(&worker->mutex);
+      worker->queue.push_back(QueueEntry(tasks->at(i), &batch));
+      AtomicIncrement(&queued_);
+      UnlockMutex(&worker->mutex);
+    }
+  }
+  WakeUpSleepers();
+
+  // Help with the queued tasks, of this batch or any other, then wait for
+  // those still running elsewhere.
+  while (!IsZero(&batch.remaining)) {
+    QueueEntry entry;
+    if (TakeTask(self, &entry)) {
+      RunTask(entry);
+      continue;
+    }
+    LockMutex(&mutex_);
+    AtomicIncrement(&sleepers_);
+    while (!IsZero(&batch.remaining) && IsZero(&queued_)) {
+      WaitCondition(&state_changed_, &mutex_);
+    }
+    AtomicDecrement(&sleepers_);
+    UnlockMutex(&mutex_);
+  }
+}
+
+#if defined (WIN32)
+DWORD WINAPI WorkStealingScheduler::ThreadMain(LPVOID worker) {
+#else
+void* WorkStealingScheduler::ThreadMain(void* worker) {
+#endif
+  Worker* self = static_cast<Worker*>(worker);
+  WorkStealingScheduler* scheduler = self->scheduler;
+  current_worker_ = self;
+  while (true) {
+    LockMutex(&scheduler->mutex_);
+    AtomicIncrement(&scheduler->sleepers_);
+    while (!scheduler->stopping_ && IsZero(&scheduler->queued_)) {
+      WaitCondition(&scheduler->state_changed_, &scheduler->mutex_);
+    }
+    AtomicDecrement(&scheduler->sleepers_);
+    bool stopping = scheduler->stopping_;
+    UnlockMutex(&scheduler->mutex_);
+    if (stopping) {
+      break;
+    }
+    QueueEntry entry;
+    while (scheduler->TakeTask(self, &entry)) {
+      scheduler->RunTask(entry);
+    }
+  }
+  current_worker_ = NULL;
+  return 0;
+}
+
+bool WorkStealingScheduler::TakeTask(Worker* self, QueueEntry* entry) {
+  if (self != NULL) {
+    LockMutex(&self->mutex);
+    if (!self->queue.empty()) {
+      *entry = self->queue.back();
+      self->queue.pop_back();
+      AtomicDecrement(&queued_);
+      UnlockMutex(&self->mutex);
+      return true;
+    }
+    UnlockMutex(&self->mutex);
+  }
+  size_t first = self ? self->index + 1 : 0;
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    Worker* victim = workers_[(first + i) % workers_.size()];
+    if (victim == self) {
+      continue;
+    }
+    LockMutex(&victim->mutex);
+    if (!victim->queue.empty()) {
+      *entry = victim->queue.front();
+      victim->queue.pop_front();
+      AtomicDecrement(&queued_);
+      UnlockMutex(&victim->mutex);
+      if (self != NULL) {
+        AtomicIncrement(&steals_);
+      }
+      return true;
+    }
+    UnlockMutex(&victim->mutex);
+  }
+  return false;
+}
+
+void WorkStealingScheduler::RunTask(const QueueEntry& entry) {
+  entry.first->Run();
+  // The batch may be gone as soon as its count drops to zero.
+  if (AtomicDecrement(&entry.second->remaining) == 0) {
+    WakeUpSleepers();
+  }
+}
+
+void WorkStealingScheduler::WakeUpSleepers() {
+  // A thread going to sleep counts itself before it checks the counts it
+  // waits on, and the counts are changed before this is called, so either
+  // the thread sees the change or it is seen here.
+  if (!IsZero(&sleepers_)) {
+    LockMutex(&mutex_);
+    BroadcastCondition(&state_changed_);
+    UnlockMutex(&mutex_);
+  }
+}
+
+}  // namespace sfntly
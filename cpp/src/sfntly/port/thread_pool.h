@@ -0,0 +1,186 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_THREAD_POOL_H_
+#define SFNTLY_CPP_SRC_SFNTLY_PORT_THREAD_POOL_H_
+
+#if defined (WIN32)
+#include <windows.h>
+#else  // Assume pthread.
+#include <pthread.h>
+#endif
+
+#include <deque>
+#include <vector>
+
+#include "sfntly/port/config.h"
+#include "sfntly/port/executor.h"
+#include "sfntly/port/refcount.h"
+#include "sfntly/port/type.h"
+
+// Tasks on the worker threads share objects with the thread handing over the
+// batch, which plain reference counts do not allow; see refcount.h.
+#if defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+#error "ThreadPool and WorkStealingScheduler need atomic reference counts"
+#endif
+
+namespace sfntly {
+
+#if defined (WIN32)
+  typedef HANDLE OSThreadType;
+  typedef CRITICAL_SECTION OSMutexType;
+  typedef CONDITION_VARIABLE OSConditionType;
+#else  // Assume pthread.
+  typedef pthread_t OSThreadType;
+  typedef pthread_mutex_t OSMutexType;
+  typedef pthread_cond_t OSConditionType;
+#endif
+
+// A fixed set of worker threads that run tasks handed to them in batches. The
+// thread handing over a batch works on it as well and only returns once every
+// task of the batch has run, so a pool without threads runs all tasks inline.
+// Several threads may hand over batches at the same time. All workers share
+// one queue, which suits a few coarse tasks such as the tables of a font.
+// Note: C++ port only, there is no Java equivalent.
+class ThreadPool : public Executor,
+                   public RefCounted<ThreadPool, AtomicRefCountPolicy> {
+ public:
+  // Start the worker threads. Threads that cannot be started are left out.
+  // @param num_threads the number of worker threads
+  explicit ThreadPool(int32_t num_threads);
+
+  // Stop and join the worker threads. No batch may be running.
+  virtual ~ThreadPool();
+
+  // Get the number of worker threads running.
+  virtual int32_t num_threads() { return (int32_t)threads_.size(); }
+
+  // Run the tasks and wait for all of them to finish. The tasks are owned by
+  // the caller.
+  // @param tasks the tasks to run; may run in any order and concurrently
+  virtual void RunTasks(TaskList* tasks);
+
+ private:
+  struct Batch {
+    size_t remaining;
+  };
+  typedef std::pair<Task*, Batch*> QueueEntry;
+
+#if defined (WIN32)
+  static DWORD WINAPI ThreadMain(LPVOID pool);
+#else
+  static void* ThreadMain(void* pool);
+#endif
+
+  // Take the next task off the queue and run it; the mutex must be held and
+  // is held again on return. Returns false if the queue is empty.
+  bool RunNextTask();
+
+  std::vector<OSThreadType> threads_;
+  OSMutexType mutex_;
+  OSConditionType task_available_;
+  OSConditionType batch_done_;
+  std::deque<QueueEntry> queue_;
+  bool stopping_;
+
+  NO_COPY_AND_ASSIGN(ThreadPool);
+};
+typedef Ptr<ThreadPool> ThreadPoolPtr;
+
+// A fixed set of worker threads, each with a queue of its own. A batch handed
+// over by a worker, e.g. by a task splitting its work further, goes to the
+// queue of that worker, which runs the most recently queued task first while
+// idle workers steal the oldest tasks from the other queues. Batches from
+// other threads are spread over all queues. This keeps many small or nested
+// tasks from contending for one lock. As with ThreadPool the thread handing
+// over a batch works on it too, so nested batches cannot deadlock.
+// Note: C++ port only, there is no Java equivalent.
+class WorkStealingScheduler
+    : public Executor,
+      public RefCounted<WorkStealingScheduler, AtomicRefCountPolicy> {
+ public:
+  // Start the worker threads. Threads that cannot be started are left out.
+  // @param num_threads the number of worker threads
+  explicit WorkStealingScheduler(int32_t num_threads);
+
+  // Stop and join the worker threads. No batch may be running.
+  virtual ~WorkStealingScheduler();
+
+  // Get the number of worker threads running.
+  virtual int32_t num_threads() { return (int32_t)workers_.size(); }
+
+  // Run the tasks and wait for all of them to finish. The tasks are owned by
+  // the caller.
+  // @param tasks the tasks to run; may run in any order and concurrently
+  virtual void RunTasks(TaskList* tasks);
+
+  // Get the number of tasks workers took from the queues of other workers.
+  size_t steals() { return steals_; }
+
+ private:
+  struct Batch {
+    size_t remaining;
+  };
+  typedef std::pair<Task*, Batch*> QueueEntry;
+
+  struct Worker {
+    WorkStealingScheduler* scheduler;
+    size_t index;
+    OSThreadType thread;
+    OSMutexType mutex;
+    std::deque<QueueEntry> queue;
+  };
+
+#if defined (WIN32)
+  static DWORD WINAPI ThreadMain(LPVOID worker);
+#else
+  static void* ThreadMain(void* worker);
+#endif
+
+  // Take a task off the back of the queue of self, if any, or else off the
+  // front of another queue. Returns false if all queues are empty.
+  // @param self the worker of the calling thread; NULL for other threads
+  bool TakeTask(Worker* self, QueueEntry* entry);
+
+  // Run a task taken and wake up the threads waiting if its batch is done.
+  void RunTask(const QueueEntry& entry);
+
+  // Wake up the threads waiting for tasks or batches, if there are any.
+  void WakeUpSleepers();
+
+  // The worker running on this thread, of whichever scheduler.
+  static SFNTLY_THREAD_LOCAL Worker* current_worker_;
+
+  std::vector<Worker*> workers_;
+  // Guards stopping_ and the waits for tasks and for batches to finish.
+  OSMutexType mutex_;
+  OSConditionType state_changed_;
+  // The number of tasks in all queues and of the threads waiting, updated
+  // atomically.
+  size_t queued_;
+  size_t sleepers_;
+  // The queue the next batch from a thread other than a worker starts at.
+  size_t next_queue_;
+  size_t steals_;
+  bool stopping_;
+
+  NO_COPY_AND_ASSIGN(WorkStealingScheduler);
+};
+typedef Ptr<WorkStealingScheduler> WorkStealingSchedulerPtr;
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_THREAD_POOL_H_
@@ -20,6 +20,7 @@
 #include <stdlib.h>
 
 #include "sfntly/math/font_math.h"
+#include "sfntly/port/atomic.h"
 #include "sfntly/table/bitmap/eblc_table.h"
 #include "sfntly/table/bitmap/index_sub_table_format1.h"
 #include "sfntly/table/bitmap/index_sub_table_format2.h"
@@ -118,7 +119,8 @@ int32_t BitmapSizeTable::GlyphFormat(int32_t glyph_id) {
 
 BitmapSizeTable::BitmapSizeTable(ReadableFontData* data,
                                  ReadableFontData* master_data)
-    : SubTable(data, master_data) {
+    : SubTable(data, master_data),
+      index_subtables_set_(0) {
 }
 
 // static
@@ -180,13 +182,16 @@ IndexSubTable* BitmapSizeTable::CreateIndexSubTable(int32_t index) {
 }
 
 IndexSubTableList* BitmapSizeTable::GetIndexSubTableList() {
+  if (AtomicLoadAcquire(&index_subtables_set_)) {
+    return &index_subtables_;
+  }
   AutoLock lock(index_subtables_lock_);
-  if (index_subtables_.empty()) {
+  if (!index_subtables_set_) {
     for (int32_t i = 0; i < NumberOfIndexSubTables(); ++i) {
-      IndexSubTablePtr table;
-      table.Attach(CreateIndexSubTable(i));
-      index_subtables_.push_back(table);
+      index_subtables_.push_back(IndexSubTablePtr());
+      index_subtables_.back().Attach(CreateIndexSubTable(i));
     }
+    AtomicStoreRelease(&index_subtables_set_, 1);
   }
   return &index_subtables_;
 }
@@ -377,7 +382,7 @@ void BitmapSizeTable::Builder::GenerateLocaMap(BitmapGlyphInfoMap* output) {
   while (it->HasNext()) {
     BitmapGlyphInfoPtr info;
     info.Attach(it->Next());
-    (*output)[info->glyph_id()] = info;
+    (*output)[info->glyph_id()].swap(info);
   }
 }
 
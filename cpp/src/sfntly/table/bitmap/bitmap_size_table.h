@@ -160,7 +160,11 @@ class BitmapSizeTable : public SubTable,
   CALLER_ATTACH IndexSubTable* CreateIndexSubTable(int32_t index);
   IndexSubTableList* GetIndexSubTableList();
 
+  // Guards creating the index subtables. index_subtables_set_ is published
+  // with release semantics once the list is filled, so lookups that see it
+  // set skip the lock.
   Lock index_subtables_lock_;
+  int32_t index_subtables_set_;
   IndexSubTableList index_subtables_;
 };
 typedef Ptr<BitmapSizeTable> BitmapSizeTablePtr;
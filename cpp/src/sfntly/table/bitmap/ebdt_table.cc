@@ -143,15 +143,15 @@ void EbdtTable::Builder::GenerateLocaList(BitmapLocaList* output) {
                                          glyph_end = builder_map->end();
                                          glyph_entry != glyph_end;
                                          glyph_entry++) {
-      BitmapGlyphBuilderPtr builder = glyph_entry->second;
+      BorrowedPtr<BitmapGlyph::Builder> builder = glyph_entry->second;
       int32_t size = builder->SubDataSizeToSerialize();
-      BitmapGlyphInfoPtr info = new BitmapGlyphInfo(glyph_entry->first,
+      new_loca_map[glyph_entry->first] = new BitmapGlyphInfo(glyph_entry->first,
           start_offset + glyph_offset, size, builder->format());
-      new_loca_map[glyph_entry->first] = info;
       glyph_offset += size;
     }
     start_offset += glyph_offset;
-    output->push_back(new_loca_map);
+    output->push_back(BitmapGlyphInfoMap());
+    output->back().swap(new_loca_map);
   }
 }
 
@@ -219,16 +219,15 @@ void EbdtTable::Builder::Initialize(ReadableFontData* data,
       for (BitmapGlyphInfoMap::iterator entry = loca_map->begin(),
                                         entry_end = loca_map->end();
                                         entry != entry_end; entry++) {
-        BitmapGlyphInfoPtr info = entry->second;
+        BorrowedPtr<BitmapGlyphInfo> info = entry->second;
         ReadableFontDataPtr slice;
         slice.Attach(down_cast<ReadableFontData*>(data->Slice(
             info->offset(), info->length())));
-        BitmapGlyphBuilderPtr glyph_builder;
-        glyph_builder.Attach(BitmapGlyph::Builder::CreateGlyphBuilder(
-            slice, info->format()));
-        glyph_builder_map[entry->first] = glyph_builder;
+        glyph_builder_map[entry->first].Attach(
+            BitmapGlyph::Builder::CreateGlyphBuilder(slice, info->format()));
       }
-      output->push_back(glyph_builder_map);
+      output->push_back(BitmapGlyphBuilderMap());
+      output->back().swap(glyph_builder_map);
     }
   }
 }
@@ -99,6 +99,7 @@ class EbdtTable : public SubTableContainerTable,
                                    int32_t format);
  protected:
   EbdtTable(Header* header, ReadableFontData* data);
+  friend class Table;
 };
 typedef Ptr<EbdtTable> EbdtTablePtr;
 typedef Ptr<EbdtTable::Builder> EbdtTableBuilderPtr;
@@ -20,6 +20,7 @@
 #include <stdlib.h>
 
 #include "sfntly/math/font_math.h"
+#include "sfntly/port/atomic.h"
 
 namespace sfntly {
 /******************************************************************************
@@ -49,13 +50,18 @@ BitmapSizeTable* EblcTable::GetBitmapSizeTable(int32_t index) {
 }
 
 EblcTable::EblcTable(Header* header, ReadableFontData* data)
-    : SubTableContainerTable(header, data) {
+    : SubTableContainerTable(header, data),
+      bitmap_size_table_set_(0) {
 }
 
 BitmapSizeTableList* EblcTable::GetBitmapSizeTableList() {
+  if (AtomicLoadAcquire(&bitmap_size_table_set_)) {
+    return &bitmap_size_table_;
+  }
   AutoLock lock(bitmap_size_table_lock_);
-  if (bitmap_size_table_.empty()) {
+  if (!bitmap_size_table_set_) {
     CreateBitmapSizeTable(data_, NumSizes(), &bitmap_size_table_);
+    AtomicStoreRelease(&bitmap_size_table_set_, 1);
   }
   return &bitmap_size_table_;
 }
@@ -75,9 +81,8 @@ void EblcTable::CreateBitmapSizeTable(ReadableFontData* data,
     BitmapSizeTableBuilderPtr size_builder;
     size_builder.Attach(
         BitmapSizeTable::Builder::CreateBuilder(new_data, data));
-    BitmapSizeTablePtr size;
-    size.Attach(down_cast<BitmapSizeTable*>(size_builder->Build()));
-    output->push_back(size);
+    output->push_back(BitmapSizeTablePtr());
+    output->back().Attach(down_cast<BitmapSizeTable*>(size_builder->Build()));
   }
 }
 
@@ -257,9 +262,8 @@ void EblcTable::Builder::GenerateLocaList(BitmapLocaList* output) {
 #if defined (SFNTLY_DEBUG_BITMAP)
     fprintf(stderr, "size table = %d\n", size_index++);
 #endif
-    BitmapGlyphInfoMap loca_map;
-    (*b)->GenerateLocaMap(&loca_map);
-    output->push_back(loca_map);
+    output->push_back(BitmapGlyphInfoMap());
+    (*b)->GenerateLocaMap(&(output->back()));
   }
 }
 
@@ -302,10 +306,9 @@ void EblcTable::Builder::Initialize(ReadableFontData* data,
           data->Slice(Offset::kBitmapSizeTableArrayStart +
                       i * Offset::kBitmapSizeTableLength,
                       Offset::kBitmapSizeTableLength)));
-      BitmapSizeTableBuilderPtr size_builder;
-      size_builder.Attach(BitmapSizeTable::Builder::CreateBuilder(
+      output->push_back(BitmapSizeTableBuilderPtr());
+      output->back().Attach(BitmapSizeTable::Builder::CreateBuilder(
           new_data, data));
-      output->push_back(size_builder);
     }
   }
 }
@@ -176,6 +176,7 @@ class EblcTable : public SubTableContainerTable,
 
  protected:
   EblcTable(Header* header, ReadableFontData* data);
+  friend class Table;
 
  private:
   BitmapSizeTableList* GetBitmapSizeTableList();
@@ -184,7 +185,10 @@ class EblcTable : public SubTableContainerTable,
                                     int32_t num_sizes,
                                     BitmapSizeTableList* output);
 
+  // Guards creating the size tables, published like
+  // BitmapSizeTable::index_subtables_set_.
   Lock bitmap_size_table_lock_;
+  int32_t bitmap_size_table_set_;
   BitmapSizeTableList bitmap_size_table_;
 };
 typedef Ptr<EblcTable> EblcTablePtr;
@@ -91,6 +91,7 @@ class EbscTable : public Table,
 
  private:
   EbscTable(Header* header, ReadableFontData* data);
+  friend class Table;
   friend class Builder;
 };
 typedef Ptr<EbscTable> EbscTablePtr;
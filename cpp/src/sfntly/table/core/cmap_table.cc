@@ -977,20 +977,32 @@ void CMapTable::CMapFormat4::Builder::Initialize(ReadableFontData* data) {
   if (data == NULL || data->Length() == 0)
     return;
 
-  // build segments
+  // build segments, decoding each of the parallel segment arrays in one pass
   int32_t seg_count = CMapFormat4::SegCount(data);
-  for (int32_t index = 0; index < seg_count; ++index) {
-    Ptr<Segment> segment = new Segment;
-    segment->set_start_count(CMapFormat4::StartCode(data, seg_count, index));
+  if (seg_count > 0) {
+    std::vector<uint16_t> end_codes(seg_count);
+    std::vector<uint16_t> start_codes(seg_count);
+    std::vector<uint16_t> id_deltas(seg_count);
+    std::vector<uint16_t> id_range_offsets(seg_count);
+    data->ReadUShortArray(Offset::kFormat4EndCount, seg_count,
+                          &(end_codes[0]));
+    data->ReadUShortArray(CMapFormat4::StartCodeOffset(seg_count), seg_count,
+                          &(start_codes[0]));
+    data->ReadUShortArray(CMapFormat4::IdDeltaOffset(seg_count), seg_count,
+                          &(id_deltas[0]));
+    data->ReadUShortArray(CMapFormat4::IdRangeOffsetOffset(seg_count),
+                          seg_count, &(id_range_offsets[0]));
+    for (int32_t index = 0; index < seg_count; ++index) {
+      Ptr<Segment> segment = new Segment;
+      segment->set_start_count(start_codes[index]);
 #if defined SFNTLY_DEBUG_CMAP
-    fprintf(stderr, "Segment %d; start %d\n", index, segment->start_count());
+      fprintf(stderr, "Segment %d; start %d\n", index, segment->start_count());
 #endif
-    segment->set_end_count(CMapFormat4::EndCode(data, seg_count, index));
-    segment->set_id_delta(CMapFormat4::IdDelta(data, seg_count, index));
-    segment->set_id_range_offset(CMapFormat4::IdRangeOffset(data,
-                                                           seg_count,
-                                                           index));
-    segments_.push_back(segment);
+      segment->set_end_count(end_codes[index]);
+      segment->set_id_delta(id_deltas[index]);
+      segment->set_id_range_offset(id_range_offsets[index]);
+      segments_.push_back(segment);
+    }
   }
 
   // build glyph id array
@@ -998,9 +1010,15 @@ void CMapTable::CMapFormat4::Builder::Initialize(ReadableFontData* data) {
   int32_t glyph_id_array_length =
       (CMapFormat4::Length(data) - glyph_id_array_offset)
       / DataSize::kUSHORT;
+#if defined SFNTLY_DEBUG_CMAP
   fprintf(stderr, "id array size %d\n", glyph_id_array_length);
-  for (int32_t i = 0; i < glyph_id_array_length; i += DataSize::kUSHORT) {
-    glyph_id_array_.push_back(data->ReadUShort(glyph_id_array_offset + i));
+#endif
+  if (glyph_id_array_length > 0) {
+    std::vector<uint16_t> glyph_ids(glyph_id_array_length);
+    int32_t count = data->ReadUShortArray(glyph_id_array_offset,
+                                          glyph_id_array_length,
+                                          &(glyph_ids[0]));
+    glyph_id_array_.assign(glyph_ids.begin(), glyph_ids.begin() + count);
   }
 }
 
@@ -1083,28 +1101,39 @@ CMapTable::CMapFormat4::Builder::SubSerialize(WritableFontData* new_data) {
   int32_t range_shift = 2 * seg_count - search_range;
   index += new_data->WriteUShort(index, range_shift);
 
+  // The segment fields are laid out as parallel arrays (with a reserved
+  // ushort after the end codes); gather each and write it in one pass.
+  std::vector<uint16_t> values(seg_count + 1);
   for (int32_t i = 0; i < seg_count; ++i) {
-    index += new_data->WriteUShort(index, segments_[i]->end_count());
+    values[i] = (uint16_t)segments_[i]->end_count();
   }
-  index += new_data->WriteUShort(index, 0);  // reserved ushort
-  for (int32_t i = 0; i < seg_count; ++i) {
+  values[seg_count] = 0;  // reserved ushort
+  index += new_data->WriteUShortArray(index, &(values[0]), seg_count + 1);
+  if (seg_count > 0) {
+    for (int32_t i = 0; i < seg_count; ++i) {
 #if defined SFNTLY_DEBUG_CMAP
-    fprintf(stderr, "Segment %d; start %d\n", i, segments_[i]->start_count());
+      fprintf(stderr, "Segment %d; start %d\n", i, segments_[i]->start_count());
 #endif
-    index += new_data->WriteUShort(index, segments_[i]->start_count());
-  }
-  for (int32_t i = 0; i < seg_count; ++i) {
-    index += new_data->WriteShort(index, segments_[i]->id_delta());
-  }
-  for (int32_t i = 0; i < seg_count; ++i) {
-    index += new_data->WriteUShort(index, segments_[i]->id_range_offset());
+      values[i] = (uint16_t)segments_[i]->start_count();
+    }
+    index += new_data->WriteUShortArray(index, &(values[0]), seg_count);
+    for (int32_t i = 0; i < seg_count; ++i) {
+      values[i] = (uint16_t)segments_[i]->id_delta();
+    }
+    index += new_data->WriteUShortArray(index, &(values[0]), seg_count);
+    for (int32_t i = 0; i < seg_count; ++i) {
+      values[i] = (uint16_t)segments_[i]->id_range_offset();
+    }
+    index += new_data->WriteUShortArray(index, &(values[0]), seg_count);
   }
 
 #if defined SFNTLY_DEBUG_CMAP
   fprintf(stderr, "Glyph id array size %lu\n", glyph_id_array_.size());
 #endif
-  for (size_t i = 0; i < glyph_id_array_.size(); ++i) {
-    index += new_data->WriteUShort(index, glyph_id_array_[i]);
+  if (!glyph_id_array_.empty()) {
+    values.assign(glyph_id_array_.begin(), glyph_id_array_.end());
+    index += new_data->WriteUShortArray(index, &(values[0]),
+                                        (int32_t)values.size());
   }
 
   new_data->WriteUShort(Offset::kFormat4Length, index);
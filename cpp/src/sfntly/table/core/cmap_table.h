@@ -698,6 +698,7 @@ public:
   };
 
   CMapTable(Header* header, ReadableFontData* data);
+  friend class Table;
 
   // Get the offset in the table data for the encoding record for the cmap with
   // the given index. The offset is from the beginning of the table.
@@ -159,6 +159,7 @@ class FontHeaderTable : public Table, public RefCounted<FontHeaderTable> {
   };
 
   FontHeaderTable(Header* header, ReadableFontData* data);
+  friend class Table;
 };
 typedef Ptr<FontHeaderTable> FontHeaderTablePtr;
 typedef Ptr<FontHeaderTable::Builder> FontHeaderTableBuilderPtr;
@@ -71,6 +71,7 @@ class HorizontalDeviceMetricsTable
   HorizontalDeviceMetricsTable(Header* header,
                                ReadableFontData* data,
                                int32_t num_glyphs);
+  friend class Table;
 
   int32_t num_glyphs_;
 };
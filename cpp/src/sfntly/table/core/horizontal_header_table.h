@@ -102,6 +102,7 @@ class HorizontalHeaderTable : public Table,
   };
 
   HorizontalHeaderTable(Header* header, ReadableFontData* data);
+  friend class Table;
 };
 typedef Ptr<HorizontalHeaderTable> HorizontalHeaderTablePtr;
 typedef Ptr<HorizontalHeaderTable::Builder> HorizontalHeaderTableBuilderPtr;
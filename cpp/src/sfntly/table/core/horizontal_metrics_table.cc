@@ -15,6 +15,10 @@
  */
 
 #include "sfntly/table/core/horizontal_metrics_table.h"
+
+#include <algorithm>
+#include <vector>
+
 #include "sfntly/port/exception_type.h"
 
 namespace sfntly {
@@ -32,27 +36,20 @@ int32_t HorizontalMetricsTable::NumberOfLSBs() {
 }
 
 int32_t HorizontalMetricsTable::HMetricAdvanceWidth(int32_t entry) {
-  if (entry > num_hmetrics_) {
-#if !defined (SFNTLY_NO_EXCEPTION)
-    throw IndexOutOfBoundException();
-#endif
+  uint16_t hmetric[2];
+  if (!ReadHMetric(entry, hmetric)) {
     return 0;
   }
-  int32_t offset = Offset::kHMetricsStart + (entry * Offset::kHMetricsSize) +
-                   Offset::kHMetricsAdvanceWidth;
-  return data_->ReadUShort(offset);
+  return hmetric[Offset::kHMetricsAdvanceWidth / DataSize::kUSHORT];
 }
 
 int32_t HorizontalMetricsTable::HMetricLSB(int32_t entry) {
-  if (entry > num_hmetrics_) {
-#if !defined (SFNTLY_NO_EXCEPTION)
-    throw IndexOutOfBoundException();
-#endif
+  uint16_t hmetric[2];
+  if (!ReadHMetric(entry, hmetric)) {
     return 0;
   }
-  int32_t offset = Offset::kHMetricsStart + (entry * Offset::kHMetricsSize) +
-                   Offset::kHMetricsLeftSideBearing;
-  return data_->ReadShort(offset);
+  return static_cast<int16_t>(
+      hmetric[Offset::kHMetricsLeftSideBearing / DataSize::kUSHORT]);
 }
 
 int32_t HorizontalMetricsTable::LsbTableEntry(int32_t entry) {
@@ -81,6 +78,45 @@ int32_t HorizontalMetricsTable::LeftSideBearing(int32_t glyph_id) {
   return LsbTableEntry(glyph_id - num_hmetrics_);
 }
 
+int32_t HorizontalMetricsTable::HMetrics(int32_t entry,
+                                         int32_t count,
+                                         IntegerList* advance_widths,
+                                         IntegerList* lsbs) {
+  assert(advance_widths);
+  assert(lsbs);
+  advance_widths->clear();
+  lsbs->clear();
+  if (entry < 0 || count <= 0 || entry >= num_hmetrics_) {
+    return 0;
+  }
+  count = std::min<int32_t>(count, num_hmetrics_ - entry);
+  // Each hMetric is an (advance width, lsb) pair of 16-bit values.
+  std::vector<uint16_t> values(2 * count);
+  int32_t read = data_->ReadUShortArray(
+      Offset::kHMetricsStart + entry * Offset::kHMetricsSize, 2 * count,
+      &(values[0])) / 2;
+  advance_widths->resize(read);
+  lsbs->resize(read);
+  for (int32_t i = 0; i < read; ++i) {
+    (*advance_widths)[i] = values[2 * i];
+    (*lsbs)[i] = static_cast<int16_t>(values[2 * i + 1]);
+  }
+  return read;
+}
+
+bool HorizontalMetricsTable::ReadHMetric(int32_t entry, uint16_t* hmetric) {
+  if (entry > num_hmetrics_ ||
+      data_->ReadUShortArray(
+          Offset::kHMetricsStart + entry * Offset::kHMetricsSize, 2,
+          hmetric) != 2) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+    throw IndexOutOfBoundException();
+#endif
+    return false;
+  }
+  return true;
+}
+
 HorizontalMetricsTable::HorizontalMetricsTable(Header* header,
                                                ReadableFontData* data,
                                                int32_t num_hmetrics,
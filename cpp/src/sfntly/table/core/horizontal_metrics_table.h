@@ -56,6 +56,19 @@ class HorizontalMetricsTable : public Table,
   int32_t AdvanceWidth(int32_t glyph_id);
   int32_t LeftSideBearing(int32_t glyph_id);
 
+  // Get the advance widths and left side bearings of consecutive hMetric
+  // entries, decoded in a single pass over the table.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param entry the first hMetric entry
+  // @param count the number of entries to get
+  // @param advance_widths receives the advance widths
+  // @param lsbs receives the left side bearings
+  // @return the number of entries actually read
+  int32_t HMetrics(int32_t entry,
+                   int32_t count,
+                   IntegerList* advance_widths,
+                   IntegerList* lsbs);
+
  private:
   struct Offset {
     enum {
@@ -75,6 +88,12 @@ class HorizontalMetricsTable : public Table,
                          ReadableFontData* data,
                          int32_t num_hmetrics,
                          int32_t num_glyphs);
+  friend class Table;
+
+  // Read the advance width and left side bearing of an hMetric entry in one
+  // pass, as the raw 16-bit values in hmetric[2].
+  // @return false if the entry is out of range
+  bool ReadHMetric(int32_t entry, uint16_t* hmetric);
 
   int32_t num_hmetrics_;
   int32_t num_glyphs_;
@@ -111,6 +111,7 @@ class MaximumProfileTable : public Table,
   };
 
   MaximumProfileTable(Header* header, ReadableFontData* data);
+  friend class Table;
 };
 typedef Ptr<MaximumProfileTable> MaximumProfileTablePtr;
 typedef Ptr<MaximumProfileTable::Builder> MaximumProfileTableBuilderPtr;
@@ -705,6 +705,7 @@ class NameTable : public SubTableContainerTable, public RefCounted<NameTable> {
 
   // The table shall be constructed using Builder, no direct instantiation.
   NameTable(Header* header, ReadableFontData* data);
+  friend class Table;
 
   // Get the offset to the string data in the name table.
   int32_t StringOffset();
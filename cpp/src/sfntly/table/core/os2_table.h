@@ -500,6 +500,7 @@ class OS2Table : public Table, public RefCounted<OS2Table> {
   };
 
   OS2Table(Header* header, ReadableFontData* data);
+  friend class Table;
 };
 typedef Ptr<OS2Table> OS2TablePtr;
 
@@ -115,15 +115,18 @@ ReadableFontData* FontDataTable::Builder::InternalReadData() {
 }
 
 WritableFontData* FontDataTable::Builder::InternalWriteData() {
-  if (w_data_ == NULL) {
+  // Data backed by a read-only array (e.g. a mapped font file) is shared until
+  // the first write and copied here, just like readable data.
+  if (w_data_ == NULL || w_data_->ReadOnly()) {
+    ReadableFontDataPtr data = InternalReadData();
     WritableFontDataPtr new_data;
     new_data.Attach(WritableFontData::CreateWritableFontData(
-                        r_data_ == NULL ? 0 : r_data_->Length()));
+                        data == NULL ? 0 : data->Length()));
 #if !defined (SFNTLY_NO_EXCEPTION)
     try {
 #endif
-      if (r_data_) {
-        r_data_->CopyTo(new_data);
+      if (data) {
+        data->CopyTo(new_data);
       }
 #if !defined (SFNTLY_NO_EXCEPTION)
     } catch (IOException& e) {
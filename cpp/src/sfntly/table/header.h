@@ -17,11 +17,12 @@
 #ifndef SFNTLY_CPP_SRC_SFNTLY_TABLE_HEADER_H_
 #define SFNTLY_CPP_SRC_SFNTLY_TABLE_HEADER_H_
 
+#include "sfntly/port/arena.h"
 #include "sfntly/port/refcount.h"
 
 namespace sfntly {
 
-class Header : public RefCounted<Header> {
+class Header : public RefCounted<Header>, public ArenaObject {
  public:
   // Make a partial header with only the basic info for an empty new table.
   explicit Header(int32_t tag);
@@ -88,22 +89,22 @@ typedef Ptr<Header> HeaderPtr;
 class HeaderComparator {
  public:
   virtual ~HeaderComparator() {}
-  virtual bool operator()(const HeaderPtr h1,
-                          const HeaderPtr h2) = 0;
+  virtual bool operator()(const HeaderPtr& h1,
+                          const HeaderPtr& h2) const = 0;
 };
 
 class HeaderComparatorByOffset : public HeaderComparator {
  public:
   virtual ~HeaderComparatorByOffset() {}
-  virtual bool operator()(const HeaderPtr h1,
-                          const HeaderPtr h2);
+  virtual bool operator()(const HeaderPtr& h1,
+                          const HeaderPtr& h2) const;
 };
 
 class HeaderComparatorByTag : public HeaderComparator {
  public:
   virtual ~HeaderComparatorByTag() {}
-  virtual bool operator()(const HeaderPtr h1,
-                          const HeaderPtr h2);
+  virtual bool operator()(const HeaderPtr& h1,
+                          const HeaderPtr& h2) const;
 };
 
 typedef std::set<HeaderPtr, HeaderComparatorByOffset> HeaderOffsetSortedSet;
@@ -45,6 +45,77 @@ namespace sfntly {
  ******************************************************************************/
 Table::~Table() {}
 
+static Table* GetRelatedTable(TableMap* related_tables, int32_t tag) {
+  if (related_tables) {
+    TableMap::iterator target = related_tables->find(tag);
+    if (target != related_tables->end()) {
+      return target->second.p_;
+    }
+  }
+  return NULL;
+}
+
+CALLER_ATTACH
+Table* Table::GetTable(Header* header,
+                       ReadableFontData* table_data,
+                       TableMap* related_tables) {
+  int32_t tag = header->tag();
+  TablePtr table;
+
+  // Note: same table types as Table::Builder::GetBuilder(), with the values
+  //       Font::Builder::InterRelateBuilders() passes between builders taken
+  //       from the related tables instead.
+  if (tag == Tag::head || tag == Tag::bhed) {
+    table = new FontHeaderTable(header, table_data);
+#if defined (SFNTLY_EXPERIMENTAL)
+  } else if (tag == Tag::cmap) {
+    table = new CMapTable(header, table_data);
+#endif  // SFNTLY_EXPERIMENTAL
+  } else if (tag == Tag::hhea) {
+    table = new HorizontalHeaderTable(header, table_data);
+  } else if (tag == Tag::hmtx) {
+    Table* hhea = GetRelatedTable(related_tables, Tag::hhea);
+    Table* maxp = GetRelatedTable(related_tables, Tag::maxp);
+    table = new HorizontalMetricsTable(
+        header, table_data,
+        hhea ? down_cast<HorizontalHeaderTable*>(hhea)->NumberOfHMetrics()
+             : -1,
+        maxp ? down_cast<MaximumProfileTable*>(maxp)->NumGlyphs() : -1);
+  } else if (tag == Tag::maxp) {
+    table = new MaximumProfileTable(header, table_data);
+  } else if (tag == Tag::name) {
+    table = new NameTable(header, table_data);
+  } else if (tag == Tag::OS_2) {
+    table = new OS2Table(header, table_data);
+  } else if (tag == Tag::glyf) {
+    table = new GlyphTable(header, table_data);
+  } else if (tag == Tag::loca) {
+    Table* head = GetRelatedTable(related_tables, Tag::head);
+    Table* maxp = GetRelatedTable(related_tables, Tag::maxp);
+    table = new LocaTable(
+        header, table_data,
+        head ? down_cast<FontHeaderTable*>(head)->IndexToLocFormat()
+             : (int32_t)IndexToLocFormat::kLongOffset,
+        maxp ? down_cast<MaximumProfileTable*>(maxp)->NumGlyphs() : -1);
+  } else if (tag == Tag::EBDT || tag == Tag::bdat) {
+    table = new EbdtTable(header, table_data);
+  } else if (tag == Tag::EBLC || tag == Tag::bloc) {
+    table = new EblcTable(header, table_data);
+  } else if (tag == Tag::EBSC) {
+    table = new EbscTable(header, table_data);
+#if defined (SFNTLY_EXPERIMENTAL)
+  } else if (tag == Tag::hdmx) {
+    Table* maxp = GetRelatedTable(related_tables, Tag::maxp);
+    table = new HorizontalDeviceMetricsTable(
+        header, table_data,
+        maxp ? down_cast<MaximumProfileTable*>(maxp)->NumGlyphs() : -1);
+#endif  // SFNTLY_EXPERIMENTAL
+  } else {
+    table = new GenericTable(header, table_data);
+  }
+  return table.Detach();
+}
+
 int64_t Table::CalculatedChecksum() {
   return data_->Checksum();
 }
@@ -22,12 +22,17 @@
 #include <vector>
 #include <utility>
 
+#include "sfntly/port/flat_map.h"
 #include "sfntly/port/type.h"
 #include "sfntly/table/font_data_table.h"
 #include "sfntly/table/header.h"
 
 namespace sfntly {
 class Font;
+class Table;
+// Note: C++ port only, a sorted vector rather than a std::map since fonts
+// have few tables and they are looked up far more often than added.
+typedef FlatMap<int32_t, Ptr<Table> > TableMap;
 
 // A concrete implementation of a root level table in the font. This is the base
 // class used for all specific table implementations and is used as the generic
@@ -66,6 +71,19 @@ class Table : public FontDataTable {
 
   virtual ~Table();
 
+  // Get a read-only table for the table type specified by the data in the
+  // header, made straight from the data without going through a builder.
+  // Tables which need values from other tables (hmtx, loca and hdmx) read them
+  // from the tables with those tags in related_tables.
+  // Note: C++ port only, there is no Java equivalent.
+  // @param header the header for the table
+  // @param table_data the data of the table
+  // @param related_tables tables the table may depend on; may be NULL
+  // @return the table
+  static CALLER_ATTACH Table* GetTable(Header* header,
+                                       ReadableFontData* table_data,
+                                       TableMap* related_tables);
+
   // Get the calculated checksum for the data in the table.
   virtual int64_t CalculatedChecksum();
 
@@ -106,11 +124,12 @@ class GenericTable : public Table, public RefCounted<GenericTable> {
 typedef Ptr<Table> TablePtr;
 typedef std::vector<HeaderPtr> TableHeaderList;
 typedef Ptr<Table::Builder> TableBuilderPtr;
-typedef std::map<int32_t, TablePtr> TableMap;
 typedef std::pair<int32_t, TablePtr> TableMapEntry;
 
 typedef std::map<HeaderPtr, WritableFontDataPtr> DataBlockMap;
 typedef std::pair<HeaderPtr, WritableFontDataPtr> DataBlockEntry;
+// Note: C++ port only, data blocks of tables not built yet by tag.
+typedef FlatMap<int32_t, DataBlockEntry> TableDataBlockMap;
 typedef std::map<int32_t, TableBuilderPtr> TableBuilderMap;
 typedef std::pair<int32_t, TableBuilderPtr> TableBuilderEntry;
 
@@ -60,7 +60,9 @@ TableBasedTableBuilder::TableBasedTableBuilder(Header* header)
 }
 
 Table* TableBasedTableBuilder::GetTable() {
-  if (table_ == NULL) {
+  // The builder switches to a private copy of its data on the first write to
+  // read-only data, so the cached table may be reading the stale original.
+  if (table_ == NULL || table_->ReadFontData() != InternalReadData()) {
     table_.Attach(down_cast<Table*>(SubBuildTable(InternalReadData())));
   }
   return table_;
@@ -18,6 +18,7 @@
 
 #include <stdlib.h>
 
+#include "sfntly/port/atomic.h"
 #include "sfntly/port/exception_type.h"
 
 namespace sfntly {
@@ -165,15 +166,15 @@ void GlyphTable::Builder::Initialize(ReadableFontData* data,
     }
     int32_t loca_value;
     int32_t last_loca_value = loca[0];
+    glyph_builders_.reserve(loca.size() - 1);
     for (size_t i = 1; i < loca.size(); ++i) {
       loca_value = loca[i];
-      GlyphBuilderPtr builder;
-      builder.Attach(
+      glyph_builders_.push_back(GlyphBuilderPtr());
+      glyph_builders_.back().Attach(
         Glyph::Builder::GetBuilder(this,
                                    data,
                                    last_loca_value /*offset*/,
                                    loca_value - last_loca_value /*length*/));
-      glyph_builders_.push_back(builder);
       last_loca_value = loca_value;
     }
   }
@@ -336,7 +337,7 @@ int32_t GlyphTable::Glyph::Builder::SubSerialize(WritableFontData* new_data) {
  * GlyphTable::SimpleGlyph
  ******************************************************************************/
 GlyphTable::SimpleGlyph::SimpleGlyph(ReadableFontData* data)
-    : GlyphTable::Glyph(data, GlyphType::kSimple), initialized_(false) {
+    : GlyphTable::Glyph(data, GlyphType::kSimple), initialized_(0) {
 }
 
 GlyphTable::SimpleGlyph::~SimpleGlyph() {
@@ -377,6 +378,11 @@ bool GlyphTable::SimpleGlyph::OnCurve(int32_t contour, int32_t point) {
 }
 
 void GlyphTable::SimpleGlyph::Initialize() {
+  // Every accessor calls this, so once the glyph is parsed the common case
+  // must not need the lock.
+  if (AtomicLoadAcquire(&initialized_)) {
+    return;
+  }
   AutoLock lock(initialization_lock_);
   if (initialized_) {
     return;
@@ -389,6 +395,7 @@ void GlyphTable::SimpleGlyph::Initialize() {
     flags_offset_ = 0;
     x_coordinates_offset_ = 0;
     y_coordinates_offset_ = 0;
+    AtomicStoreRelease(&initialized_, 1);
     return;
   }
 
@@ -420,7 +427,7 @@ void GlyphTable::SimpleGlyph::Initialize() {
     (x_byte_count_ * DataSize::kBYTE) +
     (y_byte_count_ * DataSize::kBYTE);
   set_padding(DataLength() - non_padded_data_length);
-  initialized_ = true;
+  AtomicStoreRelease(&initialized_, 1);
 }
 
 void GlyphTable::SimpleGlyph::ParseData(bool fill_arrays) {
@@ -536,7 +543,7 @@ GlyphTable::CompositeGlyph::CompositeGlyph(ReadableFontData* data)
     : GlyphTable::Glyph(data, GlyphType::kComposite),
       instruction_size_(0),
       instructions_offset_(0),
-      initialized_(false) {
+      initialized_(0) {
   Initialize();
 }
 
@@ -614,6 +621,9 @@ CALLER_ATTACH ReadableFontData* GlyphTable::CompositeGlyph::Instructions() {
 }
 
 void GlyphTable::CompositeGlyph::Initialize() {
+  if (AtomicLoadAcquire(&initialized_)) {
+    return;
+  }
   AutoLock lock(initialization_lock_);
   if (initialized_) {
     return;
@@ -650,7 +660,7 @@ void GlyphTable::CompositeGlyph::Initialize() {
     set_padding(DataLength() - non_padded_data_length);
   }
 
-  initialized_ = true;
+  AtomicStoreRelease(&initialized_, 1);
 }
 
 /******************************************************************************
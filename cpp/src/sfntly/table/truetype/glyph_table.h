@@ -210,7 +210,10 @@ class GlyphTable : public SubTableContainerTable,
     int32_t FlagAsInt(int32_t index);
     int32_t ContourEndPoint(int32_t contour);
 
-    bool initialized_;
+    // Guards parsing the glyph. initialized_ is published with release
+    // semantics once the parsed fields are written, so accessors that see it
+    // set skip the lock.
+    int32_t initialized_;
     Lock initialization_lock_;
     int32_t instruction_size_;
     int32_t number_of_points_;
@@ -287,7 +290,8 @@ class GlyphTable : public SubTableContainerTable,
     IntegerList contour_index_;
     int32_t instruction_size_;
     int32_t instructions_offset_;
-    bool initialized_;
+    // Guards parsing the glyph, published like SimpleGlyph::initialized_.
+    int32_t initialized_;
     Lock initialization_lock_;
   };
 
@@ -323,6 +327,7 @@ class GlyphTable : public SubTableContainerTable,
   };
 
   GlyphTable(Header* header, ReadableFontData* data);
+  friend class Table;
 };
 typedef Ptr<GlyphTable> GlyphTablePtr;
 typedef Ptr<GlyphTable::Builder> GlyphTableBuilderPtr;
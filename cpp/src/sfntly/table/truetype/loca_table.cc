@@ -15,6 +15,9 @@
  */
 
 #include "sfntly/table/truetype/loca_table.h"
+
+#include <vector>
+
 #include "sfntly/port/exception_type.h"
 
 namespace sfntly {
@@ -73,7 +76,7 @@ LocaTable::LocaTable(Header* header,
  * LocaTable::Iterator class
  ******************************************************************************/
 LocaTable::LocaIterator::LocaIterator(LocaTable* table)
-    : PODIterator<int32_t, LocaTable>(table), index_(-1) {
+    : PODIterator<int32_t, LocaTable>(table), index_(0) {
 }
 
 bool LocaTable::LocaIterator::HasNext() {
@@ -183,15 +186,21 @@ bool LocaTable::Builder::SubReadyToSerialize() {
 
 int32_t LocaTable::Builder::SubSerialize(WritableFontData* new_data) {
   int32_t size = 0;
-  for (IntegerList::iterator l = loca_.begin(), end = loca_.end();
-                             l != end; ++l) {
-    if (format_version_ == IndexToLocFormat::kLongOffset) {
-      size += new_data->WriteULong(size, *l);
-    } else {
-      size += new_data->WriteUShort(size, *l / 2);
+  num_glyphs_ = loca_.size() - 1;
+  if (loca_.empty()) {
+    return size;
+  }
+  if (format_version_ == IndexToLocFormat::kLongOffset) {
+    size = new_data->WriteULongArray(
+        0, reinterpret_cast<const uint32_t*>(&(loca_[0])), loca_.size());
+  } else {
+    std::vector<uint16_t> short_offsets(loca_.size());
+    for (size_t i = 0; i < loca_.size(); ++i) {
+      short_offsets[i] = (uint16_t)(loca_[i] / 2);
     }
+    size = new_data->WriteUShortArray(0, &(short_offsets[0]),
+                                      short_offsets.size());
   }
-  num_glyphs_ = loca_.size() - 1;
   return size;
 }
 
@@ -204,12 +213,20 @@ void LocaTable::Builder::Initialize(ReadableFontData* data) {
 #endif
       return;
     }
-    LocaTablePtr table =
-        new LocaTable(header(), data, format_version_, num_glyphs_);
-    Ptr<LocaTable::LocaIterator> loca_iter =
-        new LocaTable::LocaIterator(table);
-    while (loca_iter->HasNext()) {
-      loca_.push_back(loca_iter->Next());
+    // Decode all the offsets in one pass rather than one read per glyph.
+    int32_t num_locas = num_glyphs_ + 1;
+    loca_.resize(num_locas);
+    if (format_version_ == IndexToLocFormat::kShortOffset) {
+      std::vector<uint16_t> short_offsets(num_locas);
+      int32_t count = data->ReadUShortArray(0, num_locas, &(short_offsets[0]));
+      for (int32_t i = 0; i < count; ++i) {
+        loca_[i] = 2 * short_offsets[i];
+      }
+      loca_.resize(count);
+    } else {
+      int32_t count = data->ReadULongArray(
+          0, num_locas, reinterpret_cast<uint32_t*>(&(loca_[0])));
+      loca_.resize(count);
     }
   }
 }
@@ -169,6 +169,7 @@ class LocaTable : public Table, public RefCounted<LocaTable> {
             ReadableFontData* data,
             int32_t format_version,
             int32_t num_glyphs);
+  friend class Table;
 
   int32_t format_version_;  // Note: Java's version, renamed to format_version_
   int32_t num_glyphs_;
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/arena.h"
+#include "sfntly/port/memory_output_stream.h"
+#include "test/test_data.h"
+#include "test/test_font_utils.h"
+
+namespace sfntly {
+
+class ArenaTestObject : public RefCounted<ArenaTestObject>,
+                        public ArenaObject {
+ public:
+  explicit ArenaTestObject(bool* destroyed) : destroyed_(destroyed) {}
+  virtual ~ArenaTestObject() { *destroyed_ = true; }
+
+ private:
+  bool* destroyed_;
+};
+
+bool TestArenaScope() {
+  EXPECT_TRUE(Arena::Current() == NULL);
+  ArenaPtr outer = new Arena();
+  ArenaPtr inner = new Arena();
+  {
+    ArenaScope outer_scope(outer);
+    EXPECT_TRUE(Arena::Current() == outer);
+    {
+      ArenaScope inner_scope(inner);
+      EXPECT_TRUE(Arena::Current() == inner);
+      ArenaScope null_scope(NULL);
+      EXPECT_TRUE(Arena::Current() == inner);
+    }
+    EXPECT_TRUE(Arena::Current() == outer);
+  }
+  EXPECT_TRUE(Arena::Current() == NULL);
+  return true;
+}
+
+bool TestArenaAllocation() {
+  bool destroyed = false;
+  Ptr<ArenaTestObject> object;
+  ArenaPtr arena = new Arena(1024);
+  {
+    ArenaScope scope(arena);
+    object = new ArenaTestObject(&destroyed);
+    // Large objects get blocks of their own.
+    EXPECT_EQ(size_t(1), arena->allocations());
+    EXPECT_EQ(size_t(1), arena->blocks());
+    void* big = arena->Allocate(4096);
+    EXPECT_TRUE(big != NULL);
+    EXPECT_EQ(size_t(2), arena->blocks());
+    for (int32_t i = 0; i < 100; ++i) {
+      void* p = arena->Allocate(i + 1);
+      EXPECT_EQ(size_t(0), reinterpret_cast<uintptr_t>(p) % 16);
+    }
+  }
+  EXPECT_GT(arena->blocks(), size_t(2));
+  // The object keeps its arena alive.
+  EXPECT_EQ(size_t(2), arena->ref_count_);
+  Arena* raw_arena = arena;
+  arena.Release();
+  EXPECT_EQ(size_t(1), raw_arena->ref_count_);
+  object.Release();
+  EXPECT_TRUE(destroyed);
+
+  // Objects created outside of any scope come from the heap.
+  destroyed = false;
+  object = new ArenaTestObject(&destroyed);
+  object.Release();
+  EXPECT_TRUE(destroyed);
+  return true;
+}
+
+bool TestArenaFontLoading() {
+  // A font loaded into an arena serializes exactly like one on the heap, and
+  // stays usable after the factory that loaded it is gone.
+  FontArray fonts[2];
+  for (int32_t i = 0; i < 2; ++i) {
+    FontFactoryPtr factory;
+    factory.Attach(FontFactory::GetInstance());
+    factory->UseArena(i == 1);
+    EXPECT_EQ(i == 1, factory->UseArena());
+    LoadFont(SAMPLE_TTF_FILE, factory, &fonts[i]);
+    EXPECT_EQ(size_t(1), fonts[i].size());
+  }
+  EXPECT_TRUE(Arena::Current() == NULL);
+
+  MemoryOutputStream heap_output;
+  MemoryOutputStream arena_output;
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  factory->SerializeFont(fonts[0][0], &heap_output);
+  factory->SerializeFont(fonts[1][0], &arena_output);
+  EXPECT_EQ(heap_output.Size(), arena_output.Size());
+  EXPECT_EQ(0, memcmp(heap_output.Get(), arena_output.Get(),
+                      heap_output.Size()));
+
+  // Font builders from an arena factory build into the same arena.
+  factory->UseArena(true);
+  FontBuilderPtr builder;
+  builder.Attach(factory->NewFontBuilder());
+  Table* head = fonts[1][0]->GetTable(Tag::head);
+  EXPECT_TRUE(builder->NewTableBuilder(Tag::head, head->ReadFontData()));
+  FontPtr font;
+  font.Attach(builder->Build());
+  EXPECT_TRUE(font->GetTable(Tag::head) != NULL);
+  return true;
+}
+
+bool TestArenaOutlivingFont() {
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  factory->UseArena(true);
+  FontArray fonts;
+  LoadFont(SAMPLE_TTF_FILE, factory, &fonts);
+  EXPECT_EQ(size_t(1), fonts.size());
+  MemoryOutputStream expected;
+  factory->SerializeFont(fonts[0], &expected);
+
+  // A table shares the data of its font, which is gone before the table and
+  // the font built from it are used.
+  FontBuilderPtr builder;
+  builder.Attach(factory->NewFontBuilder());
+  TablePtr glyf = fonts[0]->GetTable(Tag::glyf);
+  int64_t checksum = glyf->CalculatedChecksum();
+  const TableMap* tables = fonts[0]->GetTableMap();
+  for (TableMap::const_iterator t = tables->begin(), e = tables->end();
+       t != e; ++t) {
+    EXPECT_TRUE(builder->NewTableBuilder(t->first,
+                                         t->second->ReadFontData()));
+  }
+  fonts.clear();
+
+  FontPtr font;
+  font.Attach(builder->Build());
+  builder.Release();
+  EXPECT_EQ(checksum, glyf->CalculatedChecksum());
+  MemoryOutputStream output;
+  factory->SerializeFont(font, &output);
+  EXPECT_EQ(expected.Size(), output.Size());
+  EXPECT_EQ(0, memcmp(expected.Get(), output.Get(), expected.Size()));
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(Arena, Scope) {
+  ASSERT_TRUE(sfntly::TestArenaScope());
+}
+
+TEST(Arena, Allocation) {
+  ASSERT_TRUE(sfntly::TestArenaAllocation());
+}
+
+TEST(Arena, FontLoading) {
+  ASSERT_TRUE(sfntly::TestArenaFontLoading());
+}
+
+TEST(Arena, OutlivingFont) {
+  ASSERT_TRUE(sfntly::TestArenaOutlivingFont());
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include <new>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sample/chromium/subsetter_impl.h"
+#include "sfntly/port/arena.h"
+#include "sfntly/port/atomic.h"
+#include "sfntly/port/type.h"
+#include "test/benchmark/benchmark_utils.h"
+#include "test/test_font_utils.h"
+
+// Count every heap allocation made by this binary.
+static size_t g_heap_allocations = 0;
+
+void* operator new(size_t size) {
+  AtomicIncrement(&g_heap_allocations);
+  void* p = malloc(size ? size : 1);
+  if (p == NULL) {
+    abort();
+  }
+  return p;
+}
+
+void operator delete(void* p) throw() {
+  free(p);
+}
+
+namespace sfntly {
+
+const int32_t kArenaBenchmarkPasses = 4;
+const unsigned int kArenaBenchmarkGlyphs = 64;
+
+// Load, subset and serialize every font of the corpus, with every ref counted
+// object of each cycle placed in an arena of its own or on the heap.
+int64_t TimeSubsetCycles(const char* name,
+                         std::vector<ByteVector>* corpus,
+                         bool use_arena) {
+  std::vector<unsigned int> glyph_ids;
+  for (unsigned int i = 0; i < kArenaBenchmarkGlyphs; ++i) {
+    glyph_ids.push_back(i);
+  }
+  int64_t output_bytes = 0;
+  int64_t operations = 0;
+  size_t arena_allocations = 0;
+  size_t heap_allocations = g_heap_allocations;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kArenaBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < corpus->size(); ++i) {
+      ArenaPtr arena;
+      if (use_arena) {
+        arena = new Arena();
+      }
+      ArenaScope scope(arena);
+      SubsetterImpl subsetter;
+      if (!subsetter.LoadFont(NULL, &((*corpus)[i][0]), (*corpus)[i].size())) {
+        continue;
+      }
+      unsigned char* output = NULL;
+      int length = subsetter.SubsetFont(&(glyph_ids[0]), glyph_ids.size(),
+                                        &output);
+      if (length > 0) {
+        output_bytes += length;
+        delete[] output;
+      }
+      if (arena) {
+        arena_allocations += arena->allocations();
+      }
+      ++operations;
+    }
+  }
+  int64_t elapsed = GetMicroseconds() - start;
+  heap_allocations = g_heap_allocations - heap_allocations;
+  ReportBenchmark(name, operations, elapsed, output_bytes);
+  fprintf(stderr, "  %.0f heap allocations/cycle, %.0f arena allocations/cycle"
+          "\n", (double)heap_allocations / operations,
+          (double)arena_allocations / operations);
+  return output_bytes;
+}
+
+bool BenchmarkArenaSubsetting() {
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  std::vector<ByteVector> corpus;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    corpus.push_back(ByteVector());
+    LoadFile(paths[i].c_str(), &(corpus.back()));
+  }
+  EXPECT_FALSE(corpus.empty());
+
+  // A warm-up round first, then the two cases in a fixed order, so that
+  // neither pays for warming up the heap and caches.
+  int64_t warm_up_bytes =
+      TimeSubsetCycles("Load+subset+serialize (warm-up)", &corpus, false);
+  int64_t heap_bytes =
+      TimeSubsetCycles("Load+subset+serialize (heap)", &corpus, false);
+  int64_t arena_bytes =
+      TimeSubsetCycles("Load+subset+serialize (arena)", &corpus, true);
+  EXPECT_EQ(warm_up_bytes, heap_bytes);
+  EXPECT_EQ(heap_bytes, arena_bytes);
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(ArenaBenchmark, CorpusSubsetting) {
+  ASSERT_TRUE(sfntly::BenchmarkArenaSubsetting());
+}
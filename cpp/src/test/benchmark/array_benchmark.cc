@@ -0,0 +1,126 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sfntly/data/memory_byte_array.h"
+#include "sfntly/data/writable_font_data.h"
+#include "sfntly/port/type.h"
+#include "test/benchmark/benchmark_utils.h"
+
+namespace sfntly {
+
+// Sized like the loca table of a large CJK font.
+const int32_t kArrayBenchmarkEntries = 65536;
+const int32_t kArrayBenchmarkPasses = 64;
+
+bool BenchmarkFontDataArrayReads() {
+  int32_t size = kArrayBenchmarkEntries * DataSize::kULONG;
+  ByteArrayPtr ba = new MemoryByteArray(size);
+  for (int32_t i = 0; i < size; ++i) {
+    ba->Put(i, (byte_t)((i * 31 + 7) % 256));
+  }
+  ReadableFontDataPtr rfd = new ReadableFontData(ba);
+  std::vector<uint16_t> ushorts(kArrayBenchmarkEntries);
+  std::vector<uint32_t> ulongs(kArrayBenchmarkEntries);
+  int64_t operations = (int64_t)kArrayBenchmarkPasses * kArrayBenchmarkEntries;
+
+  int64_t scalar_sum = 0;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kArrayBenchmarkPasses; ++pass) {
+    for (int32_t i = 0; i < kArrayBenchmarkEntries; ++i) {
+      ushorts[i] = (uint16_t)rfd->ReadUShort(i * DataSize::kUSHORT);
+    }
+    scalar_sum += ushorts[pass];
+  }
+  ReportBenchmark("ReadUShort loop", operations, GetMicroseconds() - start,
+                  operations * DataSize::kUSHORT);
+
+  int64_t bulk_sum = 0;
+  start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kArrayBenchmarkPasses; ++pass) {
+    rfd->ReadUShortArray(0, kArrayBenchmarkEntries, &(ushorts[0]));
+    bulk_sum += ushorts[pass];
+  }
+  ReportBenchmark("ReadUShortArray", operations, GetMicroseconds() - start,
+                  operations * DataSize::kUSHORT);
+  EXPECT_EQ(scalar_sum, bulk_sum);
+
+  scalar_sum = 0;
+  start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kArrayBenchmarkPasses; ++pass) {
+    for (int32_t i = 0; i < kArrayBenchmarkEntries; ++i) {
+      ulongs[i] = (uint32_t)rfd->ReadULong(i * DataSize::kULONG);
+    }
+    scalar_sum += ulongs[pass];
+  }
+  ReportBenchmark("ReadULong loop", operations, GetMicroseconds() - start,
+                  operations * DataSize::kULONG);
+
+  bulk_sum = 0;
+  start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kArrayBenchmarkPasses; ++pass) {
+    rfd->ReadULongArray(0, kArrayBenchmarkEntries, &(ulongs[0]));
+    bulk_sum += ulongs[pass];
+  }
+  ReportBenchmark("ReadULongArray", operations, GetMicroseconds() - start,
+                  operations * DataSize::kULONG);
+  EXPECT_EQ(scalar_sum, bulk_sum);
+  return true;
+}
+
+bool BenchmarkFontDataArrayWrites() {
+  std::vector<uint32_t> ulongs(kArrayBenchmarkEntries);
+  for (int32_t i = 0; i < kArrayBenchmarkEntries; ++i) {
+    ulongs[i] = (uint32_t)i * 2654435761U;
+  }
+  WritableFontDataPtr wfd;
+  wfd.Attach(WritableFontData::CreateWritableFontData(
+      kArrayBenchmarkEntries * DataSize::kULONG));
+  int64_t operations = (int64_t)kArrayBenchmarkPasses * kArrayBenchmarkEntries;
+
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kArrayBenchmarkPasses; ++pass) {
+    for (int32_t i = 0; i < kArrayBenchmarkEntries; ++i) {
+      wfd->WriteULong(i * DataSize::kULONG, ulongs[i]);
+    }
+  }
+  ReportBenchmark("WriteULong loop", operations, GetMicroseconds() - start,
+                  operations * DataSize::kULONG);
+  int64_t scalar_checksum = wfd->Checksum();
+
+  wfd.Attach(WritableFontData::CreateWritableFontData(
+      kArrayBenchmarkEntries * DataSize::kULONG));
+  start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kArrayBenchmarkPasses; ++pass) {
+    wfd->WriteULongArray(0, &(ulongs[0]), kArrayBenchmarkEntries);
+  }
+  ReportBenchmark("WriteULongArray", operations, GetMicroseconds() - start,
+                  operations * DataSize::kULONG);
+  EXPECT_EQ(scalar_checksum, wfd->Checksum());
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(FontDataBenchmark, ArrayReads) {
+  ASSERT_TRUE(sfntly::BenchmarkFontDataArrayReads());
+}
+
+TEST(FontDataBenchmark, ArrayWrites) {
+  ASSERT_TRUE(sfntly::BenchmarkFontDataArrayWrites());
+}
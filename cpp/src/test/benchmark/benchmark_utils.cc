@@ -0,0 +1,131 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test/benchmark/benchmark_utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+
+#if defined (WIN32)
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <time.h>
+#endif
+
+#if !defined (SFNTLY_FONT_CORPUS_DIR)
+#define SFNTLY_FONT_CORPUS_DIR "../../data/fonts"
+#endif
+
+namespace sfntly {
+
+namespace {
+
+bool IsFontFile(const std::string& name) {
+  size_t dot = name.rfind('.');
+  if (dot == std::string::npos) {
+    return false;
+  }
+  std::string extension = name.substr(dot);
+  return extension == ".ttf" || extension == ".otf" || extension == ".ttc";
+}
+
+void FindFontFiles(const std::string& dir, std::vector<std::string>* paths) {
+#if defined (WIN32)
+  WIN32_FIND_DATAA entry;
+  HANDLE find = FindFirstFileA((dir + "\\*").c_str(), &entry);
+  if (find == INVALID_HANDLE_VALUE) {
+    return;
+  }
+  do {
+    std::string name = entry.cFileName;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    std::string path = dir + "\\" + name;
+    if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+      FindFontFiles(path, paths);
+    } else if (IsFontFile(name)) {
+      paths->push_back(path);
+    }
+  } while (FindNextFileA(find, &entry));
+  FindClose(find);
+#else
+  DIR* d = opendir(dir.c_str());
+  if (d == NULL) {
+    return;
+  }
+  struct dirent* entry;
+  while ((entry = readdir(d)) != NULL) {
+    std::string name = entry->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    std::string path = dir + "/" + name;
+    DIR* child = opendir(path.c_str());
+    if (child) {
+      closedir(child);
+      FindFontFiles(path, paths);
+    } else if (IsFontFile(name)) {
+      paths->push_back(path);
+    }
+  }
+  closedir(d);
+#endif
+}
+
+}  // namespace
+
+void GetCorpusFontFiles(std::vector<std::string>* paths) {
+  const char* dir = getenv("SFNTLY_FONT_CORPUS");
+  FindFontFiles(dir ? dir : SFNTLY_FONT_CORPUS_DIR, paths);
+  std::sort(paths->begin(), paths->end());
+}
+
+int64_t GetMicroseconds() {
+#if defined (WIN32)
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return counter.QuadPart * 1000000 / frequency.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+void ReportBenchmark(const char* name,
+                     int64_t operations,
+                     int64_t micros,
+                     int64_t bytes) {
+  if (micros <= 0) {
+    micros = 1;
+  }
+  double ns_per_op = operations ? micros * 1000.0 / operations : 0.0;
+  if (bytes > 0) {
+    fprintf(stderr, "%-40s %12lld ops %10.2f ns/op %10.2f MB/s\n", name,
+            (long long)operations, ns_per_op,
+            bytes / (double)micros);
+  } else {
+    fprintf(stderr, "%-40s %12lld ops %10.2f ns/op\n", name,
+            (long long)operations, ns_per_op);
+  }
+}
+
+}  // namespace sfntly
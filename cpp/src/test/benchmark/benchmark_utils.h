@@ -0,0 +1,48 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_TEST_BENCHMARK_BENCHMARK_UTILS_H_
+#define SFNTLY_CPP_SRC_TEST_BENCHMARK_BENCHMARK_UTILS_H_
+
+#include <string>
+#include <vector>
+
+#include "sfntly/port/type.h"
+
+namespace sfntly {
+
+// Get the paths of all .ttf, .otf and .ttc files below the font corpus
+// directory, sorted. The corpus is cpp/data/fonts unless the
+// SFNTLY_FONT_CORPUS environment variable names another directory.
+void GetCorpusFontFiles(std::vector<std::string>* paths);
+
+// Returns a monotonic timestamp in microseconds, only meaningful relative to
+// another call of this function.
+int64_t GetMicroseconds();
+
+// Print one benchmark result line.
+// @param name the name of the measured operation
+// @param operations the number of operations that were timed
+// @param micros the elapsed time in microseconds
+// @param bytes the number of bytes processed, or 0 if not applicable
+void ReportBenchmark(const char* name,
+                     int64_t operations,
+                     int64_t micros,
+                     int64_t bytes);
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_TEST_BENCHMARK_BENCHMARK_UTILS_H_
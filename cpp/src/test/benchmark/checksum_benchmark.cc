@@ -0,0 +1,75 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "sfntly/data/memory_byte_array.h"
+#include "sfntly/data/readable_font_data.h"
+#include "sfntly/port/type.h"
+#include "test/benchmark/benchmark_utils.h"
+#include "test/test_utils.h"
+
+namespace sfntly {
+
+const int32_t kChecksumBenchmarkSize = 4 * 1024 * 1024;
+const int32_t kChecksumBenchmarkPasses = 16;
+const int32_t kCachedChecksumCalls = 1000000;
+
+// Time recomputing the checksum of the whole array, as serialization does
+// for every table whose data changed.
+int64_t TimeChecksum(const char* name, ByteArray* ba) {
+  ReadableFontDataPtr rfd = new ReadableFontData(ba);
+  IntegerList no_ranges;
+  int64_t checksum = 0;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kChecksumBenchmarkPasses; ++pass) {
+    rfd->SetCheckSumRanges(no_ranges);
+    checksum = rfd->Checksum();
+  }
+  int64_t elapsed = GetMicroseconds() - start;
+  ReportBenchmark(name, kChecksumBenchmarkPasses, elapsed,
+                  (int64_t)kChecksumBenchmarkPasses * ba->Length());
+  return checksum;
+}
+
+bool BenchmarkChecksum() {
+  ByteArrayPtr contiguous = new MemoryByteArray(kChecksumBenchmarkSize);
+  ByteArrayPtr non_contiguous =
+      new NonContiguousByteArray(kChecksumBenchmarkSize);
+  for (int32_t i = 0; i < kChecksumBenchmarkSize; ++i) {
+    byte_t b = (byte_t)((i * 131 + 7) % 256);
+    contiguous->Put(i, b);
+    non_contiguous->Put(i, b);
+  }
+  EXPECT_EQ(TimeChecksum("Checksum 4MB (per byte)", non_contiguous),
+            TimeChecksum("Checksum 4MB (vectorized)", contiguous));
+
+  // Repeated calls once the checksum is known.
+  ReadableFontDataPtr rfd = new ReadableFontData(contiguous);
+  int64_t checksum = rfd->Checksum();
+  int64_t start = GetMicroseconds();
+  for (int32_t i = 0; i < kCachedChecksumCalls; ++i) {
+    EXPECT_EQ(checksum, rfd->Checksum());
+  }
+  ReportBenchmark("Checksum (cached)", kCachedChecksumCalls,
+                  GetMicroseconds() - start, 0);
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(ChecksumBenchmark, ReadableFontDataChecksum) {
+  ASSERT_TRUE(sfntly::BenchmarkChecksum());
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/thread_pool.h"
+#include "sfntly/port/type.h"
+#include "sfntly/tag.h"
+#include "test/benchmark/benchmark_utils.h"
+#include "test/test_font_utils.h"
+
+namespace sfntly {
+
+const int32_t kCollectionBenchmarkPasses = 4;
+const int32_t kCollectionMembers = 8;
+
+static void PutULong(ByteVector* b, size_t index, uint32_t value) {
+  (*b)[index] = (byte_t)(value >> 24);
+  (*b)[index + 1] = (byte_t)(value >> 16);
+  (*b)[index + 2] = (byte_t)(value >> 8);
+  (*b)[index + 3] = (byte_t)value;
+}
+
+// Make a font collection whose members all use the tables of the font, as
+// the members of a CJK collection share their glyphs.
+void MakeSharedCollection(const ByteVector& font, ByteVector* collection) {
+  size_t header_size = 12 + 4 * kCollectionMembers;
+  size_t num_tables = (font[4] << 8) | font[5];
+  size_t directory_size = 12 + 16 * num_tables;
+  size_t font_offset =
+      (header_size + kCollectionMembers * directory_size + 3) & ~3;
+
+  collection->assign(header_size, 0);
+  PutULong(collection, 0, Tag::ttcf);
+  PutULong(collection, 4, 0x00010000);
+  PutULong(collection, 8, kCollectionMembers);
+  for (int32_t member = 0; member < kCollectionMembers; ++member) {
+    size_t directory = collection->size();
+    PutULong(collection, 12 + 4 * member, directory);
+    collection->insert(collection->end(), font.begin(),
+                       font.begin() + directory_size);
+    for (size_t record = directory + 12; record < collection->size();
+         record += 16) {
+      uint32_t offset = ((*collection)[record + 8] << 24) |
+                        ((*collection)[record + 9] << 16) |
+                        ((*collection)[record + 10] << 8) |
+                        (*collection)[record + 11];
+      PutULong(collection, record + 8, offset + font_offset);
+    }
+  }
+  collection->resize(font_offset, 0);
+  collection->insert(collection->end(), font.begin(), font.end());
+}
+
+// Load the collection and build every table of every member; returns the
+// number of distinct tables.
+size_t TimeCollectionLoading(const char* name,
+                             FontFactory* factory,
+                             std::vector<ByteVector>* collections) {
+  size_t distinct_tables = 0;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kCollectionBenchmarkPasses; ++pass) {
+    distinct_tables = 0;
+    for (size_t i = 0; i < collections->size(); ++i) {
+      FontArray fonts;
+      factory->LoadFonts(&(collections->at(i)), &fonts);
+      std::set<Table*> tables;
+      for (size_t j = 0; j < fonts.size(); ++j) {
+        const TableMap* table_map = fonts[j]->GetTableMap();
+        for (TableMap::const_iterator table = table_map->begin(),
+                                      table_end = table_map->end();
+                                      table != table_end; ++table) {
+          tables.insert(table->second.p_);
+        }
+      }
+      distinct_tables += tables.size();
+    }
+  }
+  ReportBenchmark(name,
+                  (int64_t)kCollectionBenchmarkPasses * collections->size(),
+                  GetMicroseconds() - start, 0);
+  return distinct_tables;
+}
+
+bool BenchmarkCollectionLoading() {
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  std::vector<ByteVector> collections;
+  size_t single_font_tables = 0;
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  for (size_t i = 0; i < paths.size(); ++i) {
+    ByteVector font;
+    LoadFile(paths[i].c_str(), &font);
+    if (font.size() < 12 ||
+        GenerateTag(font[0], font[1], font[2], font[3]) == Tag::ttcf) {
+      continue;
+    }
+    FontArray fonts;
+    factory->LoadFonts(&font, &fonts);
+    if (fonts.empty()) {
+      continue;
+    }
+    single_font_tables += fonts[0]->num_tables();
+    collections.push_back(ByteVector());
+    MakeSharedCollection(font, &collections.back());
+  }
+  EXPECT_FALSE(collections.empty());
+
+  size_t tables = TimeCollectionLoading("Load 8-member collection + tables",
+                                        factory, &collections);
+  fprintf(stderr, "  %zu distinct tables for %zu fonts (%zu tables/font)\n",
+          tables, kCollectionMembers * collections.size(),
+          single_font_tables / collections.size());
+  EXPECT_EQ(single_font_tables, tables);
+
+  ThreadPoolPtr pool = new ThreadPool(4);
+  factory->SetThreadPool(pool);
+  EXPECT_EQ(tables,
+            TimeCollectionLoading("Load 8-member collection, 4 threads",
+                                  factory, &collections));
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(CollectionBenchmark, SharedTables) {
+  ASSERT_TRUE(sfntly::BenchmarkCollectionLoading());
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sfntly/data/memory_byte_array.h"
+#include "sfntly/data/writable_font_data.h"
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/type.h"
+#include "test/benchmark/benchmark_utils.h"
+#include "test/test_font_utils.h"
+#include "test/test_utils.h"
+
+namespace sfntly {
+
+const int32_t kCopyBenchmarkPasses = 4;
+
+struct TableRange {
+  int32_t offset;
+  int32_t length;
+};
+
+struct CorpusFont {
+  ByteVector bytes;
+  std::vector<TableRange> tables;
+};
+
+void LoadCorpus(std::vector<CorpusFont>* corpus) {
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  for (size_t i = 0; i < paths.size(); ++i) {
+    CorpusFont font_file;
+    LoadFile(paths[i].c_str(), &font_file.bytes);
+    FontArray fonts;
+    factory->LoadFonts(&font_file.bytes, &fonts);
+    for (size_t j = 0; j < fonts.size(); ++j) {
+      const TableMap* tables = fonts[j]->GetTableMap();
+      for (TableMap::const_iterator it = tables->begin(), e = tables->end();
+           it != e; ++it) {
+        TableRange range = { it->second->header()->offset(),
+                             it->second->header()->length() };
+        font_file.tables.push_back(range);
+      }
+    }
+    corpus->push_back(font_file);
+  }
+}
+
+enum TableCopyMode {
+  kCopyToFixed,
+  kCopyToGrowable,
+  kShareCopyOnWrite
+};
+
+// Copy every table of every font in the corpus into writable font data, as
+// Font::Builder::NewTableBuilder(tag, src_data) does, with the font file held
+// in arrays of the given kind. Shared tables count their length as copied so
+// the totals of all modes match.
+int64_t TimeTableCopies(const char* name,
+                        std::vector<CorpusFont>* corpus,
+                        bool contiguous,
+                        TableCopyMode mode) {
+  std::vector<ReadableFontDataPtr> sources;
+  for (size_t i = 0; i < corpus->size(); ++i) {
+    ByteVector* bytes = &((*corpus)[i].bytes);
+    ByteArrayPtr ba = contiguous ?
+        new MemoryByteArray(bytes->size()) :
+        new NonContiguousByteArray(bytes->size());
+    ba->Put(0, bytes);
+    sources.push_back(new ReadableFontData(ba));
+  }
+
+  int64_t bytes_copied = 0;
+  int64_t operations = 0;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kCopyBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < corpus->size(); ++i) {
+      std::vector<TableRange>& tables = (*corpus)[i].tables;
+      for (size_t j = 0; j < tables.size(); ++j) {
+        ReadableFontDataPtr slice;
+        slice.Attach(down_cast<ReadableFontData*>(
+            sources[i]->Slice(tables[j].offset, tables[j].length)));
+        WritableFontDataPtr copy;
+        if (mode == kShareCopyOnWrite) {
+          copy.Attach(WritableFontData::CreateCopyOnWriteFontData(slice));
+          bytes_copied += copy->Length();
+        } else {
+          copy.Attach(WritableFontData::CreateWritableFontData(
+              mode == kCopyToGrowable ? 0 : tables[j].length));
+          bytes_copied += slice->CopyTo(copy);
+        }
+        ++operations;
+      }
+    }
+  }
+  ReportBenchmark(name, operations, GetMicroseconds() - start, bytes_copied);
+  return bytes_copied;
+}
+
+bool BenchmarkTableCopies() {
+  std::vector<CorpusFont> corpus;
+  LoadCorpus(&corpus);
+  EXPECT_FALSE(corpus.empty());
+  fprintf(stderr, "%d corpus font files\n", (int)corpus.size());
+
+  EXPECT_EQ(TimeTableCopies("Copy tables (buffered)", &corpus, false,
+                            kCopyToFixed),
+            TimeTableCopies("Copy tables (direct)", &corpus, true,
+                            kCopyToFixed));
+  EXPECT_EQ(TimeTableCopies("Copy tables growable (buffered)", &corpus,
+                            false, kCopyToGrowable),
+            TimeTableCopies("Copy tables growable (direct)", &corpus,
+                            true, kCopyToGrowable));
+  EXPECT_EQ(TimeTableCopies("Copy tables (direct)", &corpus, true,
+                            kCopyToFixed),
+            TimeTableCopies("Share tables copy-on-write", &corpus, true,
+                            kShareCopyOnWrite));
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(CopyBenchmark, CorpusTables) {
+  ASSERT_TRUE(sfntly::BenchmarkTableCopies());
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/executor.h"
+#include "sfntly/port/memory_output_stream.h"
+#include "sfntly/port/thread_pool.h"
+#include "test/benchmark/benchmark_utils.h"
+#include "test/test_font_utils.h"
+
+namespace sfntly {
+
+const int32_t kExecutorBenchmarkThreads = 4;
+const int32_t kExecutorBenchmarkIndices = 4000000;
+const int32_t kExecutorBenchmarkGrainSize = 1000;
+const int32_t kExecutorBenchmarkLeafSize = 64;
+const int32_t kExecutorBenchmarkRounds = 10;
+
+// Sums a few cheap operations per index.
+class HashBody : public ParallelForBody {
+ public:
+  explicit HashBody(int32_t size) : sums_(size, 0) {}
+
+  virtual void Run(int32_t begin, int32_t end) {
+    for (int32_t i = begin; i < end; ++i) {
+      uint32_t x = (uint32_t)i * 2654435761U;
+      sums_[i] = (x ^ (x >> 15)) * 2246822519U;
+    }
+  }
+
+  int64_t Total() const {
+    int64_t total = 0;
+    for (size_t i = 0; i < sums_.size(); ++i) {
+      total += sums_[i];
+    }
+    return total;
+  }
+
+ private:
+  std::vector<uint32_t> sums_;
+};
+
+// Splits a range in two tasks of a nested group until it is small, as a
+// recursive algorithm would.
+class SplitTask : public Executor::Task {
+ public:
+  SplitTask(Executor* executor, int32_t begin, int32_t end)
+      : executor_(executor), begin_(begin), end_(end), sum_(0), tasks_(1) {}
+
+  virtual void Run() {
+    if (end_ - begin_ <= kExecutorBenchmarkLeafSize) {
+      for (int32_t i = begin_; i < end_; ++i) {
+        sum_ += (int64_t)i * i % 7;
+      }
+      return;
+    }
+    int32_t middle = begin_ + (end_ - begin_) / 2;
+    SplitTask low(executor_, begin_, middle);
+    SplitTask high(executor_, middle, end_);
+    TaskGroup group(executor_);
+    group.Add(&low);
+    group.Add(&high);
+    group.Wait();
+    sum_ = low.sum_ + high.sum_;
+    tasks_ += low.tasks_ + high.tasks_;
+  }
+
+  int64_t sum() const { return sum_; }
+  int64_t tasks() const { return tasks_; }
+
+ private:
+  Executor* executor_;
+  int32_t begin_;
+  int32_t end_;
+  int64_t sum_;
+  int64_t tasks_;
+};
+
+void TimeExecutor(const char* executor_name,
+                  Executor* executor,
+                  std::vector<FontBuilderArray>* builder_sets,
+                  FontFactory* factory,
+                  int64_t* expected_hash,
+                  int64_t* expected_sum) {
+  char name[96];
+  HashBody body(kExecutorBenchmarkIndices);
+  int64_t start = GetMicroseconds();
+  for (int32_t round = 0; round < kExecutorBenchmarkRounds; ++round) {
+    ParallelFor(executor, 0, kExecutorBenchmarkIndices,
+                kExecutorBenchmarkGrainSize, &body);
+  }
+  int64_t micros = GetMicroseconds() - start;
+  snprintf(name, sizeof(name), "ParallelFor index (%s)", executor_name);
+  ReportBenchmark(name,
+                  (int64_t)kExecutorBenchmarkIndices * kExecutorBenchmarkRounds,
+                  micros, 0);
+  if (*expected_hash == 0) {
+    *expected_hash = body.Total();
+  }
+  EXPECT_EQ(*expected_hash, body.Total());
+
+  int64_t tasks = 0;
+  start = GetMicroseconds();
+  for (int32_t round = 0; round < kExecutorBenchmarkRounds; ++round) {
+    SplitTask root(executor, 0, kExecutorBenchmarkIndices / 4);
+    root.Run();
+    tasks += root.tasks();
+    if (*expected_sum == 0) {
+      *expected_sum = root.sum();
+    }
+    EXPECT_EQ(*expected_sum, root.sum());
+  }
+  micros = GetMicroseconds() - start;
+  snprintf(name, sizeof(name), "Nested group task (%s)", executor_name);
+  ReportBenchmark(name, tasks, micros, 0);
+
+  // Build and serialize the corpus fonts with their table builds and
+  // checksums handed to the executor.
+  factory->SetExecutor(executor);
+  int64_t fonts = 0;
+  int64_t bytes = 0;
+  start = GetMicroseconds();
+  for (size_t i = 0; i < builder_sets->size(); ++i) {
+    FontBuilderArray* builders = &(builder_sets->at(i));
+    for (size_t j = 0; j < builders->size(); ++j) {
+      FontPtr font;
+      font.Attach(builders->at(j)->Build());
+      if (font == NULL) {
+        continue;
+      }
+      MemoryOutputStream output;
+      factory->SerializeFont(font, &output);
+      bytes += output.Size();
+      ++fonts;
+    }
+  }
+  micros = GetMicroseconds() - start;
+  factory->SetExecutor(NULL);
+  snprintf(name, sizeof(name), "Build and serialize font (%s)", executor_name);
+  ReportBenchmark(name, fonts, micros, bytes);
+}
+
+// Load every corpus font into builders with a builder for each table.
+void LoadCorpusBuilders(FontFactory* factory,
+                        const std::vector<ByteVector>& files,
+                        std::vector<FontBuilderArray>* builder_sets) {
+  builder_sets->clear();
+  builder_sets->resize(files.size());
+  for (size_t i = 0; i < files.size(); ++i) {
+    ByteVector bytes(files[i]);
+    factory->LoadFontsForBuilding(&bytes, &(builder_sets->at(i)));
+    for (size_t j = 0; j < builder_sets->at(i).size(); ++j) {
+      builder_sets->at(i)[j]->table_builders();
+    }
+  }
+}
+
+bool BenchmarkExecutors() {
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  std::vector<ByteVector> files(paths.size());
+  for (size_t i = 0; i < paths.size(); ++i) {
+    LoadFile(paths[i].c_str(), &files[i]);
+  }
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+
+  int64_t expected_hash = 0;
+  int64_t expected_sum = 0;
+  std::vector<FontBuilderArray> builder_sets;
+  LoadCorpusBuilders(factory, files, &builder_sets);
+  TimeExecutor("calling thread", NULL, &builder_sets, factory,
+               &expected_hash, &expected_sum);
+
+  ThreadPoolPtr pool = new ThreadPool(kExecutorBenchmarkThreads);
+  LoadCorpusBuilders(factory, files, &builder_sets);
+  TimeExecutor("thread pool", pool, &builder_sets, factory,
+               &expected_hash, &expected_sum);
+  pool = NULL;
+
+  WorkStealingSchedulerPtr scheduler =
+      new WorkStealingScheduler(kExecutorBenchmarkThreads);
+  LoadCorpusBuilders(factory, files, &builder_sets);
+  TimeExecutor("work stealing", scheduler, &builder_sets, factory,
+               &expected_hash, &expected_sum);
+  fprintf(stderr, "  %d threads, %lu tasks stolen between workers\n",
+          kExecutorBenchmarkThreads, (unsigned long)scheduler->steals());
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(ExecutorBenchmark, ParallelWork) {
+  ASSERT_TRUE(sfntly::BenchmarkExecutors());
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/file_input_stream.h"
+#include "sfntly/port/random_access_file_input_stream.h"
+#include "sfntly/port/type.h"
+#include "test/benchmark/benchmark_utils.h"
+
+namespace sfntly {
+
+const int32_t kFileLoadBenchmarkPasses = 4;
+
+// Load every corpus font from disk through the given kind of stream.
+template <typename Stream>
+int64_t TimeFileLoading(const char* name,
+                        FontFactory* factory,
+                        const std::vector<std::string>& paths) {
+  int64_t fonts_loaded = 0;
+  int64_t bytes_loaded = 0;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kFileLoadBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < paths.size(); ++i) {
+      Stream is;
+      if (!is.Open(paths[i].c_str())) {
+        continue;
+      }
+      bytes_loaded += is.Available();
+      FontArray fonts;
+      factory->LoadFonts(&is, &fonts);
+      fonts_loaded += fonts.size();
+    }
+  }
+  ReportBenchmark(name, (int64_t)kFileLoadBenchmarkPasses * paths.size(),
+                  GetMicroseconds() - start, bytes_loaded);
+  return fonts_loaded;
+}
+
+bool BenchmarkFileLoading() {
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  EXPECT_FALSE(paths.empty());
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+
+  EXPECT_EQ(TimeFileLoading<FileInputStream>(
+                "Load fonts (FileInputStream)", factory, paths),
+            TimeFileLoading<RandomAccessFileInputStream>(
+                "Load fonts (RandomAccessFileInputStream)", factory, paths));
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(FileLoadBenchmark, Corpus) {
+  ASSERT_TRUE(sfntly::BenchmarkFileLoading());
+}
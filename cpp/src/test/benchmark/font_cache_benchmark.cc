@@ -0,0 +1,101 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sfntly/font.h"
+#include "sfntly/font_cache.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/fingerprint.h"
+#include "sfntly/port/type.h"
+#include "test/benchmark/benchmark_utils.h"
+#include "test/test_font_utils.h"
+
+namespace sfntly {
+
+const int32_t kFontCacheBenchmarkPasses = 8;
+
+// Load every corpus font from memory over and over, as a subsetting server
+// receiving the same fonts does, and build their tables as a subsetter does.
+int64_t TimeRepeatedLoads(const char* name,
+                          FontCache* cache,
+                          const std::vector<ByteVector>& files) {
+  int64_t tables_found = 0;
+  int64_t bytes = 0;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kFontCacheBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < files.size(); ++i) {
+      // A subsetter gets a new factory for every request.
+      FontFactoryPtr factory;
+      factory.Attach(FontFactory::GetInstance());
+      factory->SetFontCache(cache);
+      FontArray fonts;
+      factory->LoadFonts(&(files[i][0]), files[i].size(), &fonts);
+      for (size_t j = 0; j < fonts.size(); ++j) {
+        tables_found += fonts[j]->GetTableMap()->size();
+      }
+      bytes += files[i].size();
+    }
+  }
+  ReportBenchmark(name, (int64_t)kFontCacheBenchmarkPasses * files.size(),
+                  GetMicroseconds() - start, bytes);
+  return tables_found;
+}
+
+bool BenchmarkFontCache() {
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  EXPECT_FALSE(paths.empty());
+  std::vector<ByteVector> files(paths.size());
+  size_t corpus_size = 0;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    LoadFile(paths[i].c_str(), &files[i]);
+    corpus_size += files[i].size();
+  }
+
+  ByteVector fingerprint;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kFontCacheBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < files.size(); ++i) {
+      Fingerprint128(&(files[i][0]), files[i].size(), &fingerprint);
+    }
+  }
+  ReportBenchmark("Fingerprint128", kFontCacheBenchmarkPasses * files.size(),
+                  GetMicroseconds() - start,
+                  (int64_t)kFontCacheBenchmarkPasses * corpus_size);
+
+  int64_t uncached = TimeRepeatedLoads("LoadFonts, no cache", NULL, files);
+  FontCachePtr cache = new FontCache(corpus_size);
+  int64_t cached = TimeRepeatedLoads("LoadFonts, cache", cache, files);
+  EXPECT_EQ(uncached, cached);
+  EXPECT_EQ(files.size(), cache->num_entries());
+  // With room for half of the corpus, a pass over all of it in order evicts
+  // every font before it is loaded again.
+  FontCachePtr small_cache = new FontCache(corpus_size / 2);
+  cached = TimeRepeatedLoads("LoadFonts, cache of half the corpus",
+                             small_cache, files);
+  EXPECT_EQ(uncached, cached);
+  EXPECT_GE(corpus_size / 2, small_cache->size());
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(FontCacheBenchmark, Corpus) {
+  ASSERT_TRUE(sfntly::BenchmarkFontCache());
+}
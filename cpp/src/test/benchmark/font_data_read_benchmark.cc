@@ -0,0 +1,95 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "sfntly/data/memory_byte_array.h"
+#include "sfntly/data/readable_font_data.h"
+#include "sfntly/port/type.h"
+#include "test/benchmark/benchmark_utils.h"
+#include "test/test_utils.h"
+
+namespace sfntly {
+
+const int32_t kReadBenchmarkSize = 1024 * 1024;
+const int32_t kReadBenchmarkPasses = 8;
+
+void FillReadBenchmarkArray(ByteArray* ba) {
+  for (int32_t i = 0; i < kReadBenchmarkSize; ++i) {
+    ba->Put(i, (byte_t)((i * 31 + 7) % 256));
+  }
+}
+
+// Sweep the data with the given reader and return a sum so the reads can not
+// be optimized away and both paths can be compared.
+template <typename ReadFunction>
+int64_t SweepFontData(const char* name,
+                      ReadableFontData* rfd,
+                      ReadFunction read,
+                      int32_t stride) {
+  int64_t sum = 0;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kReadBenchmarkPasses; ++pass) {
+    for (int32_t i = 0; i + stride <= rfd->Length(); i += stride) {
+      sum += read(rfd, i);
+    }
+  }
+  int64_t elapsed = GetMicroseconds() - start;
+  int64_t operations =
+      (int64_t)kReadBenchmarkPasses * (rfd->Length() / stride);
+  ReportBenchmark(name, operations, elapsed, operations * stride);
+  return sum;
+}
+
+int64_t ReadUShortAt(ReadableFontData* rfd, int32_t i) {
+  return rfd->ReadUShort(i);
+}
+
+int64_t ReadShortAt(ReadableFontData* rfd, int32_t i) {
+  return rfd->ReadShort(i);
+}
+
+int64_t ReadULongAt(ReadableFontData* rfd, int32_t i) {
+  return rfd->ReadULong(i);
+}
+
+int64_t ReadLongAt(ReadableFontData* rfd, int32_t i) {
+  return rfd->ReadLong(i);
+}
+
+bool BenchmarkReadableFontDataReads() {
+  ByteArrayPtr contiguous = new MemoryByteArray(kReadBenchmarkSize);
+  ByteArrayPtr non_contiguous = new NonContiguousByteArray(kReadBenchmarkSize);
+  FillReadBenchmarkArray(contiguous);
+  FillReadBenchmarkArray(non_contiguous);
+  ReadableFontDataPtr fast = new ReadableFontData(contiguous);
+  ReadableFontDataPtr slow = new ReadableFontData(non_contiguous);
+
+  EXPECT_EQ(SweepFontData("ReadUShort (per byte)", slow, ReadUShortAt, 2),
+            SweepFontData("ReadUShort (pointer)", fast, ReadUShortAt, 2));
+  EXPECT_EQ(SweepFontData("ReadShort (per byte)", slow, ReadShortAt, 2),
+            SweepFontData("ReadShort (pointer)", fast, ReadShortAt, 2));
+  EXPECT_EQ(SweepFontData("ReadULong (per byte)", slow, ReadULongAt, 4),
+            SweepFontData("ReadULong (pointer)", fast, ReadULongAt, 4));
+  EXPECT_EQ(SweepFontData("ReadLong (per byte)", slow, ReadLongAt, 4),
+            SweepFontData("ReadLong (pointer)", fast, ReadLongAt, 4));
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(FontDataBenchmark, ReadableFontDataReads) {
+  ASSERT_TRUE(sfntly::BenchmarkReadableFontDataReads());
+}
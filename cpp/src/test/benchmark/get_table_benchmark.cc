@@ -0,0 +1,189 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/type.h"
+#include "sfntly/tag.h"
+#include "test/benchmark/benchmark_utils.h"
+#include "test/platform_thread.h"
+
+namespace sfntly {
+
+const int32_t kGetTableBenchmarkPasses = 200;
+const int32_t kGetTableBenchmarkThreads = 4;
+
+// The tables looked up for every text measurement request.
+const int32_t kMeasurementTables[] = {
+  Tag::cmap, Tag::hmtx, Tag::glyf, Tag::loca
+};
+const size_t kNumMeasurementTables =
+    sizeof(kMeasurementTables) / sizeof(kMeasurementTables[0]);
+
+// Look up the measurement tables of every font.
+int64_t LookUpTables(const FontArray& fonts) {
+  int64_t found = 0;
+  for (int32_t pass = 0; pass < kGetTableBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < fonts.size(); ++i) {
+      for (size_t t = 0; t < kNumMeasurementTables; ++t) {
+        found += fonts[i]->GetTable(kMeasurementTables[t]) != NULL;
+      }
+    }
+  }
+  return found;
+}
+
+int64_t TimeGetTable(const char* name, const FontArray& fonts) {
+  int64_t start = GetMicroseconds();
+  int64_t found = LookUpTables(fonts);
+  ReportBenchmark(name,
+                  (int64_t)kGetTableBenchmarkPasses * fonts.size() *
+                      kNumMeasurementTables,
+                  GetMicroseconds() - start, 0);
+  return found;
+}
+
+// Look up the measurement tables of one font over and over, as when measuring
+// many runs of text in the same font.
+int64_t TimeGetTableOneFont(Font* font) {
+  int64_t found = 0;
+  int32_t lookups = kGetTableBenchmarkPasses * 1000;
+  int64_t start = GetMicroseconds();
+  for (int32_t i = 0; i < lookups; ++i) {
+    found += font->GetTable(kMeasurementTables[i % kNumMeasurementTables]) !=
+             NULL;
+  }
+  ReportBenchmark("Font::GetTable (one font)", lookups,
+                  GetMicroseconds() - start, 0);
+  return found;
+}
+
+class GetTableThread : public PlatformThread::Delegate {
+ public:
+  explicit GetTableThread(const FontArray* fonts) : fonts_(fonts), found_(0) {}
+
+  virtual void ThreadMain() { found_ = LookUpTables(*fonts_); }
+
+  int64_t found() const { return found_; }
+
+ private:
+  const FontArray* fonts_;
+  int64_t found_;
+
+  NO_COPY_AND_ASSIGN(GetTableThread);
+};
+
+// The same lookups from several threads sharing the fonts at once.
+int64_t TimeConcurrentGetTable(const FontArray& fonts) {
+  std::vector<GetTableThread*> threads;
+  std::vector<PlatformThreadHandle> handles(kGetTableBenchmarkThreads,
+                                            kNullThreadHandle);
+  int64_t start = GetMicroseconds();
+  for (int32_t i = 0; i < kGetTableBenchmarkThreads; ++i) {
+    threads.push_back(new GetTableThread(&fonts));
+    EXPECT_TRUE(PlatformThread::Create(threads[i], &(handles[i])));
+  }
+  int64_t found = 0;
+  for (int32_t i = 0; i < kGetTableBenchmarkThreads; ++i) {
+    PlatformThread::Join(handles[i]);
+  }
+  int64_t micros = GetMicroseconds() - start;
+  for (int32_t i = 0; i < kGetTableBenchmarkThreads; ++i) {
+    EXPECT_TRUE(i == 0 || threads[i]->found() == found);
+    found = threads[i]->found();
+    delete threads[i];
+  }
+  char name[64];
+  snprintf(name, sizeof(name), "Font::GetTable (%d threads)",
+           kGetTableBenchmarkThreads);
+  ReportBenchmark(name,
+                  (int64_t)kGetTableBenchmarkThreads *
+                      kGetTableBenchmarkPasses * fonts.size() *
+                      kNumMeasurementTables,
+                  micros, 0);
+  return found;
+}
+
+// The same lookups in maps of the given type holding the same tables, to
+// compare the flat TableMap with the std::map the fonts used before.
+template <typename Map>
+int64_t TimeFind(const char* name, const FontArray& fonts) {
+  std::vector<Map> maps(fonts.size());
+  for (size_t i = 0; i < fonts.size(); ++i) {
+    const TableMap* tables = fonts[i]->GetTableMap();
+    for (TableMap::const_iterator table = tables->begin(),
+                                  table_end = tables->end();
+                                  table != table_end; ++table) {
+      maps[i].insert(*table);
+    }
+  }
+  int64_t found = 0;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kGetTableBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < maps.size(); ++i) {
+      for (size_t t = 0; t < kNumMeasurementTables; ++t) {
+        typename Map::iterator table = maps[i].find(kMeasurementTables[t]);
+        found += table != maps[i].end() && table->second != NULL;
+      }
+    }
+  }
+  ReportBenchmark(name,
+                  (int64_t)kGetTableBenchmarkPasses * maps.size() *
+                      kNumMeasurementTables,
+                  GetMicroseconds() - start, 0);
+  return found;
+}
+
+bool BenchmarkGetTable() {
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  EXPECT_FALSE(paths.empty());
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontArray fonts;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    factory->LoadFonts(paths[i].c_str(), &fonts);
+  }
+
+  // Fonts that only ever build the measurement tables, as a text measurement
+  // service would.
+  int64_t found = TimeGetTable("Font::GetTable (first lookups)", fonts);
+  EXPECT_EQ(found, TimeGetTable("Font::GetTable (lazy font)", fonts));
+  EXPECT_EQ(found, TimeConcurrentGetTable(fonts));
+  EXPECT_LT(0, TimeGetTableOneFont(fonts[0]));
+
+  for (size_t i = 0; i < fonts.size(); ++i) {
+    fonts[i]->GetTableMap();
+  }
+  EXPECT_EQ(found, TimeGetTable("Font::GetTable (all built)", fonts));
+  EXPECT_EQ(found, TimeFind<TableMap>("TableMap::find", fonts));
+  EXPECT_EQ(found, (TimeFind<std::map<int32_t, TablePtr> >("std::map::find",
+                                                           fonts)));
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(GetTableBenchmark, Corpus) {
+  ASSERT_TRUE(sfntly::BenchmarkGetTable());
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/table/truetype/glyph_table.h"
+#include "sfntly/table/truetype/loca_table.h"
+#include "sfntly/tag.h"
+#include "test/benchmark/benchmark_utils.h"
+#include "test/platform_thread.h"
+#include "test/test_font_utils.h"
+
+namespace sfntly {
+
+const size_t kGlyphReadBenchmarkGlyphs = 20000;
+const int32_t kGlyphReadBenchmarkPasses = 20;
+const int32_t kGlyphReadBenchmarkMaxThreads = 4;
+
+typedef std::vector<Ptr<GlyphTable::SimpleGlyph> > SimpleGlyphList;
+
+// Reads every point of the glyphs through the accessors, each of which makes
+// sure the glyph is parsed first.
+int64_t ReadGlyphPoints(SimpleGlyphList* glyphs, int64_t* points) {
+  int64_t sum = 0;
+  for (size_t i = 0; i < glyphs->size(); ++i) {
+    GlyphTable::SimpleGlyph* glyph = (*glyphs)[i];
+    sum += glyph->Padding();
+    for (int32_t contour = 0; contour < glyph->NumberOfContours(); ++contour) {
+      for (int32_t point = 0; point < glyph->NumberOfPoints(contour);
+           ++point) {
+        sum += glyph->XCoordinate(contour, point) * 3 +
+               glyph->YCoordinate(contour, point) * 5 +
+               (glyph->OnCurve(contour, point) ? 1 : 0);
+        ++(*points);
+      }
+    }
+  }
+  return sum;
+}
+
+class GlyphReadThread : public PlatformThread::Delegate {
+ public:
+  GlyphReadThread(SimpleGlyphList* glyphs, int32_t passes)
+      : glyphs_(glyphs), passes_(passes), sum_(0), points_(0) {
+  }
+
+  virtual void ThreadMain() {
+    for (int32_t pass = 0; pass < passes_; ++pass) {
+      sum_ += ReadGlyphPoints(glyphs_, &points_);
+    }
+  }
+
+  int64_t sum() const { return sum_; }
+  int64_t points() const { return points_; }
+
+ private:
+  SimpleGlyphList* glyphs_;
+  int32_t passes_;
+  int64_t sum_;
+  int64_t points_;
+};
+
+// Get fresh, unparsed copies of the simple glyphs of the corpus fonts.
+void GetSimpleGlyphs(FontArray* fonts, SimpleGlyphList* glyphs) {
+  glyphs->clear();
+  for (size_t i = 0; i < fonts->size(); ++i) {
+    Font* font = (*fonts)[i];
+    GlyphTablePtr glyph_table =
+        down_cast<GlyphTable*>(font->GetTable(Tag::glyf));
+    LocaTablePtr loca_table = down_cast<LocaTable*>(font->GetTable(Tag::loca));
+    if (glyph_table == NULL || loca_table == NULL) {
+      continue;
+    }
+    for (int32_t id = 0; id < loca_table->num_glyphs(); ++id) {
+      if (glyphs->size() == kGlyphReadBenchmarkGlyphs) {
+        return;
+      }
+      int32_t length = loca_table->GlyphLength(id);
+      if (length <= 0) {
+        continue;
+      }
+      GlyphPtr glyph;
+      glyph.Attach(glyph_table->GetGlyph(loca_table->GlyphOffset(id), length));
+      if (glyph != NULL && glyph->GlyphType() == GlyphType::kSimple) {
+        glyphs->push_back(down_cast<GlyphTable::SimpleGlyph*>(glyph.p_));
+      }
+    }
+  }
+}
+
+// Have several threads read the same glyphs at once, first while they still
+// have to be parsed and then once they are. Every thread must see the same
+// points.
+void TimeConcurrentReads(FontArray* fonts, int32_t num_threads) {
+  SimpleGlyphList glyphs;
+  GetSimpleGlyphs(fonts, &glyphs);
+  int64_t points = 0;
+  SimpleGlyphList reference_glyphs;
+  GetSimpleGlyphs(fonts, &reference_glyphs);
+  int64_t expected = ReadGlyphPoints(&reference_glyphs, &points);
+
+  const int32_t kPasses[] = { 1, kGlyphReadBenchmarkPasses };
+  const char* kNames[] = { "Glyph first read", "Glyph read" };
+  for (int32_t phase = 0; phase < 2; ++phase) {
+    std::vector<GlyphReadThread*> threads;
+    std::vector<PlatformThreadHandle> handles(num_threads, kNullThreadHandle);
+    int64_t start = GetMicroseconds();
+    for (int32_t i = 0; i < num_threads; ++i) {
+      threads.push_back(new GlyphReadThread(&glyphs, kPasses[phase]));
+      EXPECT_TRUE(PlatformThread::Create(threads[i], &(handles[i])));
+    }
+    int64_t read_points = 0;
+    for (int32_t i = 0; i < num_threads; ++i) {
+      PlatformThread::Join(handles[i]);
+      EXPECT_EQ(expected * kPasses[phase], threads[i]->sum());
+      read_points += threads[i]->points();
+      delete threads[i];
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "%s (%d threads)", kNames[phase],
+             num_threads);
+    ReportBenchmark(name, read_points, GetMicroseconds() - start, 0);
+  }
+}
+
+bool BenchmarkGlyphReads() {
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontArray fonts;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    ByteVector bytes;
+    LoadFile(paths[i].c_str(), &bytes);
+    FontArray loaded;
+    factory->LoadFonts(&bytes, &loaded);
+    fonts.insert(fonts.end(), loaded.begin(), loaded.end());
+  }
+  EXPECT_FALSE(fonts.empty());
+  for (int32_t threads = 1; threads <= kGlyphReadBenchmarkMaxThreads;
+       threads *= 2) {
+    TimeConcurrentReads(&fonts, threads);
+  }
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(GlyphReadBenchmark, ConcurrentReaders) {
+  ASSERT_TRUE(sfntly::BenchmarkGlyphReads());
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "sfntly/data/writable_font_data.h"
+#include "sfntly/port/type.h"
+#include "test/benchmark/benchmark_utils.h"
+
+namespace sfntly {
+
+const int32_t kGrowBenchmarkSize = 32 * 1024 * 1024;
+const int32_t kGrowBenchmarkChunk = 1000;
+
+// Append chunks to growable font data of unknown final size, as building a
+// large glyf table does.
+int64_t TimeGrowth(const char* name, bool segmented) {
+  ByteVector chunk(kGrowBenchmarkChunk);
+  for (int32_t i = 0; i < kGrowBenchmarkChunk; ++i) {
+    chunk[i] = (byte_t)i;
+  }
+  int64_t start = GetMicroseconds();
+  WritableFontDataPtr wfd;
+  wfd.Attach(WritableFontData::CreateWritableFontData(0, segmented));
+  int32_t operations = 0;
+  for (int32_t index = 0; index < kGrowBenchmarkSize;
+       index += kGrowBenchmarkChunk, ++operations) {
+    wfd->WriteBytes(index, &chunk);
+  }
+  ReportBenchmark(name, operations, GetMicroseconds() - start, wfd->Length());
+  return wfd->Checksum();
+}
+
+bool BenchmarkGrowableFontData() {
+  EXPECT_EQ(TimeGrowth("Grow 32MB (contiguous)", false),
+            TimeGrowth("Grow 32MB (segmented)", true));
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(GrowableByteArrayBenchmark, Growth) {
+  ASSERT_TRUE(sfntly::BenchmarkGrowableFontData());
+}
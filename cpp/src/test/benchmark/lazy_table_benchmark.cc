@@ -0,0 +1,77 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/type.h"
+#include "sfntly/tag.h"
+#include "test/benchmark/benchmark_utils.h"
+
+namespace sfntly {
+
+const int32_t kLazyTableBenchmarkPasses = 4;
+
+// Load every corpus font and either look up the few tables a text shaper
+// needs first or materialize all of them, reporting the cost per font file.
+int64_t TimeTableAccess(const char* name,
+                        FontFactory* factory,
+                        const std::vector<std::string>& paths,
+                        bool all_tables) {
+  int64_t tables_built = 0;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kLazyTableBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < paths.size(); ++i) {
+      FontArray fonts;
+      factory->LoadFonts(paths[i].c_str(), &fonts);
+      for (size_t j = 0; j < fonts.size(); ++j) {
+        if (all_tables) {
+          tables_built += fonts[j]->GetTableMap()->size();
+        } else {
+          tables_built += fonts[j]->GetTable(Tag::cmap) != NULL;
+          tables_built += fonts[j]->GetTable(Tag::hmtx) != NULL;
+        }
+      }
+    }
+  }
+  ReportBenchmark(name, (int64_t)kLazyTableBenchmarkPasses * paths.size(),
+                  GetMicroseconds() - start, 0);
+  return tables_built;
+}
+
+bool BenchmarkLazyTables() {
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  EXPECT_FALSE(paths.empty());
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+
+  int64_t some_tables =
+      TimeTableAccess("Load + GetTable(cmap, hmtx)", factory, paths, false);
+  int64_t all_tables =
+      TimeTableAccess("Load + GetTableMap()", factory, paths, true);
+  EXPECT_LT(some_tables, all_tables);
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(LazyTableBenchmark, Corpus) {
+  ASSERT_TRUE(sfntly::BenchmarkLazyTables());
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sample/chromium/subsetter_impl.h"
+#include "sfntly/port/object_statistics.h"
+#include "sfntly/port/refcount.h"
+#include "sfntly/port/type.h"
+#include "test/benchmark/benchmark_utils.h"
+#include "test/platform_thread.h"
+#include "test/test_font_utils.h"
+
+namespace sfntly {
+
+const int32_t kStatisticsBenchmarkSnapshots = 2000;
+const unsigned int kStatisticsBenchmarkGlyphs = 64;
+const size_t kStatisticsBenchmarkTopTypes = 10;
+const int32_t kStatisticsBenchmarkObjects = 1000000;
+const int32_t kStatisticsBenchmarkThreads = 4;
+
+class CountedObject : public RefCounted<CountedObject> {
+};
+
+// Constructs and destroys objects of one type, as every thread of a program
+// does with the headers, slices and tables of the fonts it works on.
+class CountingThread : public PlatformThread::Delegate {
+ public:
+  CountingThread() {}
+
+  virtual void ThreadMain() {
+    for (int32_t i = 0; i < kStatisticsBenchmarkObjects; ++i) {
+      Ptr<CountedObject> object = new CountedObject();
+    }
+  }
+
+ private:
+  NO_COPY_AND_ASSIGN(CountingThread);
+};
+
+// Snapshot and diff the object statistics around every subset run of the
+// corpus, and list the types the runs construct most with the most objects of
+// each any run had alive at once.
+int64_t ProfileSubsetCycles(std::vector<ByteVector>* corpus) {
+  std::vector<unsigned int> glyph_ids;
+  for (unsigned int i = 0; i < kStatisticsBenchmarkGlyphs; ++i) {
+    glyph_ids.push_back(i);
+  }
+  int64_t output_bytes = 0;
+  int64_t operations = 0;
+  ObjectStatistics::EntryList totals;
+  for (size_t i = 0; i < corpus->size(); ++i) {
+    ObjectStatistics::EntryList before, after, diff;
+    ObjectStatistics::ResetPeaks();
+    ObjectStatistics::Snapshot(&before);
+    {
+      SubsetterImpl subsetter;
+      if (!subsetter.LoadFont(NULL, &((*corpus)[i][0]), (*corpus)[i].size())) {
+        continue;
+      }
+      unsigned char* output = NULL;
+      int length = subsetter.SubsetFont(&(glyph_ids[0]), glyph_ids.size(),
+                                        &output);
+      if (length > 0) {
+        output_bytes += length;
+        delete[] output;
+      }
+    }
+    ObjectStatistics::Snapshot(&after);
+    ObjectStatistics::Diff(before, after, &diff);
+    for (size_t j = 0; j < diff.size(); ++j) {
+      size_t k = 0;
+      while (k < totals.size() && totals[k].type_name != diff[j].type_name) {
+        ++k;
+      }
+      if (k == totals.size()) {
+        totals.push_back(ObjectStatistics::Entry());
+        totals.back().type_name = diff[j].type_name;
+      }
+      totals[k].total += diff[j].total;
+      totals[k].peak = std::max(totals[k].peak, diff[j].peak);
+    }
+    ++operations;
+  }
+
+  ObjectStatistics::SortByTotal(&totals);
+  int64_t objects = 0;
+  for (size_t i = 0; i < totals.size(); ++i) {
+    objects += totals[i].total;
+  }
+  fprintf(stderr, "  %.0f objects/subset run, most constructed:\n",
+          operations ? (double)objects / operations : 0.0);
+  for (size_t i = 0; i < totals.size() && i < kStatisticsBenchmarkTopTypes;
+       ++i) {
+    fprintf(stderr, "  %10.1f/run  %6d peak  %s\n",
+            (double)totals[i].total / operations, (int)totals[i].peak,
+            totals[i].type_name.c_str());
+  }
+  return output_bytes;
+}
+
+// Time constructing and destroying counted objects on several threads at
+// once.
+void TimeCountedObjects(int32_t num_threads) {
+  std::vector<CountingThread*> threads;
+  std::vector<PlatformThreadHandle> handles(num_threads, kNullThreadHandle);
+  int64_t start = GetMicroseconds();
+  for (int32_t i = 0; i < num_threads; ++i) {
+    threads.push_back(new CountingThread());
+    EXPECT_TRUE(PlatformThread::Create(threads[i], &(handles[i])));
+  }
+  for (int32_t i = 0; i < num_threads; ++i) {
+    PlatformThread::Join(handles[i]);
+    delete threads[i];
+  }
+  char name[64];
+  snprintf(name, sizeof(name), "Counted object new+delete (%d threads)",
+           num_threads);
+  ReportBenchmark(name, (int64_t)num_threads * kStatisticsBenchmarkObjects,
+                  GetMicroseconds() - start, 0);
+}
+
+// Time taking snapshots of a registry holding every type of the library the
+// corpus touches.
+void TimeSnapshots() {
+  ObjectStatistics::EntryList snapshot;
+  int64_t start = GetMicroseconds();
+  for (int32_t i = 0; i < kStatisticsBenchmarkSnapshots; ++i) {
+    ObjectStatistics::Snapshot(&snapshot);
+  }
+  ReportBenchmark("Object statistics snapshot",
+                  kStatisticsBenchmarkSnapshots, GetMicroseconds() - start, 0);
+  fprintf(stderr, "  %d types\n", (int)snapshot.size());
+}
+
+bool BenchmarkObjectStatistics() {
+  // Also timed without statistics, to compare.
+  TimeCountedObjects(1);
+  TimeCountedObjects(kStatisticsBenchmarkThreads);
+  if (!ObjectStatistics::Enabled()) {
+    fprintf(stderr, "Object statistics are not enabled in this build\n");
+    return true;
+  }
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  std::vector<ByteVector> corpus;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    corpus.push_back(ByteVector());
+    LoadFile(paths[i].c_str(), &(corpus.back()));
+  }
+  EXPECT_FALSE(corpus.empty());
+  EXPECT_LT(0, ProfileSubsetCycles(&corpus));
+  TimeSnapshots();
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(ObjectStatisticsBenchmark, SubsetProfile) {
+  ASSERT_TRUE(sfntly::BenchmarkObjectStatistics());
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/random_access_file_input_stream.h"
+#include "sfntly/port/type.h"
+#include "sfntly/tag.h"
+#include "test/benchmark/benchmark_utils.h"
+
+namespace sfntly {
+
+const int32_t kOpenBenchmarkPasses = 4;
+
+// Open every corpus font file, mapped or through positional reads, with the
+// factory's current table filter and report the cost per file.
+int64_t TimeFontOpening(const char* name,
+                        FontFactory* factory,
+                        const std::vector<std::string>& paths,
+                        bool mapped) {
+  int64_t tables_loaded = 0;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kOpenBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < paths.size(); ++i) {
+      FontArray fonts;
+      if (mapped) {
+        factory->LoadFonts(paths[i].c_str(), &fonts);
+      } else {
+        RandomAccessFileInputStream is;
+        if (is.Open(paths[i].c_str())) {
+          factory->LoadFonts(&is, &fonts);
+        }
+      }
+      for (size_t j = 0; j < fonts.size(); ++j) {
+        tables_loaded += fonts[j]->num_tables();
+      }
+    }
+  }
+  ReportBenchmark(name, (int64_t)kOpenBenchmarkPasses * paths.size(),
+                  GetMicroseconds() - start, 0);
+  return tables_loaded;
+}
+
+// Open every corpus font file mapped through font builders, the way LoadFonts
+// did before fonts were read straight from the data.
+int64_t TimeFontOpeningForBuilding(const char* name,
+                                   FontFactory* factory,
+                                   const std::vector<std::string>& paths) {
+  int64_t tables_loaded = 0;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kOpenBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < paths.size(); ++i) {
+      FontBuilderArray builders;
+      factory->LoadFontsForBuilding(paths[i].c_str(), &builders);
+      for (size_t j = 0; j < builders.size(); ++j) {
+        FontPtr font;
+        font.Attach(builders[j]->Build());
+        tables_loaded += font->num_tables();
+      }
+    }
+  }
+  ReportBenchmark(name, (int64_t)kOpenBenchmarkPasses * paths.size(),
+                  GetMicroseconds() - start, 0);
+  return tables_loaded;
+}
+
+bool BenchmarkFontOpening() {
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  EXPECT_FALSE(paths.empty());
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+
+  int64_t all_tables =
+      TimeFontOpening("Open mapped, all tables", factory, paths, true);
+  EXPECT_EQ(all_tables,
+            TimeFontOpening("Open pread, all tables", factory, paths, false));
+  EXPECT_EQ(all_tables,
+            TimeFontOpeningForBuilding("Open mapped, builder + Build()",
+                                       factory, paths));
+
+  IntegerSet enumeration_tables;
+  enumeration_tables.insert(Tag::name);
+  enumeration_tables.insert(Tag::OS_2);
+  enumeration_tables.insert(Tag::cmap);
+  factory->SetTableFilter(enumeration_tables);
+  int64_t some_tables =
+      TimeFontOpening("Open mapped, name/OS/2/cmap", factory, paths, true);
+  EXPECT_EQ(some_tables,
+            TimeFontOpening("Open pread, name/OS/2/cmap", factory, paths,
+                            false));
+  EXPECT_LT(some_tables, all_tables);
+
+  factory->SetTableFilter(IntegerSet());
+  EXPECT_EQ(0, TimeFontOpening("Open mapped, directory only", factory, paths,
+                               true));
+  EXPECT_EQ(0, TimeFontOpening("Open pread, directory only", factory, paths,
+                               false));
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(OpenBenchmark, Corpus) {
+  ASSERT_TRUE(sfntly::BenchmarkFontOpening());
+}
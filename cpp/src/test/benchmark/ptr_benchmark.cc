@@ -0,0 +1,113 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sample/chromium/subsetter_impl.h"
+#include "sfntly/port/refcount.h"
+#include "sfntly/port/type.h"
+#include "test/benchmark/benchmark_utils.h"
+#include "test/counting_ref_count_policy.h"
+#include "test/test_font_utils.h"
+
+namespace sfntly {
+
+const int32_t kPtrBenchmarkVectors = 20000;
+const int32_t kPtrBenchmarkVectorSize = 64;
+const int32_t kPtrBenchmarkPasses = 4;
+const unsigned int kPtrBenchmarkGlyphs = 64;
+
+class PtrBenchmarkObject
+    : public RefCounted<PtrBenchmarkObject, CountingRefCountPolicy> {
+};
+
+// Fill vectors of smart pointers without reserving room for them, so that
+// every reallocation transfers the pointers already stored.
+size_t TimeVectorGrowth() {
+  Ptr<PtrBenchmarkObject> object = new PtrBenchmarkObject();
+  size_t stored = 0;
+  size_t updates = *CountingRefCountPolicy::updates();
+  int64_t start = GetMicroseconds();
+  for (int32_t i = 0; i < kPtrBenchmarkVectors; ++i) {
+    std::vector<Ptr<PtrBenchmarkObject> > pointers;
+    for (int32_t j = 0; j < kPtrBenchmarkVectorSize; ++j) {
+      pointers.push_back(object);
+    }
+    stored += pointers.size();
+  }
+  int64_t elapsed = GetMicroseconds() - start;
+  updates = *CountingRefCountPolicy::updates() - updates;
+  ReportBenchmark("Ptr vector growth", stored, elapsed, 0);
+  fprintf(stderr, "  %.2f reference count updates/pointer\n",
+          (double)updates / stored);
+  return stored;
+}
+
+// Load, subset and serialize every font of the corpus.
+int64_t TimeSubsetting(std::vector<ByteVector>* corpus) {
+  std::vector<unsigned int> glyph_ids;
+  for (unsigned int i = 0; i < kPtrBenchmarkGlyphs; ++i) {
+    glyph_ids.push_back(i);
+  }
+  int64_t output_bytes = 0;
+  int64_t operations = 0;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kPtrBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < corpus->size(); ++i) {
+      SubsetterImpl subsetter;
+      if (!subsetter.LoadFont(NULL, &((*corpus)[i][0]), (*corpus)[i].size())) {
+        continue;
+      }
+      unsigned char* output = NULL;
+      int length = subsetter.SubsetFont(&(glyph_ids[0]), glyph_ids.size(),
+                                        &output);
+      if (length > 0) {
+        output_bytes += length;
+        delete[] output;
+      }
+      ++operations;
+    }
+  }
+  int64_t elapsed = GetMicroseconds() - start;
+  ReportBenchmark("Load+subset+serialize", operations, elapsed, output_bytes);
+  return output_bytes;
+}
+
+bool BenchmarkPtrTransfers() {
+  EXPECT_EQ((size_t)kPtrBenchmarkVectors * kPtrBenchmarkVectorSize,
+            TimeVectorGrowth());
+
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  std::vector<ByteVector> corpus;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    corpus.push_back(ByteVector());
+    LoadFile(paths[i].c_str(), &(corpus.back()));
+  }
+  EXPECT_FALSE(corpus.empty());
+  EXPECT_LT(0, TimeSubsetting(&corpus));
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(PtrBenchmark, Transfers) {
+  ASSERT_TRUE(sfntly::BenchmarkPtrTransfers());
+}
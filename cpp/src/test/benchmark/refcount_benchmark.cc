@@ -0,0 +1,113 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sample/chromium/subsetter_impl.h"
+#include "sfntly/port/refcount.h"
+#include "sfntly/port/type.h"
+#include "test/benchmark/benchmark_utils.h"
+#include "test/test_font_utils.h"
+
+namespace sfntly {
+
+const int32_t kRefCountBenchmarkCopies = 4000000;
+const int32_t kRefCountBenchmarkPasses = 4;
+const unsigned int kRefCountBenchmarkGlyphs = 64;
+
+template <typename RefCountPolicy>
+class CountedObject
+    : public RefCounted<CountedObject<RefCountPolicy>, RefCountPolicy> {
+};
+
+// Copy and drop smart pointers as container copies and temporaries do.
+template <typename RefCountPolicy>
+size_t TimePtrCopies(const char* name) {
+  typedef Ptr<CountedObject<RefCountPolicy> > CountedPtr;
+  CountedPtr object = new CountedObject<RefCountPolicy>();
+  std::vector<CountedPtr> copies(16);
+  int64_t start = GetMicroseconds();
+  for (int32_t i = 0; i < kRefCountBenchmarkCopies; ++i) {
+    copies[i & 15] = object;
+    copies[(i + 8) & 15] = NULL;
+  }
+  ReportBenchmark(name, kRefCountBenchmarkCopies, GetMicroseconds() - start,
+                  0);
+  return object->ref_count_;
+}
+
+// Load, subset and serialize every font of the corpus with the reference
+// count policy the library was built with.
+int64_t TimeSubsetCycles(std::vector<ByteVector>* corpus) {
+  std::vector<unsigned int> glyph_ids;
+  for (unsigned int i = 0; i < kRefCountBenchmarkGlyphs; ++i) {
+    glyph_ids.push_back(i);
+  }
+  int64_t output_bytes = 0;
+  int64_t operations = 0;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kRefCountBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < corpus->size(); ++i) {
+      SubsetterImpl subsetter;
+      if (!subsetter.LoadFont(NULL, &((*corpus)[i][0]), (*corpus)[i].size())) {
+        continue;
+      }
+      unsigned char* output = NULL;
+      int length = subsetter.SubsetFont(&(glyph_ids[0]), glyph_ids.size(),
+                                        &output);
+      if (length > 0) {
+        output_bytes += length;
+        delete[] output;
+      }
+      ++operations;
+    }
+  }
+#if defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+  const char* name = "Load+subset+serialize (thread confined)";
+#else
+  const char* name = "Load+subset+serialize (atomic)";
+#endif
+  ReportBenchmark(name, operations, GetMicroseconds() - start, output_bytes);
+  return output_bytes;
+}
+
+bool BenchmarkRefCounting() {
+  size_t atomic_count = TimePtrCopies<AtomicRefCountPolicy>(
+      "Ptr copy (atomic)");
+  EXPECT_EQ(atomic_count, TimePtrCopies<ThreadConfinedRefCountPolicy>(
+      "Ptr copy (thread confined)"));
+
+  // The library uses a single policy, chosen when it is built; build with
+  // -DSFNTLY_THREAD_CONFINED_REFCOUNT=ON to time the other one.
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  std::vector<ByteVector> corpus;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    corpus.push_back(ByteVector());
+    LoadFile(paths[i].c_str(), &(corpus.back()));
+  }
+  EXPECT_FALSE(corpus.empty());
+  EXPECT_LT(0, TimeSubsetCycles(&corpus));
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(RefCountBenchmark, Policies) {
+  ASSERT_TRUE(sfntly::BenchmarkRefCounting());
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sfntly/data/gather_output.h"
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/memory_output_stream.h"
+#if !defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+#include "sfntly/port/thread_pool.h"
+#endif
+#include "sfntly/port/type.h"
+#include "test/benchmark/benchmark_utils.h"
+#include "test/test_font_utils.h"
+
+namespace sfntly {
+
+const int32_t kSerializeBenchmarkPasses = 8;
+
+void LoadCorpusFonts(FontFactory* factory, FontArray* fonts) {
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  for (size_t i = 0; i < paths.size(); ++i) {
+    factory->LoadFonts(paths[i].c_str(), fonts);
+  }
+}
+
+bool BenchmarkSerialization() {
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontArray fonts;
+  LoadCorpusFonts(factory, &fonts);
+  EXPECT_FALSE(fonts.empty());
+  int64_t operations = (int64_t)kSerializeBenchmarkPasses * fonts.size();
+
+  // Stream into a growing vector, then copy out as the Chromium wrapper did.
+  int64_t stream_bytes = 0;
+  int64_t start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kSerializeBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < fonts.size(); ++i) {
+      MemoryOutputStream os;
+      factory->SerializeFont(fonts[i], &os);
+      ByteVector copy(os.Get(), os.Get() + os.Size());
+      stream_bytes += copy.size();
+    }
+  }
+  ReportBenchmark("Serialize to MemoryOutputStream + copy", operations,
+                  GetMicroseconds() - start, stream_bytes);
+
+  int64_t gather_bytes = 0;
+  size_t segments = 0;
+  start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kSerializeBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < fonts.size(); ++i) {
+      GatherOutput output;
+      factory->SerializeFont(fonts[i], &output);
+      ByteVector copy(output.Size());
+      gather_bytes += output.CopyTo(&(copy[0]), copy.size());
+      segments += output.segments().size();
+    }
+  }
+  ReportBenchmark("Serialize to GatherOutput + copy", operations,
+                  GetMicroseconds() - start, gather_bytes);
+  fprintf(stderr, "  %.1f segments/font\n", (double)segments / operations);
+  EXPECT_EQ(stream_bytes, gather_bytes);
+
+  int64_t direct_bytes = 0;
+  start = GetMicroseconds();
+  for (int32_t pass = 0; pass < kSerializeBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < fonts.size(); ++i) {
+      size_t size = factory->SerializedFontSize(fonts[i]);
+      byte_t* buffer = new byte_t[size];
+      direct_bytes += factory->SerializeFontTo(fonts[i], buffer, size);
+      delete[] buffer;
+    }
+  }
+  ReportBenchmark("Serialize to exact-size buffer", operations,
+                  GetMicroseconds() - start, direct_bytes);
+  EXPECT_EQ(stream_bytes, direct_bytes);
+  return true;
+}
+
+// Load the corpus fonts afresh, so no table checksum is known yet, and
+// serialize each into a buffer with the given checksum settings.
+int64_t TimeChecksummedSerialization(const char* name,
+                                     const std::vector<std::string>& paths,
+                                     Executor* executor,
+                                     bool checksums) {
+  int64_t bytes = 0;
+  int64_t operations = 0;
+  int64_t micros = 0;
+  for (int32_t pass = 0; pass < kSerializeBenchmarkPasses; ++pass) {
+    FontFactoryPtr factory;
+    factory.Attach(FontFactory::GetInstance());
+    factory->SetExecutor(executor);
+    factory->ComputeChecksums(checksums);
+    FontArray fonts;
+    for (size_t i = 0; i < paths.size(); ++i) {
+      factory->LoadFonts(paths[i].c_str(), &fonts);
+    }
+    for (size_t i = 0; i < fonts.size(); ++i) {
+      fonts[i]->GetTableMap();
+    }
+    int64_t start = GetMicroseconds();
+    for (size_t i = 0; i < fonts.size(); ++i) {
+      size_t size = factory->SerializedFontSize(fonts[i]);
+      ByteVector buffer(size);
+      bytes += factory->SerializeFontTo(fonts[i], &(buffer[0]), size);
+    }
+    micros += GetMicroseconds() - start;
+    operations += fonts.size();
+  }
+  ReportBenchmark(name, operations, micros, bytes);
+  return bytes;
+}
+
+bool BenchmarkChecksums() {
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  EXPECT_FALSE(paths.empty());
+  // The largest quarter of the corpus, where the checksums cost the most.
+  std::vector<std::pair<int64_t, std::string> > sized_paths;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    ByteVector data;
+    LoadFile(paths[i].c_str(), &data);
+    sized_paths.push_back(std::make_pair((int64_t)data.size(), paths[i]));
+  }
+  std::sort(sized_paths.rbegin(), sized_paths.rend());
+  std::vector<std::string> large_paths;
+  for (size_t i = 0; i < (sized_paths.size() + 3) / 4; ++i) {
+    large_paths.push_back(sized_paths[i].second);
+  }
+
+  int64_t checked = TimeChecksummedSerialization(
+      "Serialize large fonts, checksums", large_paths, NULL, true);
+#if !defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+  ThreadPoolPtr pool = new ThreadPool(4);
+  EXPECT_EQ(checked, TimeChecksummedSerialization(
+      "Serialize large fonts, 4 checksum threads", large_paths, pool,
+      true));
+#endif
+  EXPECT_EQ(checked, TimeChecksummedSerialization(
+      "Serialize large fonts, no checksums", large_paths, NULL, false));
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(SerializeBenchmark, Corpus) {
+  ASSERT_TRUE(sfntly::BenchmarkSerialization());
+}
+
+TEST(SerializeBenchmark, Checksums) {
+  ASSERT_TRUE(sfntly::BenchmarkChecksums());
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/thread_pool.h"
+#include "sfntly/port/type.h"
+#include "sfntly/table/truetype/glyph_table.h"
+#include "sfntly/table/truetype/loca_table.h"
+#include "sfntly/tag.h"
+#include "test/benchmark/benchmark_utils.h"
+
+namespace sfntly {
+
+const int32_t kTableBuildBenchmarkPasses = 4;
+const int32_t kTableBuildBenchmarkThreads = 4;
+
+// Make a builder for the font whose glyf and loca tables are rebuilt from
+// glyph builders, as after subsetting, and whose other tables are copied.
+CALLER_ATTACH Font::Builder* NewRebuiltFontBuilder(FontFactory* factory,
+                                                   Font* font) {
+  FontBuilderPtr font_builder;
+  font_builder.Attach(factory->NewFontBuilder());
+  const TableMap* tables = font->GetTableMap();
+  for (TableMap::const_iterator table = tables->begin(),
+                                table_end = tables->end();
+                                table != table_end; ++table) {
+    if (table->first != Tag::glyf && table->first != Tag::loca) {
+      font_builder->NewTableBuilder(table->first,
+                                    table->second->ReadFontData());
+    }
+  }
+  GlyphTablePtr glyph_table = down_cast<GlyphTable*>(font->GetTable(Tag::glyf));
+  LocaTablePtr loca_table = down_cast<LocaTable*>(font->GetTable(Tag::loca));
+  if (glyph_table == NULL || loca_table == NULL) {
+    return font_builder.Detach();
+  }
+  GlyphTableBuilderPtr glyph_table_builder =
+      down_cast<GlyphTable::Builder*>(font_builder->NewTableBuilder(Tag::glyf));
+  LocaTableBuilderPtr loca_table_builder =
+      down_cast<LocaTable::Builder*>(font_builder->NewTableBuilder(Tag::loca));
+  GlyphTable::GlyphBuilderList* glyph_builders =
+      glyph_table_builder->GlyphBuilders();
+  for (int32_t glyph_id = 0; glyph_id < loca_table->num_glyphs(); ++glyph_id) {
+    GlyphPtr glyph;
+    glyph.Attach(glyph_table->GetGlyph(loca_table->GlyphOffset(glyph_id),
+                                       loca_table->GlyphLength(glyph_id)));
+    ReadableFontDataPtr data = glyph->ReadFontData();
+    WritableFontDataPtr copy_data;
+    copy_data.Attach(WritableFontData::CreateWritableFontData(data->Length()));
+    data->CopyTo(copy_data);
+    GlyphBuilderPtr glyph_builder;
+    glyph_builder.Attach(glyph_table_builder->GlyphBuilder(copy_data));
+    glyph_builders->push_back(glyph_builder);
+  }
+  IntegerList loca_list;
+  glyph_table_builder->GenerateLocaList(&loca_list);
+  loca_table_builder->SetLocaList(&loca_list);
+  return font_builder.Detach();
+}
+
+// Time Font::Builder::Build() of rebuilt builders for the fonts, on the
+// factory's thread pool if it has one.
+int64_t TimeTableBuilding(const char* name,
+                          FontFactory* factory,
+                          FontArray* fonts) {
+  int64_t bytes = 0;
+  int64_t micros = 0;
+  for (int32_t pass = 0; pass < kTableBuildBenchmarkPasses; ++pass) {
+    for (size_t i = 0; i < fonts->size(); ++i) {
+      FontBuilderPtr builder;
+      builder.Attach(NewRebuiltFontBuilder(factory, fonts->at(i)));
+      int64_t start = GetMicroseconds();
+      FontPtr font;
+      font.Attach(builder->Build());
+      micros += GetMicroseconds() - start;
+      bytes += font->GetTable(Tag::glyf) ?
+               font->GetTable(Tag::glyf)->DataLength() : 0;
+    }
+  }
+  ReportBenchmark(name, (int64_t)kTableBuildBenchmarkPasses * fonts->size(),
+                  micros, bytes);
+  return bytes;
+}
+
+bool BenchmarkTableBuilding() {
+  std::vector<std::string> paths;
+  GetCorpusFontFiles(&paths);
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontArray fonts;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    factory->LoadFonts(paths[i].c_str(), &fonts);
+  }
+  EXPECT_FALSE(fonts.empty());
+
+  int64_t serial_bytes = TimeTableBuilding("Build rebuilt glyf, serial",
+                                           factory, &fonts);
+  ThreadPoolPtr pool = new ThreadPool(kTableBuildBenchmarkThreads);
+  factory->SetThreadPool(pool);
+  EXPECT_EQ(serial_bytes,
+            TimeTableBuilding("Build rebuilt glyf, 4 threads", factory,
+                              &fonts));
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(TableBuildBenchmark, Corpus) {
+  ASSERT_TRUE(sfntly::BenchmarkTableBuilding());
+}
@@ -18,7 +18,15 @@
 
 #include "gtest/gtest.h"
 #include "sfntly/data/memory_byte_array.h"
+#include "sfntly/data/copy_on_write_byte_array.h"
+#include "sfntly/data/external_byte_array.h"
 #include "sfntly/data/growable_memory_byte_array.h"
+#include "sfntly/data/mapped_byte_array.h"
+#include "sfntly/data/segmented_growable_memory_byte_array.h"
+#include "sfntly/data/writable_font_data.h"
+#include "test/test_data.h"
+#include "test/test_font_utils.h"
+#include "test/test_utils.h"
 
 namespace sfntly {
 namespace byte_array_test {
@@ -101,6 +109,11 @@ bool CopyTest(ByteArray* ba) {
   EXPECT_EQ(ba->Length(), growable_copy->Length());
   EXPECT_TRUE(ReadComparison(ba, growable_copy));
 
+  ByteArrayPtr segmented_copy = new SegmentedGrowableMemoryByteArray(6);
+  ba->CopyTo(segmented_copy);
+  EXPECT_EQ(ba->Length(), segmented_copy->Length());
+  EXPECT_TRUE(ReadComparison(ba, segmented_copy));
+
   return true;
 }
 
@@ -138,9 +151,186 @@ bool TestGrowableMemoryByteArray() {
   return true;
 }
 
+bool TestSegmentedGrowableMemoryByteArray() {
+  fprintf(stderr, "segmented mem: size ");
+  for (size_t i = 0;
+       i < sizeof(byte_array_test::BYTE_ARRAY_SIZES) / sizeof(int32_t); ++i) {
+    int32_t size = byte_array_test::BYTE_ARRAY_SIZES[i];
+    fprintf(stderr, "%d ", size);
+    // Small segments so that most sizes span several of them.
+    ByteArrayPtr ba = new SegmentedGrowableMemoryByteArray(6);
+    byte_array_test::FillTestByteArray(ba, size);
+    EXPECT_TRUE(byte_array_test::ByteArrayTester(ba));
+    EXPECT_EQ(size <= 64, ba->Begin() != NULL);
+
+    // Bulk writes and stream output across segment boundaries.
+    ByteVector b(size);
+    for (int32_t j = 0; j < size; ++j) {
+      b[j] = (byte_t)(j % 256);
+    }
+    ByteArrayPtr bulk = new SegmentedGrowableMemoryByteArray(6);
+    EXPECT_EQ(size, bulk->Put(0, &b));
+    EXPECT_TRUE(byte_array_test::ReadComparison(ba, bulk));
+    MemoryOutputStream os;
+    EXPECT_EQ(size, bulk->CopyTo(&os));
+    EXPECT_EQ(static_cast<size_t>(size), os.Size());
+    EXPECT_EQ(0, memcmp(os.Get(), &(b[0]), size));
+  }
+  fprintf(stderr, "\n");
+  return true;
+}
+
+bool TestByteArrayCopyPaths() {
+  // Copies out of contiguous storage go straight to the destination, the
+  // rest through a buffer; both must copy the same bytes and report the same
+  // counts, including when the requested range runs past the filled length.
+  // Larger than a few copy buffers (8192 bytes each).
+  const int32_t size = 3 * 8192 + 17;
+  ByteArrayPtr contiguous = new MemoryByteArray(size);
+  ByteArrayPtr non_contiguous = new NonContiguousByteArray(size);
+  byte_array_test::FillTestByteArray(contiguous, size);
+  byte_array_test::FillTestByteArray(non_contiguous, size);
+  const int32_t ranges[][3] = {
+    // dst offset, src offset, length
+    {0, 0, size}, {5, 0, size - 5}, {0, 7, size - 7}, {0, size - 3, 100},
+    {11, 1, 8192}, {0, size, 10}, {0, 0, 0}
+  };
+  for (size_t i = 0; i < sizeof(ranges) / sizeof(ranges[0]); ++i) {
+    ByteArrayPtr fast_copy = new MemoryByteArray(size + 32);
+    ByteArrayPtr slow_copy = new MemoryByteArray(size + 32);
+    EXPECT_EQ(non_contiguous->CopyTo(ranges[i][0], slow_copy, ranges[i][1],
+                                     ranges[i][2]),
+              contiguous->CopyTo(ranges[i][0], fast_copy, ranges[i][1],
+                                 ranges[i][2]));
+    EXPECT_EQ(slow_copy->Length(), fast_copy->Length());
+    EXPECT_TRUE(byte_array_test::ReadComparison(slow_copy, fast_copy));
+
+    ByteArrayPtr growable_copy = new GrowableMemoryByteArray();
+    EXPECT_EQ(non_contiguous->CopyTo(ranges[i][0], growable_copy,
+                                     ranges[i][1], ranges[i][2]),
+              contiguous->CopyTo(ranges[i][0], growable_copy, ranges[i][1],
+                                 ranges[i][2]));
+  }
+  // Insufficient space in the destination.
+  ByteArrayPtr small = new MemoryByteArray(10);
+  EXPECT_EQ(-1, contiguous->CopyTo(0, small, 0, 11));
+  // Both paths count the bytes read, even into a destination that takes none.
+  ByteVector buffer(size);
+  ByteArrayPtr read_only = new ExternalByteArray(&(buffer[0]), size);
+  EXPECT_EQ(non_contiguous->CopyTo(0, read_only, 0, size),
+            contiguous->CopyTo(0, read_only, 0, size));
+  return true;
+}
+
+bool TestMappedByteArray() {
+  ByteVector b;
+  LoadFile(SAMPLE_TTF_FILE, &b);
+  ByteArrayPtr memory_ba = new MemoryByteArray(b.size());
+  memory_ba->Put(0, &b);
+
+  ByteArrayPtr ba;
+  ba.Attach(MappedByteArray::CreateMappedByteArray(SAMPLE_TTF_FILE));
+  EXPECT_TRUE(ba != NULL);
+  EXPECT_EQ(memory_ba->Length(), ba->Length());
+  EXPECT_TRUE(ba->read_only());
+  EXPECT_TRUE(byte_array_test::ReadComparison(ba, memory_ba));
+  EXPECT_TRUE(byte_array_test::ByteArrayTester(ba));
+
+#if defined (SFNTLY_NO_EXCEPTION)
+  // Writes are rejected and leave the mapping untouched.
+  byte_t first = static_cast<byte_t>(ba->Get(0));
+  byte_t replacement[] = { static_cast<byte_t>(first + 1) };
+  EXPECT_EQ(0, ba->Put(0, replacement, 0, 1));
+  EXPECT_EQ(first, ba->Get(0));
+#endif
+
+  ByteArrayPtr missing;
+  missing.Attach(MappedByteArray::CreateMappedByteArray("no-such-font.ttf"));
+  EXPECT_TRUE(missing == NULL);
+  return true;
+}
+
+bool TestExternalByteArray() {
+  fprintf(stderr, "external mem: size ");
+  for (size_t i = 0;
+       i < sizeof(byte_array_test::BYTE_ARRAY_SIZES) / sizeof(int32_t); ++i) {
+    int32_t size = byte_array_test::BYTE_ARRAY_SIZES[i];
+    fprintf(stderr, "%d ", size);
+    ByteVector b(size);
+    for (int32_t j = 0; j < size; ++j) {
+      b[j] = (byte_t)(j % 256);
+    }
+    ByteArrayPtr ba = new ExternalByteArray(&(b[0]), size);
+    EXPECT_EQ(size, ba->Length());
+    EXPECT_TRUE(ba->read_only());
+    EXPECT_TRUE(byte_array_test::ByteArrayTester(ba));
+#if defined (SFNTLY_NO_EXCEPTION)
+    // The caller's buffer is never written.
+    ba->Put(0, (byte_t)0xff);
+    EXPECT_EQ(0, b[0]);
+#endif
+  }
+  fprintf(stderr, "\n");
+  return true;
+}
+
+bool TestCopyOnWriteByteArray() {
+  fprintf(stderr, "copy on write: size ");
+  for (size_t i = 0;
+       i < sizeof(byte_array_test::BYTE_ARRAY_SIZES) / sizeof(int32_t); ++i) {
+    int32_t size = byte_array_test::BYTE_ARRAY_SIZES[i];
+    fprintf(stderr, "%d ", size);
+    // Share a slice from the middle of a larger array.
+    ByteArrayPtr source_array = new MemoryByteArray(size + 2);
+    byte_array_test::FillTestByteArray(source_array, size + 2);
+    ReadableFontDataPtr whole = new ReadableFontData(source_array);
+    ReadableFontDataPtr source;
+    source.Attach(down_cast<ReadableFontData*>(whole->Slice(1, size)));
+
+    Ptr<CopyOnWriteByteArray> ba = new CopyOnWriteByteArray(source);
+    EXPECT_EQ(size, ba->Length());
+    EXPECT_FALSE(ba->copied());
+    EXPECT_TRUE(ba->Begin() == source_array->Begin() + 1);
+    EXPECT_TRUE(byte_array_test::ByteArrayTester(ba));
+    EXPECT_FALSE(ba->copied());
+
+    // The first write takes a private copy and leaves the source alone.
+    WritableFontDataPtr wfd = new WritableFontData(ba);
+    WritableFontDataPtr tail;
+    tail.Attach(down_cast<WritableFontData*>(wfd->Slice(size - 1)));
+    tail->WriteByte(0, (byte_t)0xa5);
+    EXPECT_TRUE(ba->copied());
+    EXPECT_TRUE(ba->Begin() != source_array->Begin() + 1);
+    EXPECT_EQ(0xa5, wfd->ReadUByte(size - 1));
+    EXPECT_EQ(size % 256, source->ReadUByte(size - 1));
+    for (int32_t j = 0; j < size - 1; ++j) {
+      EXPECT_EQ(source->ReadUByte(j), wfd->ReadUByte(j));
+    }
+  }
+
+  // Non-contiguous data is shared through reads.
+  ByteArrayPtr non_contiguous = new NonContiguousByteArray(300);
+  byte_array_test::FillTestByteArray(non_contiguous, 300);
+  ReadableFontDataPtr source = new ReadableFontData(non_contiguous);
+  Ptr<CopyOnWriteByteArray> ba = new CopyOnWriteByteArray(source);
+  EXPECT_TRUE(ba->Begin() == NULL);
+  EXPECT_TRUE(byte_array_test::ByteArrayTester(ba));
+  ba->Put(0, (byte_t)0xff);
+  EXPECT_TRUE(ba->Begin() != NULL);
+  EXPECT_EQ(0xff, ba->Get(0));
+  EXPECT_EQ(0, non_contiguous->Get(0));
+  fprintf(stderr, "\n");
+  return true;
+}
+
 }  // namespace sfntly
 
 TEST(ByteArray, All) {
   ASSERT_TRUE(sfntly::TestMemoryByteArray());
   ASSERT_TRUE(sfntly::TestGrowableMemoryByteArray());
+  ASSERT_TRUE(sfntly::TestSegmentedGrowableMemoryByteArray());
+  ASSERT_TRUE(sfntly::TestByteArrayCopyPaths());
+  ASSERT_TRUE(sfntly::TestMappedByteArray());
+  ASSERT_TRUE(sfntly::TestExternalByteArray());
+  ASSERT_TRUE(sfntly::TestCopyOnWriteByteArray());
 }
@@ -14,6 +14,10 @@
  * limitations under the License.
  */
 
+#include <string.h>
+
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "sample/chromium/font_subsetter.h"
 #include "test/test_data.h"
@@ -29,6 +33,20 @@ namespace {
   // correctly.
   const unsigned int kGlyphIds[] = { 43, 72, 79, 82, 15, 3, 90, 85, 71, 4 };
   const unsigned int kGlyphIdsCount = sizeof(kGlyphIds) / sizeof(unsigned int);
+
+  // Hands out a caller-owned vector resized to the subset font size.
+  unsigned char* AllocateVector(size_t size, void* context) {
+    std::vector<unsigned char>* buffer =
+        static_cast<std::vector<unsigned char>*>(context);
+    buffer->resize(size);
+    return &((*buffer)[0]);
+  }
+
+  unsigned char* RefuseAllocation(size_t size, void* context) {
+    UNREFERENCED_PARAMETER(size);
+    UNREFERENCED_PARAMETER(context);
+    return NULL;
+  }
 }
 
 // This function is deliberately located at global namespace.
@@ -70,6 +88,52 @@ bool TestChromeSubsetter() {
   return false;
 }
 
+// Subsetting into caller-provided memory gives the same font.
+bool TestChromeSubsetterAllocator() {
+  sfntly::ByteVector input_buffer;
+  sfntly::LoadFile(kInputFileName, &input_buffer);
+  EXPECT_GT(input_buffer.size(), (size_t)0);
+
+  unsigned char* output_buffer = NULL;
+  int output_length =
+      SfntlyWrapper::SubsetFont(kFontName,
+                                &(input_buffer[0]),
+                                input_buffer.size(),
+                                kGlyphIds,
+                                kGlyphIdsCount,
+                                &output_buffer);
+  EXPECT_GT(output_length, 0);
+
+  std::vector<unsigned char> allocated;
+  int allocated_length =
+      SfntlyWrapper::SubsetFont(kFontName,
+                                &(input_buffer[0]),
+                                input_buffer.size(),
+                                kGlyphIds,
+                                kGlyphIdsCount,
+                                AllocateVector,
+                                &allocated);
+  EXPECT_EQ(output_length, allocated_length);
+  EXPECT_EQ((size_t)output_length, allocated.size());
+  if (output_length > 0 && allocated_length == output_length) {
+    EXPECT_EQ(0, memcmp(output_buffer, &(allocated[0]), output_length));
+  }
+  delete[] output_buffer;
+
+  EXPECT_LT(SfntlyWrapper::SubsetFont(kFontName,
+                                      &(input_buffer[0]),
+                                      input_buffer.size(),
+                                      kGlyphIds,
+                                      kGlyphIdsCount,
+                                      RefuseAllocation,
+                                      NULL), 0);
+  return output_length > 0;
+}
+
 TEST(ChromeSubsetter, All) {
   EXPECT_TRUE(TestChromeSubsetter());
 }
+
+TEST(ChromeSubsetter, Allocator) {
+  EXPECT_TRUE(TestChromeSubsetterAllocator());
+}
@@ -75,6 +75,7 @@ class CMapIteratorTests
 void CMapIteratorTests::SetUp() {
   FontArray fonts;
   Ptr<FontFactory> font_factory;
+  font_factory.Attach(FontFactory::GetInstance());
   const char* file_name = GetParam().file_name();
   LoadFont(file_name, font_factory, &fonts);
   Ptr<Font> font;
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_TEST_COUNTING_REF_COUNT_POLICY_H_
+#define SFNTLY_CPP_SRC_TEST_COUNTING_REF_COUNT_POLICY_H_
+
+#include "sfntly/port/type.h"
+
+namespace sfntly {
+
+// A reference count policy for test objects which also counts every update
+// made through it, so that tests and benchmarks can check which code leaves
+// reference counts alone. Objects using it must stay on one thread.
+struct CountingRefCountPolicy {
+  static size_t Increment(size_t* count) {
+    ++(*updates());
+    return ++(*count);
+  }
+
+  static size_t Decrement(size_t* count) {
+    ++(*updates());
+    return --(*count);
+  }
+
+  // The number of updates made so far through the policy.
+  static size_t* updates() {
+    static size_t updates = 0;
+    return &updates;
+  }
+};
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_TEST_COUNTING_REF_COUNT_POLICY_H_
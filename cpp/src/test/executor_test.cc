@@ -0,0 +1,287 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/atomic.h"
+#include "sfntly/port/executor.h"
+#include "sfntly/port/memory_output_stream.h"
+#include "sfntly/port/thread_pool.h"
+#include "test/platform_thread.h"
+#include "test/test_data.h"
+
+namespace sfntly {
+
+// The executors to run each test on: the calling thread, a shared queue and
+// per-thread queues.
+void NewTestExecutors(std::vector<ExecutorPtr>* executors) {
+  executors->push_back(ExecutorPtr());
+  executors->push_back(new ThreadPool(3));
+  executors->push_back(new WorkStealingScheduler(3));
+}
+
+class IncrementTask : public Executor::Task {
+ public:
+  explicit IncrementTask(size_t* counter) : counter_(counter) {}
+
+  virtual void Run() { AtomicIncrement(counter_); }
+
+ private:
+  size_t* counter_;
+};
+
+// Hands batches of tasks to a shared scheduler.
+class SchedulerBatchThread : public PlatformThread::Delegate {
+ public:
+  SchedulerBatchThread(Executor* executor, size_t* counter)
+      : executor_(executor), counter_(counter) {}
+
+  virtual void ThreadMain() {
+    for (int32_t batch = 0; batch < 50; ++batch) {
+      std::vector<IncrementTask> tasks(10, IncrementTask(counter_));
+      TaskGroup group(executor_);
+      for (size_t i = 0; i < tasks.size(); ++i) {
+        group.Add(&tasks[i]);
+      }
+    }
+  }
+
+ private:
+  Executor* executor_;
+  size_t* counter_;
+
+  NO_COPY_AND_ASSIGN(SchedulerBatchThread);
+};
+
+// Sums the indices in [begin, end) by splitting the range in two tasks of a
+// nested group until it is small.
+class RangeSumTask : public Executor::Task {
+ public:
+  RangeSumTask(Executor* executor, int32_t begin, int32_t end)
+      : executor_(executor), begin_(begin), end_(end), sum_(0) {}
+
+  virtual void Run() {
+    if (end_ - begin_ <= 8) {
+      for (int32_t i = begin_; i < end_; ++i) {
+        sum_ += i;
+      }
+      return;
+    }
+    int32_t middle = begin_ + (end_ - begin_) / 2;
+    RangeSumTask low(executor_, begin_, middle);
+    RangeSumTask high(executor_, middle, end_);
+    TaskGroup group(executor_);
+    group.Add(&low);
+    group.Add(&high);
+    group.Wait();
+    sum_ = low.sum() + high.sum();
+  }
+
+  int64_t sum() const { return sum_; }
+
+ private:
+  Executor* executor_;
+  int32_t begin_;
+  int32_t end_;
+  int64_t sum_;
+};
+
+// Counts how often each index is visited.
+class VisitBody : public ParallelForBody {
+ public:
+  explicit VisitBody(size_t size) : visits_(size, 0), calls_(0) {}
+
+  virtual void Run(int32_t begin, int32_t end) {
+    AtomicIncrement(&calls_);
+    for (int32_t i = begin; i < end; ++i) {
+      AtomicIncrement(&visits_[i]);
+    }
+  }
+
+  bool VisitedOnce() const {
+    for (size_t i = 0; i < visits_.size(); ++i) {
+      if (visits_[i] != 1) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  size_t calls() const { return calls_; }
+
+ private:
+  std::vector<size_t> visits_;
+  size_t calls_;
+};
+
+// An executor of an embedder: runs every batch on the calling thread, last
+// task first, and counts what it was handed.
+class RecordingExecutor : public Executor,
+                          public RefCounted<RecordingExecutor> {
+ public:
+  RecordingExecutor() : batches_(0), tasks_(0) {}
+
+  virtual void RunTasks(TaskList* tasks) {
+    ++batches_;
+    tasks_ += tasks->size();
+    for (TaskList::reverse_iterator task = tasks->rbegin(),
+                                    task_end = tasks->rend();
+                                    task != task_end; ++task) {
+      (*task)->Run();
+    }
+  }
+
+  virtual int32_t num_threads() { return 1; }
+
+  size_t batches() const { return batches_; }
+  size_t tasks() const { return tasks_; }
+
+ private:
+  size_t batches_;
+  size_t tasks_;
+};
+
+bool TestWorkStealingScheduler() {
+  for (int32_t num_threads = 0; num_threads <= 4; num_threads += 2) {
+    WorkStealingSchedulerPtr scheduler =
+        new WorkStealingScheduler(num_threads);
+    EXPECT_EQ(num_threads, scheduler->num_threads());
+
+    size_t counter = 0;
+    std::vector<IncrementTask> tasks(100, IncrementTask(&counter));
+    Executor::TaskList task_list;
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      task_list.push_back(&tasks[i]);
+    }
+    scheduler->RunTasks(&task_list);
+    EXPECT_EQ(tasks.size(), counter);
+    Executor::TaskList no_tasks;
+    scheduler->RunTasks(&no_tasks);
+  }
+
+  WorkStealingSchedulerPtr scheduler = new WorkStealingScheduler(2);
+  size_t counter = 0;
+  SchedulerBatchThread first(scheduler, &counter);
+  SchedulerBatchThread second(scheduler, &counter);
+  PlatformThreadHandle first_handle = kNullThreadHandle;
+  PlatformThreadHandle second_handle = kNullThreadHandle;
+  EXPECT_TRUE(PlatformThread::Create(&first, &first_handle));
+  EXPECT_TRUE(PlatformThread::Create(&second, &second_handle));
+  PlatformThread::Join(first_handle);
+  PlatformThread::Join(second_handle);
+  EXPECT_EQ(2U * 50 * 10, counter);
+  return true;
+}
+
+bool TestNestedTaskGroups() {
+  std::vector<ExecutorPtr> executors;
+  NewTestExecutors(&executors);
+  const int32_t kCount = 10000;
+  for (size_t i = 0; i < executors.size(); ++i) {
+    RangeSumTask task(executors[i], 0, kCount);
+    TaskGroup group(executors[i]);
+    group.Add(&task);
+    group.Wait();
+    EXPECT_EQ((int64_t)kCount * (kCount - 1) / 2, task.sum());
+    // Waiting again with nothing added is a no-op.
+    group.Wait();
+  }
+  return true;
+}
+
+bool TestParallelFor() {
+  std::vector<ExecutorPtr> executors;
+  NewTestExecutors(&executors);
+  const int32_t kGrainSizes[] = { 0, 1, 7, 1000, 5000 };
+  for (size_t i = 0; i < executors.size(); ++i) {
+    for (size_t g = 0; g < sizeof(kGrainSizes) / sizeof(int32_t); ++g) {
+      VisitBody body(1000);
+      ParallelFor(executors[i], 0, 1000, kGrainSizes[g], &body);
+      EXPECT_TRUE(body.VisitedOnce());
+      if (executors[i] == NULL || kGrainSizes[g] >= 1000) {
+        EXPECT_EQ(1U, body.calls());
+      }
+    }
+    VisitBody offset_body(100);
+    ParallelFor(executors[i], 50, 100, 1, &offset_body);
+    ParallelFor(executors[i], 0, 50, 1, &offset_body);
+    EXPECT_TRUE(offset_body.VisitedOnce());
+    VisitBody empty_body(0);
+    ParallelFor(executors[i], 10, 10, 1, &empty_body);
+    ParallelFor(executors[i], 10, 5, 1, &empty_body);
+    EXPECT_EQ(0U, empty_body.calls());
+  }
+  return true;
+}
+
+bool TestFactoryExecutor() {
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontBuilderArray builders;
+  factory->LoadFontsForBuilding(SAMPLE_TTF_FILE, &builders);
+  EXPECT_EQ(1U, builders.size());
+  // Make a builder for every table so that all of them are built.
+  builders[0]->table_builders();
+  FontPtr font;
+  font.Attach(builders[0]->Build());
+  MemoryOutputStream serial_output;
+  factory->SerializeFont(font, &serial_output);
+
+  Ptr<RecordingExecutor> executor = new RecordingExecutor();
+  factory->SetExecutor(executor);
+  EXPECT_EQ(executor.p_, factory->executor());
+  builders.clear();
+  factory->LoadFontsForBuilding(SAMPLE_TTF_FILE, &builders);
+  EXPECT_EQ(1U, builders.size());
+  builders[0]->table_builders();
+  font.Attach(builders[0]->Build());
+  // The tables were built in batches on the executor.
+  EXPECT_GT(executor->batches(), 0U);
+  EXPECT_EQ((size_t)font->num_tables(), executor->tasks());
+
+  size_t batches = executor->batches();
+  MemoryOutputStream output;
+  factory->SerializeFont(font, &output);
+  // The checksums were computed on the executor.
+  EXPECT_EQ(batches + 1, executor->batches());
+  EXPECT_EQ(serial_output.Size(), output.Size());
+  EXPECT_EQ(0, memcmp(serial_output.Get(), output.Get(), output.Size()));
+
+  factory->SetExecutor(NULL);
+  EXPECT_TRUE(factory->executor() == NULL);
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(Executor, WorkStealingScheduler) {
+  ASSERT_TRUE(sfntly::TestWorkStealingScheduler());
+}
+
+TEST(Executor, NestedTaskGroups) {
+  ASSERT_TRUE(sfntly::TestNestedTaskGroups());
+}
+
+TEST(Executor, ParallelFor) {
+  ASSERT_TRUE(sfntly::TestParallelFor());
+}
+
+TEST(Executor, FactoryExecutor) {
+  ASSERT_TRUE(sfntly::TestFactoryExecutor());
+}
@@ -15,11 +15,17 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "gtest/gtest.h"
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
 #include "sfntly/port/file_input_stream.h"
+#include "sfntly/port/random_access_file_input_stream.h"
 #include "sfntly/data/font_input_stream.h"
+#include "test/platform_thread.h"
 #include "test/test_data.h"
+#include "test/test_font_utils.h"
 
 namespace sfntly {
 
@@ -144,6 +150,146 @@ bool TestFontInputStreamTableLoading() {
   return true;
 }
 
+bool TestRandomAccessFileInputStream() {
+  ByteVector b1;
+  LoadFile(SAMPLE_TTF_FILE, &b1);
+  size_t length = b1.size();
+  EXPECT_GT(length, (size_t)RandomAccessFileInputStream::kReadAheadSize);
+
+  // Full file reading test
+  RandomAccessFileInputStream is;
+  EXPECT_FALSE(is.Open("no such file"));
+  EXPECT_TRUE(is.Open(SAMPLE_TTF_FILE));
+  EXPECT_EQ(length, (size_t)is.Available());
+  EXPECT_EQ(length, (size_t)is.Length());
+  ByteVector b2;
+  EXPECT_EQ(length, (size_t)is.Read(&b2, 0, length));
+  EXPECT_EQ(0, is.Read(&b2, 0, 1));
+  is.Close();
+  EXPECT_EQ(memcmp(&(b1[0]), &(b2[0]), length), 0);
+  b2.clear();
+
+  // Partial reading test
+  is.Open(SAMPLE_TTF_FILE);
+  is.Skip(89);
+  is.Read(&b2, 0, 100);
+  EXPECT_EQ(memcmp(&(b1[89]), &(b2[0]), 100), 0);
+  b2.clear();
+
+  // Skip test
+  is.Skip(-89);
+  is.Read(&b2, 0, 100);
+  EXPECT_EQ(memcmp(&(b1[100]), &(b2[0]), 100), 0);
+  b2.clear();
+  is.Skip(100);
+  is.Read(&b2, 0, 100);
+  EXPECT_EQ(memcmp(&(b1[300]), &(b2[0]), 100), 0);
+  is.Skip(-400);
+  b2.clear();
+
+  // Offset test
+  is.Read(&b2, 0, 100);
+  is.Read(&b2, 100, 100);
+  EXPECT_EQ(memcmp(&(b1[0]), &(b2[0]), 200), 0);
+
+  // Unread test
+  ByteVector b3;
+  b3.resize(200);
+  is.Unread(&b3);
+  EXPECT_EQ(0, is.position());
+  EXPECT_EQ((int32_t)b1[0], is.Read());
+
+  // Reads across the end of the read-ahead buffer.
+  const int32_t kBoundary = RandomAccessFileInputStream::kReadAheadSize;
+  is.Skip(kBoundary - 11);
+  b2.clear();
+  EXPECT_EQ(20, is.Read(&b2, 0, 20));
+  EXPECT_EQ(memcmp(&(b1[kBoundary - 10]), &(b2[0]), 20), 0);
+  EXPECT_EQ((int32_t)b1[kBoundary + 10], is.Read());
+
+  // Positional reads leave the stream alone.
+  int64_t position = is.position();
+  byte_t b4[300];
+  EXPECT_EQ(300, is.ReadAt(length - 400, b4, 300));
+  EXPECT_EQ(memcmp(&(b1[length - 400]), b4, 300), 0);
+  EXPECT_EQ(100, is.ReadAt(length - 100, b4, 300));
+  EXPECT_EQ(memcmp(&(b1[length - 100]), b4, 100), 0);
+  EXPECT_EQ(0, is.ReadAt(length, b4, 300));
+  EXPECT_EQ(position, is.position());
+  EXPECT_EQ((int32_t)b1[(size_t)position], is.Read());
+
+  return true;
+}
+
+// Loads the fonts of one file from a shared stream.
+class FontLoadingThread : public PlatformThread::Delegate {
+ public:
+  FontLoadingThread(FontFactory* factory, RandomAccessFileInputStream* is)
+      : factory_(factory), is_(is) {}
+  virtual void ThreadMain() {
+    factory_->LoadFonts(is_, &fonts_);
+  }
+  FontArray* fonts() { return &fonts_; }
+
+ private:
+  FontFactory* factory_;
+  RandomAccessFileInputStream* is_;
+  FontArray fonts_;
+};
+
+bool TestRandomAccessFontLoading() {
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  const char* font_files[] = { SAMPLE_TTF_FILE, SAMPLE_BITMAP_FONT };
+  for (size_t f = 0; f < sizeof(font_files) / sizeof(font_files[0]); ++f) {
+    FontArray mapped_fonts;
+    factory->LoadFonts(font_files[f], &mapped_fonts);
+    EXPECT_EQ(1U, mapped_fonts.size());
+
+    RandomAccessFileInputStream is;
+    EXPECT_TRUE(is.Open(font_files[f]));
+    const int32_t kThreads = 4;
+    FontLoadingThread* loaders[kThreads];
+    PlatformThreadHandle threads[kThreads];
+    for (int32_t i = 0; i < kThreads; ++i) {
+      loaders[i] = new FontLoadingThread(factory, &is);
+      EXPECT_TRUE(PlatformThread::Create(loaders[i], &threads[i]));
+    }
+    for (int32_t i = 0; i < kThreads; ++i) {
+      PlatformThread::Join(threads[i]);
+    }
+    EXPECT_EQ(0, is.position());
+
+    // Every thread read the same tables as the mapped file holds.
+    for (int32_t i = 0; i < kThreads; ++i) {
+      FontArray* fonts = loaders[i]->fonts();
+      EXPECT_EQ(mapped_fonts.size(), fonts->size());
+      if (fonts->size() == mapped_fonts.size() && !fonts->empty()) {
+        Font* font = (*fonts)[0];
+        Font* mapped_font = mapped_fonts[0];
+        EXPECT_EQ(mapped_font->num_tables(), font->num_tables());
+        const TableMap* tables = mapped_font->GetTableMap();
+        for (TableMap::const_iterator t = tables->begin(), e = tables->end();
+             t != e; ++t) {
+          Table* table = font->GetTable(t->first);
+          EXPECT_TRUE(table != NULL);
+          if (table == NULL) {
+            continue;
+          }
+          ReadableFontData* data = table->ReadFontData();
+          ReadableFontData* mapped_data = t->second->ReadFontData();
+          EXPECT_EQ(mapped_data->Length(), data->Length());
+          EXPECT_EQ(0, memcmp(mapped_data->ContiguousBytes(),
+                              data->ContiguousBytes(),
+                              data->Length()));
+        }
+      }
+      delete loaders[i];
+    }
+  }
+  return true;
+}
+
 }  // namespace sfntly
 
 TEST(FileIO, All) {
@@ -151,3 +297,11 @@ TEST(FileIO, All) {
   ASSERT_TRUE(sfntly::TestFontInputStreamBasic());
   ASSERT_TRUE(sfntly::TestFontInputStreamTableLoading());
 }
+
+TEST(FileIO, RandomAccess) {
+  ASSERT_TRUE(sfntly::TestRandomAccessFileInputStream());
+}
+
+TEST(FileIO, RandomAccessFontLoading) {
+  ASSERT_TRUE(sfntly::TestRandomAccessFontLoading());
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "sfntly/port/flat_map.h"
+#include "sfntly/port/type.h"
+
+namespace sfntly {
+
+bool TestFlatMap() {
+  typedef FlatMap<int32_t, int32_t> IntegerMap;
+  IntegerMap map;
+  EXPECT_TRUE(map.empty());
+  const int32_t kKeys[] = { 50, 10, 40, 20, 30 };
+  for (size_t i = 0; i < sizeof(kKeys) / sizeof(kKeys[0]); ++i) {
+    EXPECT_TRUE(map.insert(std::make_pair(kKeys[i], kKeys[i] * 2)).second);
+  }
+  EXPECT_FALSE(map.insert(std::make_pair(30, 0)).second);
+  EXPECT_EQ(5U, map.size());
+
+  // Iteration is in key order.
+  int32_t previous = 0;
+  for (IntegerMap::const_iterator entry = map.begin(), end = map.end();
+       entry != end; ++entry) {
+    EXPECT_LT(previous, entry->first);
+    EXPECT_EQ(entry->first * 2, entry->second);
+    previous = entry->first;
+  }
+
+  EXPECT_TRUE(map.find(25) == map.end());
+  EXPECT_TRUE(map.find(60) == map.end());
+  EXPECT_EQ(60, map.find(30)->second);
+  EXPECT_EQ(1U, map.count(10));
+  EXPECT_EQ(0U, map.count(0));
+
+  map[25] = 7;
+  EXPECT_EQ(7, map.find(25)->second);
+  EXPECT_EQ(0, map[5]);
+  EXPECT_EQ(5, map.begin()->first);
+  EXPECT_EQ(7U, map.size());
+
+  EXPECT_EQ(1U, map.erase(5));
+  EXPECT_EQ(0U, map.erase(5));
+  map.erase(map.find(50));
+  EXPECT_EQ(5U, map.size());
+  EXPECT_EQ(40, (--map.end())->first);
+
+  IntegerMap other;
+  other.swap(map);
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(5U, other.size());
+  other.clear();
+  EXPECT_TRUE(other.empty());
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(FlatMap, All) {
+  ASSERT_TRUE(sfntly::TestFlatMap());
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+#include "sfntly/font.h"
+#include "sfntly/font_cache.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/fingerprint.h"
+#include "sfntly/tag.h"
+#include "test/platform_thread.h"
+#include "test/test_data.h"
+#include "test/test_font_utils.h"
+
+namespace sfntly {
+
+bool TestFingerprint() {
+  ByteVector fingerprint;
+  Fingerprint128(NULL, 0, &fingerprint);
+  EXPECT_EQ(kFingerprintSize, fingerprint.size());
+  EXPECT_EQ(ByteVector(kFingerprintSize, 0), fingerprint);
+
+  // MurmurHash3_x64_128("hello", seed 0) is cbd8a7b341bd9b02 5b1e906a48ae1d19,
+  // stored as two little endian words.
+  const byte_t kExpected[] = {
+    0x02, 0x9b, 0xbd, 0x41, 0xb3, 0xa7, 0xd8, 0xcb,
+    0x19, 0x1d, 0xae, 0x48, 0x6a, 0x90, 0x1e, 0x5b
+  };
+  const char* hello = "hello";
+  Fingerprint128(reinterpret_cast<const byte_t*>(hello), strlen(hello),
+                 &fingerprint);
+  EXPECT_EQ(0, memcmp(kExpected, &(fingerprint[0]), kFingerprintSize));
+
+  // Every length of tail and a change in any byte give another fingerprint.
+  ByteVector data(100);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = (byte_t)(i * 7);
+  }
+  ByteVector previous;
+  for (size_t length = 1; length < data.size(); ++length) {
+    Fingerprint128(&(data[0]), length, &fingerprint);
+    EXPECT_NE(previous, fingerprint);
+    previous = fingerprint;
+  }
+  Fingerprint128(&(data[0]), data.size(), &previous);
+  for (size_t i = 0; i < data.size(); i += 9) {
+    data[i] ^= 1;
+    Fingerprint128(&(data[0]), data.size(), &fingerprint);
+    EXPECT_NE(previous, fingerprint);
+    data[i] ^= 1;
+  }
+  return true;
+}
+
+bool TestFontDigest() {
+  ByteVector data;
+  LoadFile(SAMPLE_TTF_FILE, &data);
+  ByteVector expected;
+  Fingerprint128(&(data[0]), data.size(), &expected);
+
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontArray fonts;
+  factory->LoadFonts(&data, &fonts);
+  EXPECT_EQ(1U, fonts.size());
+  EXPECT_TRUE(fonts[0]->digest()->empty());
+
+  factory->FingerprintFont(true);
+  fonts.clear();
+  factory->LoadFonts(&data, &fonts);
+  factory->LoadFonts(&(data[0]), data.size(), &fonts);
+  factory->LoadFonts(SAMPLE_TTF_FILE, &fonts);
+  EXPECT_EQ(3U, fonts.size());
+  for (size_t i = 0; i < fonts.size(); ++i) {
+    EXPECT_EQ(expected, *(fonts[i]->digest()));
+  }
+
+  FontBuilderArray builders;
+  factory->LoadFontsForBuilding(&data, &builders);
+  EXPECT_EQ(1U, builders.size());
+  FontPtr font;
+  font.Attach(builders[0]->Build());
+  EXPECT_EQ(expected, *(font->digest()));
+  return true;
+}
+
+bool TestFontFactoryCache() {
+  ByteVector data;
+  LoadFile(SAMPLE_TTF_FILE, &data);
+
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontCachePtr cache = new FontCache(data.size() * 4);
+  factory->SetFontCache(cache);
+  EXPECT_EQ(cache, factory->font_cache());
+
+  FontArray fonts;
+  factory->LoadFonts(&data, &fonts);
+  EXPECT_EQ(1U, cache->num_entries());
+  EXPECT_EQ(data.size(), cache->size());
+  // Fonts are cached by content, whatever they are loaded from.
+  factory->LoadFonts(SAMPLE_TTF_FILE, &fonts);
+  ByteVector* borrowed = new ByteVector(data);
+  factory->LoadFonts(&((*borrowed)[0]), borrowed->size(), &fonts);
+  delete borrowed;
+  EXPECT_EQ(3U, fonts.size());
+  EXPECT_TRUE(fonts[0] == fonts[1]);
+  EXPECT_TRUE(fonts[0] == fonts[2]);
+  EXPECT_EQ(kFingerprintSize, fonts[0]->digest()->size());
+  EXPECT_EQ(1U, cache->num_entries());
+
+  // Fonts loaded with another table filter are cached apart.
+  IntegerSet tags;
+  tags.insert(Tag::cmap);
+  factory->SetTableFilter(tags);
+  factory->LoadFonts(&data, &fonts);
+  EXPECT_EQ(4U, fonts.size());
+  EXPECT_TRUE(fonts[0] != fonts[3]);
+  EXPECT_TRUE(fonts[3]->GetTable(Tag::glyf) == NULL);
+  EXPECT_EQ(2U, cache->num_entries());
+  factory->ClearTableFilter();
+  factory->LoadFonts(&data, &fonts);
+  EXPECT_TRUE(fonts[0] == fonts[4]);
+
+  // A font first loaded from a borrowed buffer outlives it.
+  cache->Clear();
+  EXPECT_EQ(0U, cache->num_entries());
+  EXPECT_EQ(0U, cache->size());
+  borrowed = new ByteVector(data);
+  fonts.clear();
+  factory->LoadFonts(&((*borrowed)[0]), borrowed->size(), &fonts);
+  memset(&((*borrowed)[0]), 0, borrowed->size());
+  delete borrowed;
+  factory->LoadFonts(&data, &fonts);
+  EXPECT_EQ(2U, fonts.size());
+  EXPECT_TRUE(fonts[0] == fonts[1]);
+  EXPECT_TRUE(fonts[1]->GetTable(Tag::glyf) != NULL);
+  EXPECT_EQ(0x00010000, fonts[1]->sfnt_version());
+  return true;
+}
+
+bool TestFontCacheEviction() {
+  ByteVector data;
+  LoadFile(SAMPLE_TTF_FILE, &data);
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontArray fonts;
+  factory->LoadFonts(&data, &fonts);
+
+  FontCachePtr cache = new FontCache(100);
+  ByteVector a(1, 'a');
+  ByteVector b(1, 'b');
+  ByteVector c(1, 'c');
+  cache->Put(a, 40, fonts);
+  cache->Put(b, 40, fonts);
+  EXPECT_EQ(80U, cache->size());
+  FontArray found;
+  EXPECT_TRUE(cache->Get(a, &found));
+  EXPECT_EQ(1U, found.size());
+  EXPECT_TRUE(found[0] == fonts[0]);
+  // b is now the least recently used.
+  cache->Put(c, 40, fonts);
+  EXPECT_EQ(2U, cache->num_entries());
+  EXPECT_EQ(80U, cache->size());
+  EXPECT_FALSE(cache->Get(b, &found));
+  EXPECT_TRUE(cache->Get(a, &found));
+  EXPECT_TRUE(cache->Get(c, &found));
+
+  // Too big to be cached at all.
+  cache->Put(b, 101, fonts);
+  EXPECT_FALSE(cache->Get(b, &found));
+  EXPECT_EQ(2U, cache->num_entries());
+
+  cache->SetBudget(50);
+  EXPECT_EQ(1U, cache->num_entries());
+  EXPECT_TRUE(cache->Get(c, &found));
+  cache->SetBudget(0);
+  EXPECT_EQ(0U, cache->num_entries());
+  EXPECT_EQ(0U, cache->size());
+  return true;
+}
+
+// Loads the same font over and over through a shared cache.
+class CachedLoadThread : public PlatformThread::Delegate {
+ public:
+  CachedLoadThread(FontCache* cache, ByteVector* data)
+      : cache_(cache), data_(data) {}
+
+  virtual void ThreadMain() {
+    FontFactoryPtr factory;
+    factory.Attach(FontFactory::GetInstance());
+    factory->SetFontCache(cache_);
+    for (int32_t i = 0; i < 50; ++i) {
+      factory->LoadFonts(&((*data_)[0]), data_->size(), &fonts_);
+    }
+    for (size_t i = 0; i < fonts_.size(); ++i) {
+      EXPECT_TRUE(fonts_[i]->GetTable(Tag::glyf) != NULL);
+    }
+  }
+
+  FontArray* fonts() { return &fonts_; }
+
+ private:
+  FontCache* cache_;
+  ByteVector* data_;
+  FontArray fonts_;
+
+  NO_COPY_AND_ASSIGN(CachedLoadThread);
+};
+
+bool TestConcurrentFontCache() {
+  ByteVector data;
+  LoadFile(SAMPLE_TTF_FILE, &data);
+  FontCachePtr cache = new FontCache(data.size());
+  CachedLoadThread first(cache, &data);
+  CachedLoadThread second(cache, &data);
+  PlatformThreadHandle first_handle, second_handle;
+  EXPECT_TRUE(PlatformThread::Create(&first, &first_handle));
+  EXPECT_TRUE(PlatformThread::Create(&second, &second_handle));
+  PlatformThread::Join(first_handle);
+  PlatformThread::Join(second_handle);
+
+  EXPECT_EQ(1U, cache->num_entries());
+  FontArray cached;
+  // With no table filter the key is the fingerprint.
+  EXPECT_TRUE(cache->Get(*(first.fonts()->back()->digest()), &cached));
+  EXPECT_EQ(50U, first.fonts()->size());
+  EXPECT_EQ(50U, second.fonts()->size());
+  // Both threads may have parsed the font before it was cached, but end up
+  // with the cached font.
+  EXPECT_TRUE(first.fonts()->back() == cached[0]);
+  EXPECT_TRUE(second.fonts()->back() == cached[0]);
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(FontCache, Fingerprint) {
+  ASSERT_TRUE(sfntly::TestFingerprint());
+}
+
+TEST(FontCache, FontDigest) {
+  ASSERT_TRUE(sfntly::TestFontDigest());
+}
+
+TEST(FontCache, FontFactoryCache) {
+  ASSERT_TRUE(sfntly::TestFontFactoryCache());
+}
+
+TEST(FontCache, Eviction) {
+  ASSERT_TRUE(sfntly::TestFontCacheEviction());
+}
+
+TEST(FontCache, ConcurrentLoads) {
+  ASSERT_TRUE(sfntly::TestConcurrentFontCache());
+}
@@ -21,6 +21,8 @@
 #include "sfntly/port/type.h"
 #include "sfntly/data/writable_font_data.h"
 #include "sfntly/data/memory_byte_array.h"
+#include "sfntly/data/segmented_growable_memory_byte_array.h"
+#include "test/test_utils.h"
 
 namespace sfntly {
 
@@ -325,13 +327,187 @@ bool TestWritableFontData() {
   return true;
 }
 
+bool TestSegmentedWritableFontData() {
+  WritableFontDataPtr wfd;
+  wfd.Attach(WritableFontData::CreateWritableFontData(0, true));
+  // Values that straddle the boundary between the first two segments.
+  const int32_t boundary =
+      1 << SegmentedGrowableMemoryByteArray::kDefaultSegmentBits;
+  wfd->WriteULong(boundary - 2, 0x12345678);
+  wfd->WriteUShort(boundary + 2, 0xabcd);
+  EXPECT_EQ(boundary + 4, wfd->Length());
+  EXPECT_EQ(0x12345678, wfd->ReadULong(boundary - 2));
+  EXPECT_EQ(0xabcd, wfd->ReadUShort(boundary + 2));
+  EXPECT_EQ(0, wfd->ReadUShort(0));
+
+  WritableFontDataPtr copy;
+  copy.Attach(WritableFontData::CreateWritableFontData(0, false));
+  wfd->CopyTo(copy);
+  EXPECT_EQ(wfd->Length(), copy->Length());
+  EXPECT_EQ(wfd->Checksum(), copy->Checksum());
+  return true;
+}
+
+bool TestReadableFontDataReadPaths() {
+  // The same bytes behind a contiguous and a non-contiguous array must read
+  // back identically, including for reads that straddle the end of a slice.
+  // ByteArray::Get() does not bounds check so stay within the array itself.
+  const int32_t size = 1031;
+  ByteArrayPtr contiguous = new MemoryByteArray(size);
+  ByteArrayPtr non_contiguous = new NonContiguousByteArray(size);
+  for (int32_t i = 0; i < size; ++i) {
+    byte_t b = (byte_t)((i * 37 + 11) % 256);
+    contiguous->Put(i, b);
+    non_contiguous->Put(i, b);
+  }
+  EXPECT_TRUE(contiguous->Begin() != NULL);
+  EXPECT_TRUE(non_contiguous->Begin() == NULL);
+
+  ReadableFontDataPtr fast = new ReadableFontData(contiguous);
+  ReadableFontDataPtr slow = new ReadableFontData(non_contiguous);
+  for (int32_t trim = 0; trim < size / 2; trim += 97) {
+    ReadableFontDataPtr fast_slice;
+    ReadableFontDataPtr slow_slice;
+    fast_slice.Attach(down_cast<ReadableFontData*>(
+        fast->Slice(trim, size - 2 * trim)));
+    slow_slice.Attach(down_cast<ReadableFontData*>(
+        slow->Slice(trim, size - 2 * trim)));
+    for (int32_t i = 0; i + trim + DataSize::kULONG <= size; ++i) {
+      EXPECT_EQ(slow_slice->ReadUByte(i), fast_slice->ReadUByte(i));
+      EXPECT_EQ(slow_slice->ReadByte(i), fast_slice->ReadByte(i));
+      EXPECT_EQ(slow_slice->ReadUShort(i), fast_slice->ReadUShort(i));
+      EXPECT_EQ(slow_slice->ReadShort(i), fast_slice->ReadShort(i));
+      EXPECT_EQ(slow_slice->ReadUInt24(i), fast_slice->ReadUInt24(i));
+      EXPECT_EQ(slow_slice->ReadULong(i), fast_slice->ReadULong(i));
+      EXPECT_EQ(slow_slice->ReadULongLE(i), fast_slice->ReadULongLE(i));
+      EXPECT_EQ(slow_slice->ReadLong(i), fast_slice->ReadLong(i));
+    }
+  }
+  return true;
+}
+
+bool TestReadableFontDataChecksum() {
+  // Every combination of start alignment, length and checksum ranges must give
+  // the same checksum whether it is summed from memory or byte by byte.
+  const int32_t size = 263;
+  ByteArrayPtr contiguous = new MemoryByteArray(size);
+  ByteArrayPtr non_contiguous = new NonContiguousByteArray(size);
+  for (int32_t i = 0; i < size; ++i) {
+    byte_t b = (byte_t)((i * 131 + 7) % 256);
+    contiguous->Put(i, b);
+    non_contiguous->Put(i, b);
+  }
+  ReadableFontDataPtr fast = new ReadableFontData(contiguous);
+  ReadableFontDataPtr slow = new ReadableFontData(non_contiguous);
+  for (int32_t offset = 0; offset < 8; ++offset) {
+    for (int32_t length = 0; length + offset <= size; ++length) {
+      ReadableFontDataPtr fast_slice;
+      ReadableFontDataPtr slow_slice;
+      fast_slice.Attach(down_cast<ReadableFontData*>(
+          fast->Slice(offset, length)));
+      slow_slice.Attach(down_cast<ReadableFontData*>(
+          slow->Slice(offset, length)));
+      EXPECT_EQ(slow_slice->Checksum(), fast_slice->Checksum());
+
+      // Skip a word in the middle, as the head table does.
+      if (length >= 12) {
+        IntegerList ranges;
+        ranges.push_back(0);
+        ranges.push_back(4);
+        ranges.push_back(8);
+        fast_slice->SetCheckSumRanges(ranges);
+        slow_slice->SetCheckSumRanges(ranges);
+        EXPECT_EQ(slow_slice->Checksum(), fast_slice->Checksum());
+      }
+    }
+  }
+  return true;
+}
+
+bool TestFontDataArrays() {
+  // Bulk array reads must match element-wise reads for every odd/even start
+  // and count that fits (or overruns) the data, from both kinds of array.
+  const int32_t size = 301;
+  ByteArrayPtr contiguous = new MemoryByteArray(size);
+  ByteArrayPtr non_contiguous = new NonContiguousByteArray(size);
+  for (int32_t i = 0; i < size; ++i) {
+    byte_t b = (byte_t)((i * 53 + 3) % 256);
+    contiguous->Put(i, b);
+    non_contiguous->Put(i, b);
+  }
+  ReadableFontDataPtr datas[2];
+  datas[0] = new ReadableFontData(contiguous);
+  datas[1] = new ReadableFontData(non_contiguous);
+  std::vector<uint16_t> ushorts(size);
+  std::vector<int16_t> shorts(size);
+  std::vector<uint32_t> ulongs(size);
+  for (int32_t d = 0; d < 2; ++d) {
+    ReadableFontData* data = datas[d];
+    for (int32_t index = 0; index < 37; ++index) {
+      for (int32_t count = 1; count < size / 2 + 10; count += 13) {
+        int32_t read = data->ReadUShortArray(index, count, &(ushorts[0]));
+        EXPECT_EQ(std::min(count, (size - index) / DataSize::kUSHORT), read);
+        for (int32_t i = 0; i < read; ++i) {
+          EXPECT_EQ(data->ReadUShort(index + i * DataSize::kUSHORT),
+                    ushorts[i]);
+        }
+        read = data->ReadShortArray(index, count, &(shorts[0]));
+        for (int32_t i = 0; i < read; ++i) {
+          EXPECT_EQ(data->ReadShort(index + i * DataSize::kSHORT), shorts[i]);
+        }
+        read = data->ReadULongArray(index, count, &(ulongs[0]));
+        EXPECT_EQ(std::min(count, (size - index) / DataSize::kULONG), read);
+        for (int32_t i = 0; i < read; ++i) {
+          EXPECT_EQ(data->ReadULong(index + i * DataSize::kULONG),
+                    (int64_t)ulongs[i]);
+        }
+      }
+    }
+  }
+
+  // Bulk writes larger than the internal conversion buffer round trip.
+  const int32_t count = 5000;
+  std::vector<uint16_t> in16(count);
+  std::vector<uint32_t> in32(count);
+  for (int32_t i = 0; i < count; ++i) {
+    in16[i] = (uint16_t)(i * 7919);
+    in32[i] = (uint32_t)i * 2654435761U;
+  }
+  WritableFontDataPtr wfd;
+  wfd.Attach(WritableFontData::CreateWritableFontData(0));
+  EXPECT_EQ(count * DataSize::kUSHORT,
+            wfd->WriteUShortArray(1, &(in16[0]), count));
+  EXPECT_EQ(count * DataSize::kULONG,
+            wfd->WriteULongArray(1 + count * DataSize::kUSHORT, &(in32[0]),
+                                 count));
+  for (int32_t i = 0; i < count; ++i) {
+    EXPECT_EQ(in16[i], wfd->ReadUShort(1 + i * DataSize::kUSHORT));
+    EXPECT_EQ((int64_t)in32[i], wfd->ReadULong(1 + count * DataSize::kUSHORT +
+                                               i * DataSize::kULONG));
+  }
+  return true;
+}
+
 }  // namespace sfntly
 
 TEST(FontData, ReadableFontDataSearching) {
   ASSERT_TRUE(sfntly::TestReadableFontDataSearching());
 }
 
+TEST(FontData, ReadableFontDataReadPaths) {
+  ASSERT_TRUE(sfntly::TestReadableFontDataReadPaths());
+}
+
+TEST(FontData, ReadableFontDataChecksum) {
+  ASSERT_TRUE(sfntly::TestReadableFontDataChecksum());
+}
+
+TEST(FontData, Arrays) {
+  ASSERT_TRUE(sfntly::TestFontDataArrays());
+}
+
 TEST(FontData, All) {
   ASSERT_TRUE(sfntly::TestReadableFontData());
   ASSERT_TRUE(sfntly::TestWritableFontData());
+  ASSERT_TRUE(sfntly::TestSegmentedWritableFontData());
 }
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <typeinfo>
+
 #include "gtest/gtest.h"
 
 #include "sfntly/data/font_input_stream.h"
@@ -21,11 +23,16 @@
 #include "sfntly/font.h"
 #include "sfntly/font_factory.h"
 #include "sfntly/table/core/font_header_table.h"
+#include "sfntly/table/core/horizontal_metrics_table.h"
+#include "sfntly/table/core/maximum_profile_table.h"
+#include "sfntly/table/truetype/loca_table.h"
 #include "sfntly/table/table.h"
 #include "sfntly/table/generic_table_builder.h"
 #include "sfntly/table/table_based_table_builder.h"
 #include "sfntly/tag.h"
 #include "sfntly/port/file_input_stream.h"
+#include "sfntly/port/random_access_file_input_stream.h"
+#include "test/platform_thread.h"
 #include "test/test_data.h"
 #include "test/test_font_utils.h"
 
@@ -131,10 +138,587 @@ bool TestTTFMemoryBasedReadWrite() {
   return true;
 }
 
+bool TestTTFMappedReadWrite() {
+  ByteVector input_buffer;
+  LoadFile(SAMPLE_TTF_FILE, &input_buffer);
+
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontArray memory_fonts;
+  factory->LoadFonts(&input_buffer, &memory_fonts);
+  FontArray mapped_fonts;
+  factory->LoadFonts(SAMPLE_TTF_FILE, &mapped_fonts);
+  EXPECT_EQ(memory_fonts.size(), mapped_fonts.size());
+  EXPECT_EQ(mapped_fonts.size(), static_cast<size_t>(1));
+
+  // Mapped tables are slices of the file and must not have been copied.
+  Table* head = mapped_fonts[0]->GetTable(Tag::head);
+  EXPECT_TRUE(head != NULL);
+  EXPECT_TRUE(head->ReadFontData()->ReadOnly());
+
+  MemoryOutputStream memory_output;
+  factory->SerializeFont(memory_fonts[0], &memory_output);
+  MemoryOutputStream mapped_output;
+  factory->SerializeFont(mapped_fonts[0], &mapped_output);
+  EXPECT_EQ(memory_output.Size(), mapped_output.Size());
+  EXPECT_EQ(memcmp(memory_output.Get(), mapped_output.Get(),
+                   memory_output.Size()), 0);
+
+  // A missing file yields no font.
+  FontArray missing_fonts;
+  factory->LoadFonts("no-such-font.ttf", &missing_fonts);
+  EXPECT_TRUE(missing_fonts.empty());
+
+  return true;
+}
+
+bool TestTTFMappedEditing() {
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontBuilderArray font_builder_array;
+  factory->LoadFontsForBuilding(SAMPLE_TTF_FILE, &font_builder_array);
+  EXPECT_EQ(font_builder_array.size(), static_cast<size_t>(1));
+  FontBuilderPtr font_builder = font_builder_array[0];
+
+  // Editing a table backed by the mapping switches it to a private copy.
+  FontHeaderTableBuilderPtr header_builder =
+      down_cast<FontHeaderTable::Builder*>(
+          font_builder->GetTableBuilder(Tag::head));
+  EXPECT_TRUE(header_builder->InternalReadData()->ReadOnly());
+  int32_t revision = header_builder->FontRevision();
+  header_builder->SetFontRevision(revision + 1);
+  EXPECT_FALSE(header_builder->InternalReadData()->ReadOnly());
+  EXPECT_EQ(revision + 1, header_builder->FontRevision());
+
+  FontPtr font;
+  font.Attach(font_builder->Build());
+  FontHeaderTablePtr header =
+      down_cast<FontHeaderTable*>(font->GetTable(Tag::head));
+  EXPECT_EQ(revision + 1, header->FontRevision());
+
+  // The original file is untouched.
+  FontArray fonts;
+  factory->LoadFonts(SAMPLE_TTF_FILE, &fonts);
+  header = down_cast<FontHeaderTable*>(fonts[0]->GetTable(Tag::head));
+  EXPECT_EQ(revision, header->FontRevision());
+
+  return true;
+}
+
+bool TestTTFBorrowedBufferReadWrite() {
+  ByteVector input_buffer;
+  LoadFile(SAMPLE_TTF_FILE, &input_buffer);
+  ByteVector original = input_buffer;
+
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontArray copied_fonts;
+  factory->LoadFonts(&input_buffer, &copied_fonts);
+  FontArray borrowed_fonts;
+  factory->LoadFonts(&(input_buffer[0]), input_buffer.size(), &borrowed_fonts);
+  EXPECT_EQ(borrowed_fonts.size(), static_cast<size_t>(1));
+
+  // Borrowed tables point straight into the caller's buffer.
+  Table* head = borrowed_fonts[0]->GetTable(Tag::head);
+  EXPECT_TRUE(head->ReadFontData()->ReadOnly());
+
+  MemoryOutputStream copied_output;
+  factory->SerializeFont(copied_fonts[0], &copied_output);
+  MemoryOutputStream borrowed_output;
+  factory->SerializeFont(borrowed_fonts[0], &borrowed_output);
+  EXPECT_EQ(copied_output.Size(), borrowed_output.Size());
+  EXPECT_EQ(memcmp(copied_output.Get(), borrowed_output.Get(),
+                   copied_output.Size()), 0);
+
+  // Editing through a builder leaves the caller's buffer untouched.
+  FontBuilderArray builders;
+  factory->LoadFontsForBuilding(&(input_buffer[0]), input_buffer.size(),
+                                &builders);
+  EXPECT_EQ(builders.size(), static_cast<size_t>(1));
+  FontHeaderTableBuilderPtr header_builder =
+      down_cast<FontHeaderTable::Builder*>(
+          builders[0]->GetTableBuilder(Tag::head));
+  header_builder->SetFontRevision(header_builder->FontRevision() + 1);
+  FontPtr font;
+  font.Attach(builders[0]->Build());
+  EXPECT_TRUE(font != NULL);
+  EXPECT_TRUE(input_buffer == original);
+
+  return true;
+}
+
+// Check a font loaded with a table filter against the fully loaded font.
+bool VerifyFilteredFont(Font* font, Font* full_font, const IntegerSet& loaded) {
+  EXPECT_EQ(loaded.size(), (size_t)font->num_tables());
+  EXPECT_EQ((size_t)full_font->num_tables(),
+            font->num_tables() + font->unloaded_tables()->size());
+  const TableMap* tables = full_font->GetTableMap();
+  for (TableMap::const_iterator t = tables->begin(), e = tables->end();
+       t != e; ++t) {
+    if (loaded.count(t->first)) {
+      Table* table = font->GetTable(t->first);
+      EXPECT_TRUE(table != NULL);
+      if (table == NULL) {
+        continue;
+      }
+      EXPECT_EQ(t->second->DataLength(), table->DataLength());
+      EXPECT_EQ(0, memcmp(t->second->ReadFontData()->ContiguousBytes(),
+                          table->ReadFontData()->ContiguousBytes(),
+                          table->DataLength()));
+    } else {
+      EXPECT_FALSE(font->HasTable(t->first));
+      HeaderPtr key = new Header(t->first);
+      HeaderTagSortedSet::const_iterator record =
+          font->unloaded_tables()->find(key);
+      EXPECT_TRUE(record != font->unloaded_tables()->end());
+      if (record != font->unloaded_tables()->end()) {
+        EXPECT_EQ(t->second->header()->offset(), (*record)->offset());
+        EXPECT_EQ(t->second->header()->length(), (*record)->length());
+      }
+    }
+  }
+  return true;
+}
+
+bool TestTableFilter() {
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  EXPECT_TRUE(factory->table_filter() == NULL);
+  FontArray full_fonts;
+  factory->LoadFonts(SAMPLE_TTF_FILE, &full_fonts);
+  EXPECT_EQ(1U, full_fonts.size());
+  EXPECT_TRUE(full_fonts[0]->unloaded_tables()->empty());
+
+  IntegerSet loaded;
+  loaded.insert(Tag::name);
+  loaded.insert(Tag::OS_2);
+  loaded.insert(Tag::cmap);
+  factory->SetTableFilter(loaded);
+  EXPECT_TRUE(factory->table_filter() != NULL);
+  ByteVector input_buffer;
+  LoadFile(SAMPLE_TTF_FILE, &input_buffer);
+  for (int32_t source = 0; source < 4; ++source) {
+    FontArray fonts;
+    if (source == 0) {
+      factory->LoadFonts(SAMPLE_TTF_FILE, &fonts);
+    } else if (source == 1) {
+      factory->LoadFonts(&input_buffer, &fonts);
+    } else {
+      RandomAccessFileInputStream is;
+      is.Open(SAMPLE_TTF_FILE);
+      if (source == 2) {
+        factory->LoadFonts(&is, &fonts);
+      } else {
+        FileInputStream stream;
+        stream.Open(SAMPLE_TTF_FILE);
+        factory->LoadFonts(&stream, &fonts);
+      }
+    }
+    EXPECT_EQ(1U, fonts.size());
+    VerifyFilteredFont(fonts[0], full_fonts[0], loaded);
+  }
+
+  // Directory only.
+  factory->SetTableFilter(IntegerSet());
+  FontArray directory_fonts;
+  factory->LoadFonts(SAMPLE_TTF_FILE, &directory_fonts);
+  EXPECT_EQ(1U, directory_fonts.size());
+  VerifyFilteredFont(directory_fonts[0], full_fonts[0], IntegerSet());
+
+  // Tables needed to parse the requested ones come along.
+  IntegerSet hmtx_only;
+  hmtx_only.insert(Tag::hmtx);
+  factory->SetTableFilter(hmtx_only);
+  FontArray hmtx_fonts;
+  factory->LoadFonts(SAMPLE_TTF_FILE, &hmtx_fonts);
+  EXPECT_EQ(1U, hmtx_fonts.size());
+  IntegerSet hmtx_loaded(hmtx_only);
+  hmtx_loaded.insert(Tag::hhea);
+  hmtx_loaded.insert(Tag::maxp);
+  VerifyFilteredFont(hmtx_fonts[0], full_fonts[0], hmtx_loaded);
+  HorizontalMetricsTablePtr hmtx =
+      down_cast<HorizontalMetricsTable*>(hmtx_fonts[0]->GetTable(Tag::hmtx));
+  HorizontalMetricsTablePtr full_hmtx =
+      down_cast<HorizontalMetricsTable*>(full_fonts[0]->GetTable(Tag::hmtx));
+  EXPECT_EQ(full_hmtx->NumberOfHMetrics(), hmtx->NumberOfHMetrics());
+  EXPECT_EQ(full_hmtx->AdvanceWidth(full_hmtx->NumberOfHMetrics() - 1),
+            hmtx->AdvanceWidth(hmtx->NumberOfHMetrics() - 1));
+
+  // Tables left out can be loaded from the font file later, along with the
+  // unloaded tables they need: head for loca.
+  WritableFontDataPtr file_data;
+  file_data.Attach(WritableFontData::CreateWritableFontData(&input_buffer));
+  LocaTablePtr loca;
+  loca.Attach(down_cast<LocaTable*>(
+      hmtx_fonts[0]->LoadUnloadedTable(Tag::loca, file_data)));
+  EXPECT_TRUE(loca != NULL);
+  EXPECT_TRUE(hmtx_fonts[0]->GetTable(Tag::loca) == NULL);
+  LocaTablePtr full_loca =
+      down_cast<LocaTable*>(full_fonts[0]->GetTable(Tag::loca));
+  if (loca != NULL) {
+    EXPECT_EQ(full_loca->NumLocas(), loca->NumLocas());
+    EXPECT_EQ(full_loca->GlyphOffset(full_loca->num_glyphs() - 1),
+              loca->GlyphOffset(loca->num_glyphs() - 1));
+  }
+  TablePtr glyf;
+  glyf.Attach(hmtx_fonts[0]->LoadUnloadedTable(Tag::glyf, file_data));
+  EXPECT_TRUE(glyf != NULL);
+  if (glyf != NULL) {
+    EXPECT_EQ(full_fonts[0]->GetTable(Tag::glyf)->CalculatedChecksum(),
+              glyf->CalculatedChecksum());
+  }
+  // Loaded tables, missing tables and truncated files give none.
+  TablePtr none;
+  none.Attach(hmtx_fonts[0]->LoadUnloadedTable(Tag::hmtx, file_data));
+  EXPECT_TRUE(none == NULL);
+  none.Attach(hmtx_fonts[0]->LoadUnloadedTable(Tag::CFF, file_data));
+  EXPECT_TRUE(none == NULL);
+  WritableFontDataPtr truncated;
+  truncated.Attach(down_cast<WritableFontData*>(
+      file_data->Slice(
+          0, full_fonts[0]->GetTable(Tag::glyf)->header()->offset())));
+  none.Attach(hmtx_fonts[0]->LoadUnloadedTable(Tag::glyf, truncated));
+  EXPECT_TRUE(none == NULL);
+
+  // Filtered fonts serialize just the tables loaded.
+  MemoryOutputStream os;
+  factory->SerializeFont(hmtx_fonts[0], &os);
+  factory->ClearTableFilter();
+  EXPECT_TRUE(factory->table_filter() == NULL);
+  FontArray reloaded;
+  factory->LoadFonts(os.Get(), os.Size(), &reloaded);
+  EXPECT_EQ(1U, reloaded.size());
+  EXPECT_EQ(3, reloaded[0]->num_tables());
+  return true;
+}
+
+bool TestLazyTables() {
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontArray eager_fonts;
+  factory->LoadFonts(SAMPLE_TTF_FILE, &eager_fonts);
+  EXPECT_EQ(1U, eager_fonts.size());
+  const TableMap* eager_tables = eager_fonts[0]->GetTableMap();
+
+  // A table built on first access gets what it needs from the tables it
+  // depends on, which are not built for it.
+  FontArray fonts;
+  factory->LoadFonts(SAMPLE_TTF_FILE, &fonts);
+  EXPECT_EQ(1U, fonts.size());
+  Font* font = fonts[0];
+  EXPECT_EQ((int32_t)eager_tables->size(), font->num_tables());
+  EXPECT_TRUE(font->HasTable(Tag::hmtx));
+  HorizontalMetricsTablePtr hmtx =
+      down_cast<HorizontalMetricsTable*>(font->GetTable(Tag::hmtx));
+  EXPECT_TRUE(hmtx == font->GetTable(Tag::hmtx));
+  HorizontalMetricsTablePtr eager_hmtx = down_cast<HorizontalMetricsTable*>(
+      eager_fonts[0]->GetTable(Tag::hmtx));
+  EXPECT_EQ(eager_hmtx->NumberOfHMetrics(), hmtx->NumberOfHMetrics());
+  EXPECT_EQ(eager_hmtx->NumberOfLSBs(), hmtx->NumberOfLSBs());
+  int32_t num_glyphs = hmtx->NumberOfHMetrics() + hmtx->NumberOfLSBs();
+  for (int32_t glyph_id = 0; glyph_id < num_glyphs; glyph_id += 97) {
+    EXPECT_EQ(eager_hmtx->AdvanceWidth(glyph_id),
+              hmtx->AdvanceWidth(glyph_id));
+  }
+  LocaTablePtr loca = down_cast<LocaTable*>(font->GetTable(Tag::loca));
+  LocaTablePtr eager_loca =
+      down_cast<LocaTable*>(eager_fonts[0]->GetTable(Tag::loca));
+  EXPECT_EQ(eager_loca->num_glyphs(), loca->num_glyphs());
+  EXPECT_EQ(eager_loca->format_version(), loca->format_version());
+  EXPECT_EQ(eager_loca->GlyphOffset(loca->num_glyphs() - 1),
+            loca->GlyphOffset(loca->num_glyphs() - 1));
+  EXPECT_TRUE(font->GetTable(Tag::EBDT) == NULL);
+  EXPECT_EQ(eager_tables->size(), font->GetTableMap()->size());
+
+  // Builders are made on first access too, after those they depend on.
+  FontBuilderArray builders;
+  factory->LoadFontsForBuilding(SAMPLE_TTF_FILE, &builders);
+  EXPECT_EQ(1U, builders.size());
+  Font::Builder* font_builder = builders[0];
+  EXPECT_EQ((int32_t)eager_tables->size(),
+            font_builder->number_of_table_builders());
+  EXPECT_TRUE(font_builder->HasTableBuilder(Tag::loca));
+  LocaTableBuilderPtr loca_builder =
+      down_cast<LocaTable::Builder*>(font_builder->GetTableBuilder(Tag::loca));
+  EXPECT_EQ(eager_loca->NumLocas(), loca_builder->NumLocas());
+  EXPECT_EQ(eager_loca->format_version(), loca_builder->format_version());
+
+  // Edits made before a dependent table is built are seen by it.
+  MaximumProfileTableBuilderPtr maxp_builder =
+      down_cast<MaximumProfileTable::Builder*>(
+          font_builder->GetTableBuilder(Tag::maxp));
+  maxp_builder->SetNumGlyphs(maxp_builder->NumGlyphs() - 1);
+  font_builder->RemoveTableBuilder(Tag::glyf);
+  font_builder->RemoveTableBuilder(Tag::loca);
+  EXPECT_FALSE(font_builder->HasTableBuilder(Tag::loca));
+  FontPtr edited_font;
+  edited_font.Attach(font_builder->Build());
+  EXPECT_EQ((int32_t)eager_tables->size() - 2, edited_font->num_tables());
+  hmtx = down_cast<HorizontalMetricsTable*>(
+      edited_font->GetTable(Tag::hmtx));
+  EXPECT_EQ(eager_hmtx->NumberOfLSBs() - 1, hmtx->NumberOfLSBs());
+  return true;
+}
+
+// Gets every table of a font shared with other threads, in its own order.
+class LazyTableThread : public PlatformThread::Delegate {
+ public:
+  LazyTableThread(Font* font, const IntegerList* tags, size_t first)
+      : font_(font), tags_(tags), first_(first) {}
+
+  virtual void ThreadMain() {
+    for (size_t i = 0; i < tags_->size(); ++i) {
+      int32_t tag = (*tags_)[(first_ + i) % tags_->size()];
+      tables_.insert(TableMapEntry(tag, font_->GetTable(tag)));
+    }
+  }
+
+  const TableMap* tables() { return &tables_; }
+
+ private:
+  Font* font_;
+  const IntegerList* tags_;
+  size_t first_;
+  TableMap tables_;
+
+  NO_COPY_AND_ASSIGN(LazyTableThread);
+};
+
+bool TestConcurrentLazyTables() {
+  const size_t kThreads = 4;
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontArray eager_fonts;
+  factory->LoadFonts(SAMPLE_TTF_FILE, &eager_fonts);
+  EXPECT_EQ(1U, eager_fonts.size());
+  IntegerList tags;
+  const TableMap* eager_tables = eager_fonts[0]->GetTableMap();
+  for (TableMap::const_iterator t = eager_tables->begin(),
+                                e = eager_tables->end(); t != e; ++t) {
+    tags.push_back(t->first);
+  }
+
+  // Each table is built once whichever thread gets to it first, and all
+  // threads see that table.
+  FontArray fonts;
+  factory->LoadFonts(SAMPLE_TTF_FILE, &fonts);
+  EXPECT_EQ(1U, fonts.size());
+  std::vector<LazyTableThread*> threads;
+  std::vector<PlatformThreadHandle> handles(kThreads, kNullThreadHandle);
+  for (size_t i = 0; i < kThreads; ++i) {
+    threads.push_back(new LazyTableThread(fonts[0], &tags,
+                                          i * tags.size() / kThreads));
+    EXPECT_TRUE(PlatformThread::Create(threads[i], &(handles[i])));
+  }
+  for (size_t i = 0; i < kThreads; ++i) {
+    PlatformThread::Join(handles[i]);
+  }
+  const TableMap* tables = fonts[0]->GetTableMap();
+  EXPECT_EQ(eager_tables->size(), tables->size());
+  EXPECT_EQ((int32_t)tags.size(), fonts[0]->num_tables());
+  for (size_t i = 0; i < kThreads; ++i) {
+    EXPECT_EQ(tables->size(), threads[i]->tables()->size());
+    for (TableMap::const_iterator t = tables->begin(), e = tables->end();
+                                  t != e; ++t) {
+      TableMap::const_iterator seen = threads[i]->tables()->find(t->first);
+      EXPECT_TRUE(seen != threads[i]->tables()->end() &&
+                  seen->second.p_ == t->second.p_);
+    }
+    delete threads[i];
+  }
+  return true;
+}
+
+bool TestReadOnlyFont() {
+  ByteVector input_buffer;
+  LoadFile(SAMPLE_TTF_FILE, &input_buffer);
+  const byte_t* begin = &(input_buffer[0]);
+  const byte_t* end = begin + input_buffer.size();
+
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontArray fonts;
+  factory->LoadFonts(begin, input_buffer.size(), &fonts);
+  EXPECT_EQ(1U, fonts.size());
+  FontBuilderArray builders;
+  factory->LoadFontsForBuilding(begin, input_buffer.size(), &builders);
+  EXPECT_EQ(1U, builders.size());
+  FontPtr built_font;
+  built_font.Attach(builders[0]->Build());
+
+  // Tables made without builders are the same as those built, and are
+  // slices of the source.
+  const TableMap* tables = fonts[0]->GetTableMap();
+  const TableMap* built_tables = built_font->GetTableMap();
+  EXPECT_EQ(built_tables->size(), tables->size());
+  for (TableMap::const_iterator t = built_tables->begin(),
+                                e = built_tables->end(); t != e; ++t) {
+    Table* table = fonts[0]->GetTable(t->first);
+    EXPECT_TRUE(table != NULL);
+    if (table == NULL) {
+      continue;
+    }
+    EXPECT_TRUE(typeid(*(t->second.p_)) == typeid(*table));
+    EXPECT_EQ(t->second->DataLength(), table->DataLength());
+    const byte_t* data = table->ReadFontData()->ContiguousBytes();
+    EXPECT_TRUE(data >= begin && data + table->DataLength() <= end);
+    EXPECT_EQ(0, memcmp(t->second->ReadFontData()->ContiguousBytes(), data,
+                        table->DataLength()));
+  }
+  HorizontalMetricsTablePtr hmtx =
+      down_cast<HorizontalMetricsTable*>(fonts[0]->GetTable(Tag::hmtx));
+  HorizontalMetricsTablePtr built_hmtx =
+      down_cast<HorizontalMetricsTable*>(built_font->GetTable(Tag::hmtx));
+  EXPECT_EQ(built_hmtx->NumberOfHMetrics(), hmtx->NumberOfHMetrics());
+  EXPECT_EQ(built_hmtx->NumberOfLSBs(), hmtx->NumberOfLSBs());
+  LocaTablePtr loca = down_cast<LocaTable*>(fonts[0]->GetTable(Tag::loca));
+  LocaTablePtr built_loca =
+      down_cast<LocaTable*>(built_font->GetTable(Tag::loca));
+  EXPECT_EQ(built_loca->format_version(), loca->format_version());
+  EXPECT_EQ(built_loca->num_glyphs(), loca->num_glyphs());
+
+  MemoryOutputStream output;
+  factory->SerializeFont(fonts[0], &output);
+  MemoryOutputStream built_output;
+  factory->SerializeFont(built_font, &built_output);
+  EXPECT_EQ(built_output.Size(), output.Size());
+  EXPECT_EQ(0, memcmp(built_output.Get(), output.Get(), output.Size()));
+  return true;
+}
+
+static void PutULong(ByteVector* b, size_t index, uint32_t value) {
+  (*b)[index] = (byte_t)(value >> 24);
+  (*b)[index + 1] = (byte_t)(value >> 16);
+  (*b)[index + 2] = (byte_t)(value >> 8);
+  (*b)[index + 3] = (byte_t)value;
+}
+
+static uint32_t GetULong(const ByteVector& b, size_t index) {
+  return ((uint32_t)b[index] << 24) | ((uint32_t)b[index + 1] << 16) |
+         ((uint32_t)b[index + 2] << 8) | (uint32_t)b[index + 3];
+}
+
+// Make a font collection of two copies of the font which share all tables
+// but the name table.
+void MakeCollection(const ByteVector& font, ByteVector* collection) {
+  const size_t kHeaderSize = 20;
+  size_t num_tables = (font[4] << 8) | font[5];
+  size_t directory_size = 12 + 16 * num_tables;
+  size_t font_offset = (kHeaderSize + 2 * directory_size + 3) & ~3;
+  size_t name_offset = (font_offset + font.size() + 3) & ~3;
+
+  collection->assign(kHeaderSize, 0);
+  PutULong(collection, 0, Tag::ttcf);
+  PutULong(collection, 4, 0x00010000);
+  PutULong(collection, 8, 2);
+  PutULong(collection, 12, kHeaderSize);
+  PutULong(collection, 16, kHeaderSize + directory_size);
+  for (int32_t member = 0; member < 2; ++member) {
+    size_t directory = collection->size();
+    collection->insert(collection->end(), font.begin(),
+                       font.begin() + directory_size);
+    for (size_t record = directory + 12; record < collection->size();
+         record += 16) {
+      uint32_t offset = GetULong(*collection, record + 8) + font_offset;
+      if (member == 1 && GetULong(*collection, record) == (uint32_t)Tag::name) {
+        offset = name_offset;
+      }
+      PutULong(collection, record + 8, offset);
+    }
+  }
+  collection->resize(font_offset, 0);
+  collection->insert(collection->end(), font.begin(), font.end());
+  collection->resize(name_offset, 0);
+  for (size_t record = 12; record < directory_size; record += 16) {
+    if (GetULong(font, record) == (uint32_t)Tag::name) {
+      size_t offset = GetULong(font, record + 8);
+      collection->insert(collection->end(), font.begin() + offset,
+                         font.begin() + offset + GetULong(font, record + 12));
+    }
+  }
+}
+
+bool VerifyCollectionSharing(FontFactory* factory, ByteVector* collection) {
+  FontArray fonts;
+  factory->LoadFonts(collection, &fonts);
+  EXPECT_EQ(2U, fonts.size());
+  if (fonts.size() != 2) {
+    return false;
+  }
+  EXPECT_EQ(fonts[0]->num_tables(), fonts[1]->num_tables());
+  EXPECT_TRUE(fonts[0]->GetTable(Tag::glyf) == fonts[1]->GetTable(Tag::glyf));
+  EXPECT_TRUE(fonts[0]->GetTable(Tag::hmtx) == fonts[1]->GetTable(Tag::hmtx));
+  EXPECT_TRUE(fonts[0]->GetTable(Tag::loca) == fonts[1]->GetTable(Tag::loca));
+  Table* name = fonts[0]->GetTable(Tag::name);
+  Table* other_name = fonts[1]->GetTable(Tag::name);
+  EXPECT_TRUE(name != other_name);
+  EXPECT_EQ(name->DataLength(), other_name->DataLength());
+  EXPECT_EQ(0, memcmp(name->ReadFontData()->ContiguousBytes(),
+                      other_name->ReadFontData()->ContiguousBytes(),
+                      name->DataLength()));
+
+  MemoryOutputStream output;
+  factory->SerializeFont(fonts[0], &output);
+  MemoryOutputStream other_output;
+  factory->SerializeFont(fonts[1], &other_output);
+  EXPECT_EQ(output.Size(), other_output.Size());
+  EXPECT_EQ(0, memcmp(output.Get(), other_output.Get(), output.Size()));
+
+  FontBuilderArray builders;
+  factory->LoadFontsForBuilding(collection, &builders);
+  EXPECT_EQ(2U, builders.size());
+  for (size_t i = 0; i < builders.size(); ++i) {
+    FontPtr font;
+    font.Attach(builders[i]->Build());
+    EXPECT_EQ(fonts[i]->num_tables(), font->num_tables());
+  }
+  return true;
+}
+
+bool TestCollectionSharing() {
+  ByteVector font;
+  LoadFile(SAMPLE_TTF_FILE, &font);
+  ByteVector collection;
+  MakeCollection(font, &collection);
+
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  EXPECT_TRUE(VerifyCollectionSharing(factory, &collection));
+#if !defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+  ThreadPoolPtr pool = new ThreadPool(2);
+  factory->SetThreadPool(pool);
+  EXPECT_TRUE(VerifyCollectionSharing(factory, &collection));
+#endif
+  return true;
+}
+
 }  // namespace sfntly
 
 TEST(FontParsing, All) {
   ASSERT_TRUE(sfntly::TestFontParsing());
   ASSERT_TRUE(sfntly::TestTTFReadWrite());
   ASSERT_TRUE(sfntly::TestTTFMemoryBasedReadWrite());
+  ASSERT_TRUE(sfntly::TestTTFMappedReadWrite());
+  ASSERT_TRUE(sfntly::TestTTFMappedEditing());
+  ASSERT_TRUE(sfntly::TestTTFBorrowedBufferReadWrite());
+}
+
+TEST(FontParsing, TableFilter) {
+  ASSERT_TRUE(sfntly::TestTableFilter());
+}
+
+TEST(FontParsing, LazyTables) {
+  ASSERT_TRUE(sfntly::TestLazyTables());
+}
+
+TEST(FontParsing, ConcurrentLazyTables) {
+  ASSERT_TRUE(sfntly::TestConcurrentLazyTables());
+}
+
+TEST(FontParsing, ReadOnlyFont) {
+  ASSERT_TRUE(sfntly::TestReadOnlyFont());
+}
+
+TEST(FontParsing, CollectionSharing) {
+  ASSERT_TRUE(sfntly::TestCollectionSharing());
 }
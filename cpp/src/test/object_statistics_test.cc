@@ -0,0 +1,156 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "sfntly/port/object_statistics.h"
+#include "sfntly/port/refcount.h"
+#include "sfntly/port/type.h"
+
+namespace sfntly {
+
+class StatisticsObject : public RefCounted<StatisticsObject> {
+ public:
+  int32_t values_[8];
+};
+
+template <typename T>
+class StatisticsTemplate : public RefCounted<StatisticsTemplate<T> > {
+};
+
+const ObjectStatistics::Entry* FindEntry(
+    const ObjectStatistics::EntryList& entries, const char* type_name) {
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (entries[i].type_name == type_name) {
+      return &(entries[i]);
+    }
+  }
+  return NULL;
+}
+
+bool TestObjectStatisticsCounts() {
+  if (!ObjectStatistics::Enabled()) {
+    ObjectStatistics::EntryList snapshot;
+    ObjectStatistics::Snapshot(&snapshot);
+    EXPECT_TRUE(snapshot.empty());
+    return true;
+  }
+  ObjectStatistics::EntryList before, during, after, diff;
+  ObjectStatistics::ResetPeaks();
+  ObjectStatistics::Snapshot(&before);
+  {
+    Ptr<StatisticsObject> first = new StatisticsObject();
+    {
+      Ptr<StatisticsObject> second = new StatisticsObject();
+      Ptr<StatisticsObject> third = new StatisticsObject();
+    }
+    Ptr<StatisticsObject> fourth = new StatisticsObject();
+    Ptr<StatisticsTemplate<int32_t> > other =
+        new StatisticsTemplate<int32_t>();
+    ObjectStatistics::Snapshot(&during);
+  }
+  ObjectStatistics::Snapshot(&after);
+
+  // Snapshots are sorted by type name.
+  for (size_t i = 1; i < during.size(); ++i) {
+    EXPECT_LT(during[i - 1].type_name, during[i].type_name);
+  }
+
+  ObjectStatistics::Diff(before, during, &diff);
+  const ObjectStatistics::Entry* entry =
+      FindEntry(diff, "sfntly::StatisticsObject");
+  EXPECT_TRUE(entry != NULL);
+  if (entry != NULL) {
+    EXPECT_EQ(2, entry->live);
+    // The first three objects were alive at once.
+    EXPECT_EQ(3, entry->peak);
+    EXPECT_EQ(4, entry->total);
+    EXPECT_EQ((int64_t)(2 * sizeof(StatisticsObject)), entry->bytes);
+  }
+  entry = FindEntry(diff, "sfntly::StatisticsTemplate<int>");
+  EXPECT_TRUE(entry != NULL);
+  if (entry != NULL) {
+    EXPECT_EQ(1, entry->live);
+    EXPECT_EQ(1, entry->total);
+  }
+
+  ObjectStatistics::Diff(during, after, &diff);
+  entry = FindEntry(diff, "sfntly::StatisticsObject");
+  EXPECT_TRUE(entry != NULL);
+  if (entry != NULL) {
+    EXPECT_EQ(-2, entry->live);
+    EXPECT_EQ(0, entry->peak);
+    EXPECT_EQ(0, entry->total);
+    EXPECT_EQ(-(int64_t)(2 * sizeof(StatisticsObject)), entry->bytes);
+  }
+
+  // Nothing happened between two snapshots in a row.
+  ObjectStatistics::Snapshot(&before);
+  ObjectStatistics::Diff(after, before, &diff);
+  EXPECT_TRUE(diff.empty());
+  return true;
+}
+
+bool TestObjectStatisticsDiff() {
+  ObjectStatistics::EntryList before, after, diff;
+  const char* kNames[] = { "A", "B", "C" };
+  for (int32_t i = 0; i < 3; ++i) {
+    ObjectStatistics::Entry entry;
+    entry.type_name = kNames[i];
+    entry.live = entry.peak = entry.total = i + 1;
+    entry.bytes = (i + 1) * 8;
+    if (i != 1) {
+      before.push_back(entry);
+    }
+    if (i == 2) {
+      entry.total = 3;
+    } else {
+      entry.total += 10;
+      entry.live += 1;
+      entry.peak += 2;
+      entry.bytes += 8;
+    }
+    after.push_back(entry);
+  }
+  ObjectStatistics::Diff(before, after, &diff);
+  EXPECT_EQ(2U, diff.size());
+  EXPECT_EQ("A", diff[0].type_name);
+  EXPECT_EQ(1, diff[0].live);
+  EXPECT_EQ(2, diff[0].peak);
+  EXPECT_EQ(10, diff[0].total);
+  EXPECT_EQ(8, diff[0].bytes);
+  // A type first seen after the earlier snapshot counts from zero.
+  EXPECT_EQ("B", diff[1].type_name);
+  EXPECT_EQ(12, diff[1].total);
+  EXPECT_EQ(24, diff[1].bytes);
+
+  ObjectStatistics::SortByTotal(&after);
+  EXPECT_EQ("B", after[0].type_name);
+  EXPECT_EQ("A", after[1].type_name);
+  EXPECT_EQ("C", after[2].type_name);
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(ObjectStatistics, Counts) {
+  ASSERT_TRUE(sfntly::TestObjectStatisticsCounts());
+}
+
+TEST(ObjectStatistics, Diff) {
+  ASSERT_TRUE(sfntly::TestObjectStatisticsDiff());
+}
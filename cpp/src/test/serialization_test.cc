@@ -14,11 +14,19 @@
  * limitations under the License.
  */
 
+#include <string.h>
+
 #include "gtest/gtest.h"
+#include "sfntly/data/gather_output.h"
 #include "sfntly/font.h"
 #include "sfntly/font_factory.h"
 #include "sfntly/port/memory_input_stream.h"
 #include "sfntly/port/memory_output_stream.h"
+#if !defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+#include "sfntly/port/thread_pool.h"
+#endif
+#include "sfntly/table/core/font_header_table.h"
+#include "sfntly/tag.h"
 #include "test/test_data.h"
 #include "test/test_font_utils.h"
 #include "test/serialization_test.h"
@@ -140,6 +148,161 @@ bool TestSerializationBitmap() {
   return true;
 }
 
+bool TestSerializationGather() {
+  const char* font_files[] = { SAMPLE_TTF_FILE, SAMPLE_BITMAP_FONT };
+  for (size_t f = 0; f < sizeof(font_files) / sizeof(font_files[0]); ++f) {
+    FontFactoryPtr factory;
+    factory.Attach(FontFactory::GetInstance());
+    FontBuilderArray font_builder_array;
+    BuilderForFontFile(font_files[f], factory, &font_builder_array);
+    FontPtr font;
+    font.Attach(font_builder_array[0]->Build());
+
+    // Gathered output is byte for byte what the stream gets.
+    MemoryOutputStream os;
+    factory->SerializeFont(font, &os);
+    GatherOutput output;
+    factory->SerializeFont(font, &output);
+    EXPECT_EQ(os.Size(), output.Size());
+    ByteVector copy(output.Size());
+    EXPECT_EQ(0U, output.CopyTo(&(copy[0]), copy.size() - 1));
+    EXPECT_EQ(copy.size(), output.CopyTo(&(copy[0]), copy.size()));
+    EXPECT_EQ(0, memcmp(os.Get(), &(copy[0]), copy.size()));
+    MemoryOutputStream gathered_os;
+    output.WriteTo(&gathered_os);
+    EXPECT_EQ(os.Size(), gathered_os.Size());
+    EXPECT_EQ(0, memcmp(os.Get(), gathered_os.Get(), os.Size()));
+
+    // Contiguous table data is referenced rather than copied, but for the
+    // head table, copied to set its checkSumAdjustment.
+    const TableMap* tables = font->GetTableMap();
+    for (TableMap::const_iterator t = tables->begin(), e = tables->end();
+         t != e; ++t) {
+      const byte_t* b = t->second->ReadFontData()->ContiguousBytes();
+      if (b == NULL || t->first == Tag::head) {
+        continue;
+      }
+      bool referenced = false;
+      for (size_t i = 0; i < output.segments().size(); ++i) {
+        referenced |= output.segments()[i].data == b;
+      }
+      EXPECT_TRUE(referenced);
+    }
+  }
+
+  GatherOutput padding;
+  padding.AppendPadding(37);
+  EXPECT_EQ(37U, padding.Size());
+  ByteVector zeros(37, 0xff);
+  EXPECT_EQ(37U, padding.CopyTo(&(zeros[0]), zeros.size()));
+  EXPECT_EQ(ByteVector(37, 0), zeros);
+  padding.Clear();
+  EXPECT_EQ(0U, padding.Size());
+  EXPECT_TRUE(padding.segments().empty());
+  return true;
+}
+
+bool TestSerializationToBuffer() {
+  const char* font_files[] = { SAMPLE_TTF_FILE, SAMPLE_BITMAP_FONT };
+  for (size_t f = 0; f < sizeof(font_files) / sizeof(font_files[0]); ++f) {
+    FontFactoryPtr factory;
+    factory.Attach(FontFactory::GetInstance());
+    FontBuilderArray font_builder_array;
+    BuilderForFontFile(font_files[f], factory, &font_builder_array);
+    FontPtr font;
+    font.Attach(font_builder_array[0]->Build());
+
+    // The size is known up front and the buffer gets what the stream gets.
+    MemoryOutputStream os;
+    factory->SerializeFont(font, &os);
+    size_t size = factory->SerializedFontSize(font);
+    EXPECT_EQ(os.Size(), size);
+    ByteVector buffer(size + 1, 0xff);
+    EXPECT_EQ(0U, factory->SerializeFontTo(font, &(buffer[0]), size - 1));
+    EXPECT_EQ(0xff, buffer[0]);
+    EXPECT_EQ(size, factory->SerializeFontTo(font, &(buffer[0]), size + 1));
+    EXPECT_EQ(0, memcmp(os.Get(), &(buffer[0]), size));
+    EXPECT_EQ(0xff, buffer[size]);
+  }
+  return true;
+}
+
+static int64_t SumULongs(const byte_t* b, size_t length) {
+  int64_t sum = 0;
+  for (size_t i = 0; i < length; i += 4) {
+    sum += ((int64_t)b[i] << 24) | (b[i + 1] << 16) | (b[i + 2] << 8) |
+           b[i + 3];
+  }
+  return sum & 0xffffffffL;
+}
+
+bool TestSerializationChecksums() {
+  const char* font_files[] = { SAMPLE_TTF_FILE, SAMPLE_BITMAP_FONT };
+  for (size_t f = 0; f < sizeof(font_files) / sizeof(font_files[0]); ++f) {
+    FontFactoryPtr factory;
+    factory.Attach(FontFactory::GetInstance());
+    EXPECT_TRUE(factory->ComputeChecksums());
+    FontArray fonts;
+    factory->LoadFonts(font_files[f], &fonts);
+    EXPECT_EQ(1U, fonts.size());
+    FontPtr font = fonts[0];
+
+    // The whole font sums to the magic number and the table records carry
+    // the table checksums.
+    MemoryOutputStream os;
+    factory->SerializeFont(font, &os);
+    EXPECT_EQ(0xB1B0AFBA, SumULongs(os.Get(), os.Size()));
+    int32_t num_tables = (os.Get()[4] << 8) | os.Get()[5];
+    EXPECT_EQ(font->num_tables(), num_tables);
+    for (int32_t i = 0; i < num_tables; ++i) {
+      const byte_t* record = os.Get() + 12 + i * 16;
+      int32_t tag = (int32_t)SumULongs(record, 4);
+      EXPECT_EQ(font->GetTable(tag)->CalculatedChecksum(),
+                SumULongs(record + 4, 4));
+    }
+
+    // Computing the checksums on a pool, gathering the output or serializing
+    // into a buffer gives the same bytes.
+#if !defined (SFNTLY_THREAD_CONFINED_REFCOUNT)
+    ThreadPoolPtr pool = new ThreadPool(2);
+    factory->SetThreadPool(pool);
+    MemoryOutputStream pooled_os;
+    factory->SerializeFont(font, &pooled_os);
+    EXPECT_EQ(os.Size(), pooled_os.Size());
+    EXPECT_EQ(0, memcmp(os.Get(), pooled_os.Get(), os.Size()));
+#endif
+    GatherOutput output;
+    factory->SerializeFont(font, &output);
+    ByteVector gathered(output.Size());
+    output.CopyTo(&(gathered[0]), gathered.size());
+    EXPECT_EQ(0, memcmp(os.Get(), &(gathered[0]), os.Size()));
+    ByteVector buffer(factory->SerializedFontSize(font));
+    factory->SerializeFontTo(font, &(buffer[0]), buffer.size());
+    EXPECT_EQ(0, memcmp(os.Get(), &(buffer[0]), os.Size()));
+
+    // Without checksums the records have none and head is left as it is.
+    factory->ComputeChecksums(false);
+    MemoryOutputStream unchecked_os;
+    factory->SerializeFont(font, &unchecked_os);
+    EXPECT_EQ(os.Size(), unchecked_os.Size());
+    for (int32_t i = 0; i < num_tables; ++i) {
+      EXPECT_EQ(0, SumULongs(unchecked_os.Get() + 12 + i * 16 + 4, 4));
+    }
+    FontArray unchecked;
+    ByteVector unchecked_data(unchecked_os.Get(),
+                              unchecked_os.Get() + unchecked_os.Size());
+    factory->LoadFonts(&unchecked_data, &unchecked);
+    FontHeaderTablePtr original_head =
+        down_cast<FontHeaderTable*>(font->GetTable(Tag::head));
+    FontHeaderTablePtr head =
+        down_cast<FontHeaderTable*>(unchecked[0]->GetTable(Tag::head));
+    EXPECT_EQ(original_head->ChecksumAdjustment(), head->ChecksumAdjustment());
+    EXPECT_EQ(original_head->ReadFontData()->Checksum(),
+              head->ReadFontData()->Checksum());
+  }
+  return true;
+}
+
 }  // namespace sfntly
 
 TEST(Serialization, Simple) {
@@ -149,3 +312,15 @@ TEST(Serialization, Simple) {
 TEST(Serialization, Bitmap) {
   ASSERT_TRUE(sfntly::TestSerializationBitmap());
 }
+
+TEST(Serialization, Gather) {
+  ASSERT_TRUE(sfntly::TestSerializationGather());
+}
+
+TEST(Serialization, ToBuffer) {
+  ASSERT_TRUE(sfntly::TestSerializationToBuffer());
+}
+
+TEST(Serialization, Checksums) {
+  ASSERT_TRUE(sfntly::TestSerializationChecksums());
+}
@@ -14,12 +14,20 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "gtest/gtest.h"
 #define ENABLE_OBJECT_COUNTER
 #include "sfntly/port/refcount.h"
+#include "test/counting_ref_count_policy.h"
 
+using sfntly::BorrowedPtr;
+using sfntly::CountingRefCountPolicy;
 using sfntly::RefCounted;
 using sfntly::Ptr;
+using sfntly::ThreadConfinedRefCountPolicy;
 
 class Foo : public RefCounted<Foo> {
 public:  // put in something to make sure it's not empty
@@ -74,6 +82,104 @@ bool TestSmartPointer() {
   return true;
 }
 
+class CountedFoo : public RefCounted<CountedFoo, CountingRefCountPolicy> {
+public:
+  int foo_;
+  int foo() { return foo_; }
+};
+typedef RefCounted<CountedFoo, CountingRefCountPolicy> CountedFooBase;
+
+// Handing references over leaves the reference counts alone.
+bool TestPtrTransfers() {
+  {
+    Ptr<CountedFoo> p1 = new CountedFoo();
+    Ptr<CountedFoo> p2 = new CountedFoo();
+    CountedFoo* foo1 = p1;
+    CountedFoo* foo2 = p2;
+    size_t updates = *CountingRefCountPolicy::updates();
+
+    p1.swap(p2);
+    EXPECT_EQ(foo2, p1.p_);
+    EXPECT_EQ(foo1, p2.p_);
+    std::swap(p1, p2);
+    EXPECT_EQ(foo1, p1.p_);
+    EXPECT_EQ(foo2, p2.p_);
+
+    BorrowedPtr<CountedFoo> borrowed = p1;
+    EXPECT_EQ(foo1, (CountedFoo*)borrowed);
+    borrowed->foo_ = 3;
+    EXPECT_EQ(3, p1->foo());
+    EXPECT_FALSE(!borrowed);
+    EXPECT_TRUE(!BorrowedPtr<CountedFoo>());
+    EXPECT_EQ(updates, *CountingRefCountPolicy::updates());
+
+#if defined (SFNTLY_HAS_RVALUE_REFERENCES)
+    Ptr<CountedFoo> p3(std::move(p1));
+    EXPECT_EQ(NULL, p1.p_);
+    EXPECT_EQ(foo1, p3.p_);
+    p1 = std::move(p3);
+    EXPECT_EQ(NULL, p3.p_);
+    EXPECT_EQ(foo1, p1.p_);
+
+    std::vector<Ptr<CountedFoo> > pointers;
+    for (int i = 0; i < 100; ++i) {
+      pointers.push_back(Ptr<CountedFoo>());
+    }
+    pointers.push_back(std::move(p2));
+    pointers.insert(pointers.begin(), std::move(p1));
+    EXPECT_EQ(updates, *CountingRefCountPolicy::updates());
+    EXPECT_EQ(size_t(1), foo1->ref_count_);
+    EXPECT_EQ(size_t(1), foo2->ref_count_);
+
+    // Moving onto a pointer releases the object it held.
+    pointers.back() = std::move(pointers.front());
+    EXPECT_EQ(size_t(1), CountedFooBase::object_counter_);
+#endif
+  }
+  EXPECT_EQ(size_t(0), CountedFooBase::object_counter_);
+  return true;
+}
+
+class Bar : public RefCounted<Bar, ThreadConfinedRefCountPolicy> {
+public:
+  int bar_;
+};
+typedef RefCounted<Bar, ThreadConfinedRefCountPolicy> BarBase;
+
+// Thread confined reference counts behave the same on one thread.
+bool TestThreadConfinedSmartPointer() {
+  {
+    Ptr<Bar> p1 = new Bar();
+    EXPECT_EQ(size_t(1), p1->ref_count_);
+    EXPECT_EQ(size_t(1), BarBase::object_counter_);
+    {
+      Ptr<Bar> p2 = p1;
+      EXPECT_EQ(size_t(2), p1->ref_count_);
+    }
+    EXPECT_EQ(size_t(1), p1->ref_count_);
+
+    Ptr<Bar> p3 = new Bar();
+    EXPECT_EQ(size_t(2), BarBase::object_counter_);
+    p3 = p1;
+    EXPECT_EQ(size_t(2), p1->ref_count_);
+    EXPECT_EQ(size_t(1), BarBase::object_counter_);
+
+    Bar* detached = p3.Detach();
+    EXPECT_EQ(size_t(2), detached->ref_count_);
+    p3.Attach(detached);
+  }
+  EXPECT_EQ(size_t(0), BarBase::object_counter_);
+  return true;
+}
+
 TEST(SmartPointer, All) {
   ASSERT_TRUE(TestSmartPointer());
 }
+
+TEST(SmartPointer, Transfers) {
+  ASSERT_TRUE(TestPtrTransfers());
+}
+
+TEST(SmartPointer, ThreadConfined) {
+  ASSERT_TRUE(TestThreadConfinedSmartPointer());
+}
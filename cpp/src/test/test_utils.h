@@ -106,5 +106,14 @@ class TestUtils {
   // there is no extension
   static const char* Extension(const char* file_path);
 };
+
+// A MemoryByteArray that does not expose its storage through Begin(), so that
+// everything reading from it takes the generic InternalGet() path.
+class NonContiguousByteArray : public MemoryByteArray {
+ public:
+  explicit NonContiguousByteArray(int32_t length) : MemoryByteArray(length) {}
+  virtual ~NonContiguousByteArray() {}
+  virtual byte_t* Begin() { return NULL; }
+};
 }
 #endif  // SFNTLY_CPP_SRC_TEST_TEST_UTILS_H_
@@ -0,0 +1,203 @@
+/*
+ * Copyright 2011 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/atomic.h"
+#include "sfntly/port/memory_output_stream.h"
+#include "sfntly/port/thread_pool.h"
+#include "sfntly/table/truetype/glyph_table.h"
+#include "sfntly/table/truetype/loca_table.h"
+#include "sfntly/tag.h"
+#include "test/platform_thread.h"
+#include "test/test_data.h"
+
+namespace sfntly {
+
+class CountingTask : public ThreadPool::Task {
+ public:
+  explicit CountingTask(size_t* counter) : counter_(counter), runs_(0) {}
+
+  virtual void Run() {
+    ++runs_;
+    AtomicIncrement(counter_);
+  }
+
+  int32_t runs() const { return runs_; }
+
+ private:
+  size_t* counter_;
+  int32_t runs_;
+};
+
+// Hands batches of tasks to a shared pool.
+class BatchThread : public PlatformThread::Delegate {
+ public:
+  BatchThread(ThreadPool* pool, size_t* counter)
+      : pool_(pool), counter_(counter) {}
+
+  virtual void ThreadMain() {
+    for (int32_t batch = 0; batch < 20; ++batch) {
+      std::vector<CountingTask> tasks(10, CountingTask(counter_));
+      ThreadPool::TaskList task_list;
+      for (size_t i = 0; i < tasks.size(); ++i) {
+        task_list.push_back(&tasks[i]);
+      }
+      pool_->RunTasks(&task_list);
+      for (size_t i = 0; i < tasks.size(); ++i) {
+        EXPECT_EQ(1, tasks[i].runs());
+      }
+    }
+  }
+
+ private:
+  ThreadPool* pool_;
+  size_t* counter_;
+
+  NO_COPY_AND_ASSIGN(BatchThread);
+};
+
+bool TestThreadPool() {
+  for (int32_t num_threads = 0; num_threads <= 4; num_threads += 2) {
+    ThreadPoolPtr pool = new ThreadPool(num_threads);
+    EXPECT_EQ(num_threads, pool->num_threads());
+
+    size_t counter = 0;
+    std::vector<CountingTask> tasks(100, CountingTask(&counter));
+    ThreadPool::TaskList task_list;
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      task_list.push_back(&tasks[i]);
+    }
+    pool->RunTasks(&task_list);
+    EXPECT_EQ(tasks.size(), counter);
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      EXPECT_EQ(1, tasks[i].runs());
+    }
+    ThreadPool::TaskList no_tasks;
+    pool->RunTasks(&no_tasks);
+  }
+  return true;
+}
+
+bool TestThreadPoolConcurrentBatches() {
+  ThreadPoolPtr pool = new ThreadPool(3);
+  size_t counter = 0;
+  BatchThread first(pool, &counter);
+  BatchThread second(pool, &counter);
+  PlatformThreadHandle first_handle = kNullThreadHandle;
+  PlatformThreadHandle second_handle = kNullThreadHandle;
+  EXPECT_TRUE(PlatformThread::Create(&first, &first_handle));
+  EXPECT_TRUE(PlatformThread::Create(&second, &second_handle));
+  PlatformThread::Join(first_handle);
+  PlatformThread::Join(second_handle);
+  EXPECT_EQ(2U * 20 * 10, counter);
+  return true;
+}
+
+// Load the sample font for building with its glyphs rebuilt from glyph
+// builders, so that glyf and loca are serialized again on Build().
+CALLER_ATTACH Font::Builder* NewRebuiltFontBuilder(FontFactory* factory) {
+  FontArray fonts;
+  factory->LoadFonts(SAMPLE_TTF_FILE, &fonts);
+  EXPECT_EQ(1U, fonts.size());
+  GlyphTablePtr glyph_table =
+      down_cast<GlyphTable*>(fonts[0]->GetTable(Tag::glyf));
+  LocaTablePtr loca_table =
+      down_cast<LocaTable*>(fonts[0]->GetTable(Tag::loca));
+
+  FontBuilderPtr font_builder;
+  font_builder.Attach(factory->NewFontBuilder());
+  const TableMap* tables = fonts[0]->GetTableMap();
+  for (TableMap::const_iterator table = tables->begin(),
+                                table_end = tables->end();
+                                table != table_end; ++table) {
+    if (table->first != Tag::glyf && table->first != Tag::loca) {
+      font_builder->NewTableBuilder(table->first,
+                                    table->second->ReadFontData());
+    }
+  }
+  GlyphTableBuilderPtr glyph_table_builder =
+      down_cast<GlyphTable::Builder*>(font_builder->NewTableBuilder(Tag::glyf));
+  LocaTableBuilderPtr loca_table_builder =
+      down_cast<LocaTable::Builder*>(font_builder->NewTableBuilder(Tag::loca));
+  GlyphTable::GlyphBuilderList* glyph_builders =
+      glyph_table_builder->GlyphBuilders();
+  for (int32_t glyph_id = 0; glyph_id < loca_table->num_glyphs(); ++glyph_id) {
+    GlyphPtr glyph;
+    glyph.Attach(glyph_table->GetGlyph(loca_table->GlyphOffset(glyph_id),
+                                       loca_table->GlyphLength(glyph_id)));
+    ReadableFontDataPtr data = glyph->ReadFontData();
+    WritableFontDataPtr copy_data;
+    copy_data.Attach(WritableFontData::CreateWritableFontData(data->Length()));
+    data->CopyTo(copy_data);
+    GlyphBuilderPtr glyph_builder;
+    glyph_builder.Attach(glyph_table_builder->GlyphBuilder(copy_data));
+    glyph_builders->push_back(glyph_builder);
+  }
+  IntegerList loca_list;
+  glyph_table_builder->GenerateLocaList(&loca_list);
+  loca_table_builder->SetLocaList(&loca_list);
+  return font_builder.Detach();
+}
+
+bool TestConcurrentTableBuild() {
+  FontFactoryPtr factory;
+  factory.Attach(FontFactory::GetInstance());
+  FontBuilderPtr serial_builder;
+  serial_builder.Attach(NewRebuiltFontBuilder(factory));
+  FontPtr serial_font;
+  serial_font.Attach(serial_builder->Build());
+
+  ThreadPoolPtr pool = new ThreadPool(4);
+  factory->SetThreadPool(pool);
+  EXPECT_EQ(pool.p_, factory->thread_pool());
+  FontBuilderPtr concurrent_builder;
+  concurrent_builder.Attach(NewRebuiltFontBuilder(factory));
+  FontPtr concurrent_font;
+  concurrent_font.Attach(concurrent_builder->Build());
+  EXPECT_EQ(serial_font->num_tables(), concurrent_font->num_tables());
+
+  MemoryOutputStream serial_output;
+  factory->SerializeFont(serial_font, &serial_output);
+  MemoryOutputStream concurrent_output;
+  factory->SerializeFont(concurrent_font, &concurrent_output);
+  EXPECT_EQ(serial_output.Size(), concurrent_output.Size());
+  EXPECT_EQ(0, memcmp(serial_output.Get(), concurrent_output.Get(),
+                      serial_output.Size()));
+  factory->SetExecutor(pool);
+  EXPECT_EQ(pool.p_, factory->executor());
+  EXPECT_TRUE(factory->thread_pool() == NULL);
+  factory->SetThreadPool(NULL);
+  EXPECT_TRUE(factory->executor() == NULL);
+  return true;
+}
+
+}  // namespace sfntly
+
+TEST(ThreadPool, RunTasks) {
+  ASSERT_TRUE(sfntly::TestThreadPool());
+}
+
+TEST(ThreadPool, ConcurrentBatches) {
+  ASSERT_TRUE(sfntly::TestThreadPoolConcurrentBatches());
+}
+
+TEST(ThreadPool, ConcurrentTableBuild) {
+  ASSERT_TRUE(sfntly::TestConcurrentTableBuild());
+}
@@ -60,6 +60,17 @@ static bool VerifyHMTX(Table* table) {
     EXPECT_EQ(hmtx->LeftSideBearing(i), HMTX_ENTRIES[i].lsb_);
   }
 
+  // Bulk access agrees with the per-entry accessors.
+  IntegerList advance_widths;
+  IntegerList lsbs;
+  EXPECT_EQ(hmtx->HMetrics(0, HMTX_ENTRIES_COUNT, &advance_widths, &lsbs),
+            HMTX_ENTRIES_COUNT);
+  EXPECT_EQ((int32_t)advance_widths.size(), HMTX_ENTRIES_COUNT);
+  for (int32_t i = 0; i < HMTX_ENTRIES_COUNT; ++i) {
+    EXPECT_EQ(advance_widths[i], hmtx->AdvanceWidth(i));
+    EXPECT_EQ(lsbs[i], hmtx->LeftSideBearing(i));
+  }
+
   // No such element case.
   EXPECT_EQ(hmtx->AdvanceWidth(HMTX_ENTRIES_COUNT),
             HMTX_ENTRIES[0].advance_width_);